@@ -14,6 +14,7 @@
 #include "cluster/controller_backend.h"
 #include "cluster/controller_service.h"
 #include "cluster/controller_stm.h"
+#include "cluster/leader_balancer.h"
 #include "cluster/members_manager.h"
 #include "cluster/metadata_dissemination_service.h"
 #include "cluster/partition_leaders_table.h"
@@ -50,6 +51,9 @@ public:
     ss::sharded<partition_leaders_table>& get_partition_leaders() {
         return _partition_leaders;
     }
+    ss::sharded<leader_balancer>& get_leader_balancer() {
+        return _leader_balancer;
+    }
 
     ss::future<> wire_up();
 
@@ -68,6 +72,7 @@ private:
     ss::sharded<controller_backend> _backend;      // instance per core
     ss::sharded<controller_stm> _stm;              // single instance
     ss::sharded<controller_service> _service;      // instance per core
+    ss::sharded<leader_balancer> _leader_balancer; // single instance
     ss::sharded<rpc::connection_cache>& _connections;
     ss::sharded<partition_manager>& _partition_manager;
     ss::sharded<shard_table>& _shard_table;
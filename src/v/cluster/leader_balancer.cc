@@ -0,0 +1,260 @@
+// Copyright 2020 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "cluster/leader_balancer.h"
+
+#include "cluster/errc.h"
+#include "cluster/logger.h"
+#include "config/configuration.h"
+#include "prometheus/prometheus_sanitize.h"
+#include "vlog.h"
+
+#include <seastar/core/metrics.hh>
+
+#include <algorithm>
+
+namespace cluster {
+
+leader_balancer::leader_balancer(
+  ss::sharded<topic_table>& topics,
+  ss::sharded<partition_leaders_table>& leaders,
+  ss::sharded<shard_table>& st,
+  ss::sharded<partition_manager>& pm)
+  : _self(model::node_id(config::shard_local_cfg().node_id()))
+  , _interval(config::shard_local_cfg().leader_balancer_interval_ms())
+  , _mute_timeout(config::shard_local_cfg().leader_balancer_mute_timeout_ms())
+  , _max_transfers(config::shard_local_cfg().leader_balancer_max_transfers())
+  , _topics(topics)
+  , _leaders(leaders)
+  , _shard_table(st)
+  , _partition_manager(pm) {
+    _timer.set_callback([this] {
+        (void)ss::with_gate(_gate, [this] { return balance(); })
+          .handle_exception([](std::exception_ptr e) {
+              vlog(clusterlog.info, "Leader balancer error: {}", e);
+          })
+          .finally([this] { arm(); });
+    });
+}
+
+ss::future<> leader_balancer::start() {
+    setup_metrics();
+    if (config::shard_local_cfg().enable_leader_balancer()) {
+        arm();
+    }
+    return ss::now();
+}
+
+ss::future<> leader_balancer::stop() {
+    _timer.cancel();
+    return _gate.close();
+}
+
+void leader_balancer::arm() {
+    if (!_gate.is_closed()) {
+        _timer.arm(_interval);
+    }
+}
+
+void leader_balancer::setup_metrics() {
+    if (config::shard_local_cfg().disable_metrics()) {
+        return;
+    }
+    namespace sm = ss::metrics;
+    _metrics.add_group(
+      prometheus_sanitize::metrics_name("cluster:leader_balancer"),
+      {sm::make_derive(
+         "transfers",
+         [this] { return _transfers; },
+         sm::description("Number of leadership transfers requested")),
+       sm::make_derive(
+         "failed_transfers",
+         [this] { return _failed_transfers; },
+         sm::description("Number of leadership transfers that failed")),
+       sm::make_gauge(
+         "max_shard_leaders",
+         [this] { return _last_report.max_leaders; },
+         sm::description("Most leaders held by a single shard")),
+       sm::make_gauge(
+         "min_shard_leaders",
+         [this] { return _last_report.min_leaders; },
+         sm::description("Fewest leaders held by a single shard")),
+       sm::make_gauge(
+         "mean_shard_leaders",
+         [this] { return _last_report.mean_leaders; },
+         sm::description("Mean number of leaders per shard"))});
+}
+
+leader_balancer::skew_report leader_balancer::make_report(const load_map& m) {
+    skew_report r;
+    if (m.empty()) {
+        return r;
+    }
+    r.shards = m.size();
+    r.min_leaders = std::numeric_limits<size_t>::max();
+    for (const auto& [_, n] : m) {
+        r.leaders += n;
+        r.min_leaders = std::min(r.min_leaders, n);
+        r.max_leaders = std::max(r.max_leaders, n);
+    }
+    r.mean_leaders = static_cast<double>(r.leaders) / r.shards;
+    return r;
+}
+
+std::vector<leader_balancer::transfer> leader_balancer::plan(load_map& loads) {
+    struct candidate {
+        model::ntp ntp;
+        shard_key leader;
+        std::vector<shard_key> followers;
+    };
+    std::vector<candidate> candidates;
+
+    for (auto& md : _topics.local().all_topics_metadata()) {
+        for (auto& p : md.partitions) {
+            for (auto& r : p.replicas) {
+                loads.try_emplace(shard_key{r.node_id, r.shard}, 0);
+            }
+            auto leader = _leaders.local().get_leader(
+              model::topic_namespace_view(md.tp_ns), p.id);
+            if (!leader) {
+                continue;
+            }
+            auto it = std::find_if(
+              p.replicas.begin(), p.replicas.end(), [&leader](const auto& r) {
+                  return r.node_id == *leader;
+              });
+            if (it == p.replicas.end()) {
+                continue;
+            }
+            shard_key leader_key{it->node_id, it->shard};
+            ++loads[leader_key];
+            if (*leader != _self || p.replicas.size() < 2) {
+                continue;
+            }
+            candidate c{
+              .ntp = model::ntp(md.tp_ns.ns, md.tp_ns.tp, p.id),
+              .leader = leader_key};
+            for (auto& r : p.replicas) {
+                if (r.node_id != _self) {
+                    c.followers.push_back(shard_key{r.node_id, r.shard});
+                }
+            }
+            candidates.push_back(std::move(c));
+        }
+    }
+
+    // start with the partitions led by the most loaded local shards
+    std::sort(
+      candidates.begin(),
+      candidates.end(),
+      [&loads](const candidate& a, const candidate& b) {
+          return loads[a.leader] > loads[b.leader];
+      });
+
+    std::vector<transfer> ret;
+    const auto now = clock_type::now();
+    for (auto& c : candidates) {
+        if (ret.size() >= _max_transfers) {
+            break;
+        }
+        if (auto it = _muted.find(c.ntp); it != _muted.end()) {
+            if (now < it->second) {
+                continue;
+            }
+        }
+        auto target = std::min_element(
+          c.followers.begin(),
+          c.followers.end(),
+          [&loads](const shard_key& a, const shard_key& b) {
+              return loads[a] < loads[b];
+          });
+        auto& src_load = loads[c.leader];
+        auto& dst_load = loads[*target];
+        // only move when it strictly reduces the spread
+        if (src_load <= dst_load + 1) {
+            continue;
+        }
+        --src_load;
+        ++dst_load;
+        ret.push_back(transfer{.ntp = c.ntp, .target = target->node});
+    }
+    return ret;
+}
+
+ss::future<> leader_balancer::balance() {
+    const auto now = clock_type::now();
+    absl::erase_if(_muted, [now](const auto& p) { return p.second <= now; });
+
+    load_map loads;
+    auto transfers = plan(loads);
+    _last_report = make_report(loads);
+    vlog(
+      clusterlog.debug,
+      "Leader distribution: {}, scheduling {} leadership transfers",
+      _last_report,
+      transfers.size());
+    return ss::do_with(
+      std::move(transfers), [this](std::vector<transfer>& transfers) {
+          return ss::do_for_each(transfers, [this](transfer& t) {
+              return do_transfer(std::move(t));
+          });
+      });
+}
+
+ss::future<> leader_balancer::do_transfer(transfer t) {
+    _muted[t.ntp] = clock_type::now() + _mute_timeout;
+    auto shard = _shard_table.local().shard_for(t.ntp);
+    if (!shard) {
+        return ss::now();
+    }
+    return _partition_manager
+      .invoke_on(
+        *shard,
+        [ntp = t.ntp, target = t.target](partition_manager& pm) {
+            auto p = pm.get(ntp);
+            if (!p) {
+                return ss::make_ready_future<std::error_code>(
+                  errc::partition_not_exists);
+            }
+            return p->transfer_leadership(target);
+        })
+      .then([this, t = std::move(t)](std::error_code ec) {
+          if (ec) {
+              ++_failed_transfers;
+              vlog(
+                clusterlog.info,
+                "Leadership transfer of {} to node {} failed: {}",
+                t.ntp,
+                t.target,
+                ec.message());
+              return;
+          }
+          ++_transfers;
+          vlog(
+            clusterlog.info,
+            "Transferred leadership of {} to node {}",
+            t.ntp,
+            t.target);
+      });
+}
+
+std::ostream&
+operator<<(std::ostream& o, const leader_balancer::skew_report& r) {
+    fmt::print(
+      o,
+      "{{shards: {}, leaders: {}, min: {}, max: {}, mean: {:.2f}}}",
+      r.shards,
+      r.leaders,
+      r.min_leaders,
+      r.max_leaders,
+      r.mean_leaders);
+    return o;
+}
+
+} // namespace cluster
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2020 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "cluster/partition_leaders_table.h"
+#include "cluster/partition_manager.h"
+#include "cluster/shard_table.h"
+#include "cluster/topic_table.h"
+#include "model/fundamental.h"
+#include "model/metadata.h"
+
+#include <seastar/core/gate.hh>
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/core/metrics_registration.hh>
+#include <seastar/core/sharded.hh>
+#include <seastar/core/timer.hh>
+
+#include <absl/container/flat_hash_map.h>
+
+namespace cluster {
+
+struct leader_balancer_tester;
+
+/// The leader balancer moves raft leadership of partitions led by this node
+/// towards the replica (node, shard) that currently leads the fewest
+/// partitions. Every node only gives away leadership it holds, so no
+/// coordination between nodes is required: each node converges towards the
+/// cluster wide per-shard mean independently.
+///
+/// Transfers are rate limited per tick, and a partition whose leadership was
+/// moved is left alone for a mute period to avoid churn while the leadership
+/// table catches up with the elections.
+///
+/// There is only one instance running on core-0.
+class leader_balancer {
+public:
+    static constexpr ss::shard_id shard = 0;
+
+    /// Leader distribution over all (node, shard) pairs hosting a replica
+    struct skew_report {
+        size_t shards{0};
+        size_t leaders{0};
+        size_t min_leaders{0};
+        size_t max_leaders{0};
+        double mean_leaders{0.};
+
+        friend std::ostream& operator<<(std::ostream&, const skew_report&);
+    };
+
+    leader_balancer(
+      ss::sharded<topic_table>&,
+      ss::sharded<partition_leaders_table>&,
+      ss::sharded<shard_table>&,
+      ss::sharded<partition_manager>&);
+
+    ss::future<> start();
+    ss::future<> stop();
+
+    skew_report report() const { return _last_report; }
+
+private:
+    friend leader_balancer_tester;
+
+    struct shard_key {
+        model::node_id node;
+        uint32_t shard;
+
+        template<typename H>
+        friend H AbslHashValue(H h, const shard_key& k) {
+            return H::combine(std::move(h), k.node(), k.shard);
+        }
+        bool operator==(const shard_key& o) const {
+            return node == o.node && shard == o.shard;
+        }
+    };
+
+    struct transfer {
+        model::ntp ntp;
+        model::node_id target;
+    };
+
+    using clock_type = ss::lowres_clock;
+    using load_map = absl::flat_hash_map<shard_key, size_t>;
+
+    void arm();
+    void setup_metrics();
+    ss::future<> balance();
+    std::vector<transfer> plan(load_map&);
+    ss::future<> do_transfer(transfer);
+    static skew_report make_report(const load_map&);
+
+    model::node_id _self;
+    const clock_type::duration _interval;
+    const clock_type::duration _mute_timeout;
+    const size_t _max_transfers;
+    ss::sharded<topic_table>& _topics;
+    ss::sharded<partition_leaders_table>& _leaders;
+    ss::sharded<shard_table>& _shard_table;
+    ss::sharded<partition_manager>& _partition_manager;
+    absl::flat_hash_map<model::ntp, clock_type::time_point> _muted;
+    skew_report _last_report;
+    uint64_t _transfers{0};
+    uint64_t _failed_transfers{0};
+    ss::timer<clock_type> _timer;
+    ss::gate _gate;
+    ss::metrics::metric_groups _metrics;
+};
+
+} // namespace cluster
@@ -49,6 +49,21 @@ public:
         return _raft->make_reader(std::move(config), deadline);
     }
 
+    /**
+     * Reads batches without materializing them, see storage::log::read_raw.
+     * Same visibility rules as make_reader.
+     */
+    ss::future<storage::raw_read_result> read_raw(
+      storage::log_reader_config config, storage::use_batch_cache cache) {
+        return _raft->read_raw(std::move(config), cache);
+    }
+
+    /// serves a tail-following read from memory, see storage::log::read_tail
+    std::optional<storage::raw_read_result>
+    read_tail(storage::log_reader_config config) {
+        return _raft->read_tail(std::move(config));
+    }
+
     model::offset start_offset() const { return _raft->start_offset(); }
 
     /**
@@ -0,0 +1,160 @@
+// Copyright 2020 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "cluster/leader_balancer.h"
+#include "cluster/tests/utils.h"
+#include "cluster/topic_table.h"
+#include "config/configuration.h"
+#include "model/fundamental.h"
+#include "test_utils/fixture.h"
+
+#include <seastar/testing/thread_test_case.hh>
+
+#include <map>
+#include <set>
+
+using namespace std::chrono_literals;
+
+namespace cluster {
+struct leader_balancer_tester {
+    using loads_t = std::map<std::pair<model::node_id, uint32_t>, size_t>;
+
+    explicit leader_balancer_tester(leader_balancer& b)
+      : balancer(b) {}
+
+    // planned transfers and the leader counts expected once they complete
+    std::pair<std::vector<leader_balancer::transfer>, loads_t> plan() {
+        leader_balancer::load_map loads;
+        auto transfers = balancer.plan(loads);
+        loads_t ret;
+        for (auto& [k, n] : loads) {
+            ret.emplace(std::make_pair(k.node, k.shard), n);
+        }
+        return {std::move(transfers), std::move(ret)};
+    }
+
+    void mute(const model::ntp& ntp) {
+        balancer._muted[ntp] = leader_balancer::clock_type::now() + 1h;
+    }
+
+    leader_balancer& balancer;
+};
+} // namespace cluster
+
+struct leader_balancer_fixture {
+    static constexpr int partitions = 6;
+
+    leader_balancer_fixture()
+      : prev_node_id(config::shard_local_cfg().node_id()) {
+        // plan() only gives away leadership held by this node
+        config::shard_local_cfg().get("node_id").set_value(int32_t(1));
+        topics.start().get0();
+        leaders.start().get0();
+        balancer = std::make_unique<cluster::leader_balancer>(
+          topics, leaders, shards, pm);
+
+        // every partition is replicated on shard 0 of nodes 1, 2 and 3
+        cluster::topic_configuration cfg(
+          test_ns, model::topic("tp"), partitions, 3);
+        std::vector<cluster::partition_assignment> pas;
+        for (int i = 0; i < partitions; ++i) {
+            pas.push_back(cluster::partition_assignment{
+              .group = raft::group_id(i),
+              .id = model::partition_id(i),
+              .replicas = {
+                {model::node_id(1), 0},
+                {model::node_id(2), 0},
+                {model::node_id(3), 0}}});
+        }
+        auto res = topics.local()
+                     .apply(
+                       cluster::create_topic_cmd(
+                         model::topic_namespace(test_ns, model::topic("tp")),
+                         cluster::topic_configuration_assignment(
+                           cfg, std::move(pas))),
+                       model::offset(0))
+                     .get0();
+        BOOST_REQUIRE_EQUAL(res, cluster::errc::success);
+    }
+
+    ~leader_balancer_fixture() {
+        balancer.reset();
+        leaders.stop().get0();
+        topics.stop().get0();
+        config::shard_local_cfg().get("node_id").set_value(prev_node_id);
+    }
+
+    model::ntp ntp(int p) const {
+        return model::ntp(test_ns, model::topic("tp"), model::partition_id(p));
+    }
+
+    void set_leader(int p, int node) {
+        leaders.local().update_partition_leader(
+          ntp(p), model::term_id(1), model::node_id(node));
+    }
+
+    int32_t prev_node_id;
+    ss::sharded<cluster::topic_table> topics;
+    ss::sharded<cluster::partition_leaders_table> leaders;
+    // not started, plan() does not use them
+    ss::sharded<cluster::shard_table> shards;
+    ss::sharded<cluster::partition_manager> pm;
+    std::unique_ptr<cluster::leader_balancer> balancer;
+};
+
+FIXTURE_TEST(test_plan_evens_skewed_leaders, leader_balancer_fixture) {
+    for (int p = 0; p < partitions; ++p) {
+        set_leader(p, 1);
+    }
+    cluster::leader_balancer_tester t(*balancer);
+    auto [transfers, loads] = t.plan();
+
+    // 6/0/0 converges to 2/2/2 with followers picked alternately
+    BOOST_REQUIRE_EQUAL(transfers.size(), 4);
+    std::map<model::node_id, int> targets;
+    std::set<model::partition_id> moved;
+    for (auto& tr : transfers) {
+        ++targets[tr.target];
+        moved.insert(tr.ntp.tp.partition);
+    }
+    BOOST_REQUIRE_EQUAL(moved.size(), 4);
+    BOOST_REQUIRE_EQUAL(targets[model::node_id(2)], 2);
+    BOOST_REQUIRE_EQUAL(targets[model::node_id(3)], 2);
+    for (int n = 1; n <= 3; ++n) {
+        BOOST_REQUIRE_EQUAL((loads[{model::node_id(n), 0}]), 2);
+    }
+}
+
+FIXTURE_TEST(test_plan_keeps_balanced_leaders, leader_balancer_fixture) {
+    for (int p = 0; p < partitions; ++p) {
+        set_leader(p, 1 + p % 3);
+    }
+    cluster::leader_balancer_tester t(*balancer);
+    BOOST_REQUIRE(t.plan().first.empty());
+}
+
+FIXTURE_TEST(test_plan_skips_muted_and_remote_leaders, leader_balancer_fixture) {
+    // node 1 leads 0..3, node 2 leads 4 and 5: 4/2/0
+    for (int p = 0; p < partitions; ++p) {
+        set_leader(p, p < 4 ? 1 : 2);
+    }
+    cluster::leader_balancer_tester t(*balancer);
+    for (int p = 0; p < 3; ++p) {
+        t.mute(ntp(p));
+    }
+    auto [transfers, loads] = t.plan();
+
+    // only the unmuted partition led by this node is moved, to node 3
+    BOOST_REQUIRE_EQUAL(transfers.size(), 1);
+    BOOST_REQUIRE_EQUAL(transfers[0].ntp, ntp(3));
+    BOOST_REQUIRE_EQUAL(transfers[0].target, model::node_id(3));
+    BOOST_REQUIRE_EQUAL((loads[{model::node_id(1), 0}]), 3);
+    BOOST_REQUIRE_EQUAL((loads[{model::node_id(2), 0}]), 2);
+    BOOST_REQUIRE_EQUAL((loads[{model::node_id(3), 0}]), 1);
+}
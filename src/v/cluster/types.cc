@@ -36,7 +36,7 @@ storage::ntp_config topic_configuration::make_ntp_config(
                          || segment_size || retention_bytes.has_value()
                          || retention_bytes.is_disabled()
                          || retention_duration.has_value()
-                         || retention_duration.is_disabled();
+                         || retention_duration.is_disabled() || compression;
     std::unique_ptr<storage::ntp_config::default_overrides> overrides = nullptr;
 
     if (has_overrides) {
@@ -46,7 +46,8 @@ storage::ntp_config topic_configuration::make_ntp_config(
             .compaction_strategy = compaction_strategy,
             .segment_size = segment_size,
             .retention_bytes = retention_bytes,
-            .retention_time = retention_duration});
+            .retention_time = retention_duration,
+            .compression = compression});
     }
     return storage::ntp_config(
       model::ntp(tp_ns.ns, tp_ns.tp, p_id),
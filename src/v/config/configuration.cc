@@ -67,6 +67,12 @@ configuration::configuration()
       "IpAddress and port for supervisor service",
       required::no,
       unresolved_address("127.0.0.1", 43189))
+  , coproc_max_inflight_bytes(
+      *this,
+      "coproc_max_inflight_bytes",
+      "Maximum number of bytes each coprocessor script may have in flight",
+      required::no,
+      10_MiB)
   , node_id(
       *this,
       "node_id",
@@ -157,9 +163,21 @@ configuration::configuration()
   , target_quota_byte_rate(
       *this,
       "target_quota_byte_rate",
-      "Target quota byte rate (bytes per second) - 64MB default",
+      "Target produce quota byte rate (bytes per second) - 64MB default",
+      required::no,
+      64_MiB)
+  , target_fetch_quota_byte_rate(
+      *this,
+      "target_fetch_quota_byte_rate",
+      "Target fetch quota byte rate (bytes per second) - 64MB default",
       required::no,
       64_MiB)
+  , quota_manager_aggregation_interval_ms(
+      *this,
+      "quota_manager_aggregation_interval_ms",
+      "How often per-client throughput is aggregated across cores",
+      required::no,
+      1000ms)
   , rack(*this, "rack", "Rack identifier", required::no, std::nullopt)
   , disable_metrics(
       *this,
@@ -257,6 +275,27 @@ configuration::configuration()
       "Disable batch cache in log manager",
       required::no,
       false)
+  , storage_recovery_concurrency(
+      *this,
+      "storage_recovery_concurrency",
+      "Maximum number of concurrent segment opens and index hydrations per "
+      "core while recovering logs",
+      required::no,
+      16)
+  , segment_reader_max_open_files(
+      *this,
+      "segment_reader_max_open_files",
+      "Maximum number of idle segment files kept open for reading per core. "
+      "Least recently used files are closed and re-opened on demand",
+      required::no,
+      4096)
+  , enable_segment_extent_cache(
+      *this,
+      "enable_segment_extent_cache",
+      "Cache raw segment file extents shared by all readers of a core, so "
+      "that concurrent catch-up reads of the same data hit disk once",
+      required::no,
+      true)
   , raft_election_timeout_ms(
       *this,
       "election_timeout_ms",
@@ -336,6 +375,43 @@ configuration::configuration()
       "Fail-safe maximum throttle delay on kafka requests",
       required::no,
       60'000ms)
+  , kafka_fetch_raw_reads(
+      *this,
+      "kafka_fetch_raw_reads",
+      "Serve fetches by splicing the on-disk batch bytes into the response "
+      "instead of materializing record batches",
+      required::no,
+      true)
+  , kafka_fetch_raw_reads_from_batch_cache(
+      *this,
+      "kafka_fetch_raw_reads_from_batch_cache",
+      "Let raw fetch reads splice the buffers of batches held in the batch "
+      "cache instead of reading them from disk",
+      required::no,
+      true)
+  , fetch_session_cache_max_sessions(
+      *this,
+      "fetch_session_cache_max_sessions",
+      "Maximum number of incremental fetch sessions cached per core. Zero "
+      "disables fetch sessions",
+      required::no,
+      1000)
+  , kafka_max_inflight_requests_per_connection(
+      *this,
+      "kafka_max_inflight_requests_per_connection",
+      "Maximum number of requests of a kafka connection being processed or "
+      "waiting for their response to be sent. Reading further requests from "
+      "the connection waits for one of them to complete",
+      required::no,
+      32)
+  , kafka_produce_streaming_threshold(
+      *this,
+      "kafka_produce_streaming_threshold",
+      "Produce requests at least this large are decoded while they are read "
+      "so that each partition starts replicating as soon as its batch "
+      "arrives. 0 disables streaming",
+      required::no,
+      1_MiB)
   , raft_io_timeout_ms(
       *this, "raft_io_timeout_ms", "Raft I/O timeout", required::no, 10'000ms)
   , join_retry_timeout_ms(
@@ -368,6 +444,44 @@ configuration::configuration()
       "Maximum delay until buffered data is written",
       required::no,
       std::chrono::milliseconds(1s))
+  , segment_appender_max_write_size(
+      *this,
+      "segment_appender_max_write_size",
+      "Largest write, in bytes, a segment appender submits at once; full "
+      "write-behind chunks are batched up to this size",
+      required::no,
+      256_KiB)
+  , log_tail_buffer_max_bytes(
+      *this,
+      "log_tail_buffer_max_bytes",
+      "Bytes of the most recently appended batches each leader partition "
+      "keeps in memory to serve tail-following fetches; 0 disables it",
+      required::no,
+      128_KiB)
+  , enable_leader_balancer(
+      *this,
+      "enable_leader_balancer",
+      "Move partition leaders to even out leadership across shards and nodes",
+      required::no,
+      false)
+  , leader_balancer_interval_ms(
+      *this,
+      "leader_balancer_interval_ms",
+      "Time between leader balancer runs",
+      required::no,
+      1min)
+  , leader_balancer_mute_timeout_ms(
+      *this,
+      "leader_balancer_mute_timeout_ms",
+      "Time a partition is left alone after its leadership was moved",
+      required::no,
+      5min)
+  , leader_balancer_max_transfers(
+      *this,
+      "leader_balancer_max_transfers",
+      "Maximum number of leadership transfers per leader balancer run",
+      required::no,
+      8)
   , _advertised_kafka_api(
       *this,
       "advertised_kafka_api",
@@ -40,6 +40,7 @@ struct configuration final : public config_store {
     property<bool> enable_coproc;
     property<unresolved_address> coproc_script_manager_server;
     property<unresolved_address> coproc_supervisor_server;
+    property<size_t> coproc_max_inflight_bytes;
     // Raft
     property<int32_t> node_id;
     property<int32_t> seed_server_meta_topic_partitions;
@@ -59,6 +60,8 @@ struct configuration final : public config_store {
     property<std::chrono::milliseconds> default_window_sec;
     property<std::chrono::milliseconds> quota_manager_gc_sec;
     property<uint32_t> target_quota_byte_rate;
+    property<uint32_t> target_fetch_quota_byte_rate;
+    property<std::chrono::milliseconds> quota_manager_aggregation_interval_ms;
     property<std::optional<ss::sstring>> rack;
     property<bool> disable_metrics;
     property<std::chrono::milliseconds> group_min_session_timeout_ms;
@@ -77,6 +80,9 @@ struct configuration final : public config_store {
     property<std::chrono::milliseconds> wait_for_leader_timeout_ms;
     property<int32_t> default_topic_partitions;
     property<bool> disable_batch_cache;
+    property<size_t> storage_recovery_concurrency;
+    property<size_t> segment_reader_max_open_files;
+    property<bool> enable_segment_extent_cache;
     property<std::chrono::milliseconds> raft_election_timeout_ms;
     property<std::chrono::milliseconds> kafka_group_recovery_timeout_ms;
     property<std::chrono::milliseconds> replicate_append_timeout_ms;
@@ -91,6 +97,11 @@ struct configuration final : public config_store {
     property<std::chrono::milliseconds> kvstore_flush_interval;
     property<size_t> kvstore_max_segment_size;
     property<std::chrono::milliseconds> max_kafka_throttle_delay_ms;
+    property<bool> kafka_fetch_raw_reads;
+    property<bool> kafka_fetch_raw_reads_from_batch_cache;
+    property<size_t> fetch_session_cache_max_sessions;
+    property<size_t> kafka_max_inflight_requests_per_connection;
+    property<size_t> kafka_produce_streaming_threshold;
     property<std::chrono::milliseconds> raft_io_timeout_ms;
     property<std::chrono::milliseconds> join_retry_timeout_ms;
     property<std::chrono::milliseconds> raft_timeout_now_timeout_ms;
@@ -98,6 +109,12 @@ struct configuration final : public config_store {
       raft_transfer_leader_recovery_timeout_ms;
     property<bool> release_cache_on_segment_roll;
     property<std::chrono::milliseconds> segment_appender_flush_timeout_ms;
+    property<size_t> segment_appender_max_write_size;
+    property<size_t> log_tail_buffer_max_bytes;
+    property<bool> enable_leader_balancer;
+    property<std::chrono::milliseconds> leader_balancer_interval_ms;
+    property<std::chrono::milliseconds> leader_balancer_mute_timeout_ms;
+    property<size_t> leader_balancer_max_transfers;
 
     configuration();
 
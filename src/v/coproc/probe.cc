@@ -0,0 +1,54 @@
+// Copyright 2020 Vectorized, Inc.
+//
+// Licensed as a Redpanda Enterprise file under the Redpanda Community
+// License (the "License"); you may not use this file except in compliance with
+// the License. You may obtain a copy of the License at
+//
+// https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+
+#include "coproc/probe.h"
+
+#include "config/configuration.h"
+#include "prometheus/prometheus_sanitize.h"
+
+#include <seastar/core/metrics.hh>
+
+namespace coproc {
+
+void script_probe::setup_metrics(script_id id) {
+    if (config::shard_local_cfg().disable_metrics()) {
+        return;
+    }
+    namespace sm = ss::metrics;
+    auto script_label = sm::label("script_id");
+    const std::vector<sm::label_instance> labels = {script_label(id())};
+    _metrics.add_group(
+      prometheus_sanitize::metrics_name("coproc:router"),
+      {sm::make_derive(
+         "requests_sent",
+         [this] { return _requests_sent; },
+         sm::description("Number of process batch requests sent"),
+         labels),
+       sm::make_derive(
+         "bytes_sent",
+         [this] { return _bytes_sent; },
+         sm::description("Number of bytes sent to the coprocessor engine"),
+         labels),
+       sm::make_derive(
+         "request_errors",
+         [this] { return _request_errors; },
+         sm::description("Number of failed process batch requests"),
+         labels),
+       sm::make_derive(
+         "credit_waits",
+         [this] { return _credit_waits; },
+         sm::description("Number of requests that waited for credits"),
+         labels),
+       sm::make_histogram(
+         "request_latency",
+         [this] { return _latency.seastar_histogram_logform(); },
+         sm::description("Process batch request latency"),
+         labels)});
+}
+
+} // namespace coproc
@@ -0,0 +1,45 @@
+/*
+ * Copyright 2020 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#pragma once
+#include "coproc/types.h"
+#include "utils/hdr_hist.h"
+
+#include <seastar/core/metrics_registration.hh>
+
+#include <cstdint>
+#include <memory>
+
+namespace coproc {
+
+/// Per script statistics on the traffic routed to the coprocessor engine
+class script_probe {
+public:
+    void setup_metrics(script_id);
+    void clear_metrics() { _metrics.clear(); }
+
+    std::unique_ptr<hdr_hist::measurement> request_sent(size_t bytes) {
+        ++_requests_sent;
+        _bytes_sent += bytes;
+        return _latency.auto_measure();
+    }
+    void request_failed() { ++_request_errors; }
+    void waiting_for_credits() { ++_credit_waits; }
+
+private:
+    uint64_t _requests_sent{0};
+    uint64_t _bytes_sent{0};
+    uint64_t _request_errors{0};
+    uint64_t _credit_waits{0};
+    hdr_hist _latency;
+    ss::metrics::metric_groups _metrics;
+};
+
+} // namespace coproc
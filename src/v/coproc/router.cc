@@ -8,6 +8,7 @@
 
 #include "coproc/router.h"
 
+#include "config/configuration.h"
 #include "coproc/logger.h"
 #include "coproc/reference_window_consumer.hpp"
 #include "coproc/supervisor.h"
@@ -24,28 +25,38 @@
 #include <seastar/core/gate.hh>
 #include <seastar/core/loop.hh>
 #include <seastar/core/map_reduce.hh>
+#include <seastar/util/later.hh>
 
 #include <absl/container/flat_hash_map.h>
 
+#include <algorithm>
+
 namespace coproc {
 
-ss::future<std::optional<router::offset_rbr_pair>>
+/// The original ntp of a reply, without the .$<destination>$ part of the topic
+static model::ntp source_ntp(const model::ntp& ntp) {
+    const auto mt = model::make_materialized_topic(ntp.tp.topic);
+    return mt ? model::ntp(ntp.ns, mt->src, ntp.tp.partition) : ntp;
+}
+
+ss::future<std::optional<router::offset_batches_pair>>
 router::extract_offset(model::record_batch_reader reader) {
     return model::consume_reader_to_memory(std::move(reader), model::no_timeout)
       .then([](model::record_batch_reader::data_t data) {
           if (data.empty()) {
-              return std::optional<offset_rbr_pair>(std::nullopt);
+              return std::optional<offset_batches_pair>(std::nullopt);
           }
           const auto last_offset = data.back().last_offset();
-          return std::optional<offset_rbr_pair>(std::make_pair(
-            last_offset,
-            model::make_memory_record_batch_reader(std::move(data))));
+          return std::optional<offset_batches_pair>(
+            std::make_pair(last_offset, std::move(data)));
       });
 }
 
 router::router(ss::socket_address addr, ss::sharded<storage::api>& api)
   : _api(api)
-  , _jitter(std::chrono::milliseconds(10))
+  , _max_inflight_bytes(
+      config::shard_local_cfg().coproc_max_inflight_bytes())
+  , _jitter(std::chrono::milliseconds(100))
   , _transport(
       {rpc::transport_configuration{
         .server_addr = addr, .credentials = nullptr}},
@@ -75,64 +86,262 @@ ss::future<result<supervisor_client_protocol>> router::get_client() {
       });
 }
 
+ss::future<> router::start() {
+    _retry_timer.set_callback([this] { maybe_dispatch_route(); });
+    _flush_notification
+      = _api.local().log_mgr().register_flush_notification(
+        [this](const model::ntp& ntp, model::offset) { notify_flushed(ntp); });
+    return ss::now();
+}
+
+ss::future<> router::stop() {
+    if (_flush_notification) {
+        _api.local().log_mgr().unregister_flush_notification(
+          *_flush_notification);
+        _flush_notification = std::nullopt;
+    }
+    _retry_timer.cancel();
+    _abort_source.request_abort();
+    for (auto& [_, state] : _scripts) {
+        // unblocks queues waiting for credits
+        state->credits.broken();
+    }
+    return _gate.close().then([this] { return _transport.stop(); });
+}
+
+void router::notify_flushed(const model::ntp& ntp) {
+    if (_sources.contains(ntp)) {
+        _pending.emplace(ntp);
+        maybe_dispatch_route();
+    }
+}
+
+void router::maybe_dispatch_route() {
+    if (_routing || _pending.empty() || _gate.is_closed()) {
+        return;
+    }
+    _routing = true;
+    _retry_timer.cancel();
+    // defer to a new task so that flushes of several ntps that complete
+    // together are routed as one batch
+    (void)ss::with_gate(_gate, [this] {
+        return ss::later()
+          .then([this] { return route(); })
+          .handle_exception([](std::exception_ptr e) {
+              vlog(coproclog.error, "Error routing coproc batch: {}", e);
+          })
+          .finally([this] {
+              _routing = false;
+              maybe_dispatch_route();
+          });
+    });
+}
+
+void router::requeue_lagging(
+  const std::vector<model::ntp>& routed, bool progress) {
+    bool lagging = false;
+    for (const auto& ntp : routed) {
+        auto found = _sources.find(ntp);
+        if (found == _sources.end() || _held.contains(ntp)) {
+            continue;
+        }
+        const auto end = found->second.log.offsets().committed_offset;
+        // scripts with a request in flight are routed again once it completes
+        const auto& scripts = found->second.scripts;
+        if (std::any_of(
+              scripts.begin(), scripts.end(), [end](const auto& p) {
+                  return !p.second.inflight() && p.second.committed < end;
+              })) {
+            _pending.emplace(ntp);
+            lagging = true;
+        }
+    }
+    if (lagging && !progress && !_gate.is_closed()) {
+        // nothing moved forward, avoid spinning until the engine recovers
+        _retry_timer.rearm(_jitter());
+    }
+}
+
 ss::future<> router::route() {
     /**
-     * Main run loop, polls constantly for new data on registered ntps.
-     * New data is defined as the latest offset being greater then the
-     * last observed offset for that ntp.
+     * Main routing pass, consumes the set of ntps for which the storage layer
+     * reported new data. New data is defined as the latest offset being
+     * greater then the last observed offset for that ntp.
      *
      * Data is consumed from the topic (max 32KiB read) and sent to the
      * interested topics, the reply is processed as writes to new materialized
-     * topics.
+     * topics. Ntps that still have data left to read are queued again.
      *
-     * The loop is broken if the abort_source has been initiated externally or
+     * Routing stops if the abort_source has been initiated externally or
      * it can be initiated internally by detection of a failed connection to the
      * engine (after retry policy expires)
      */
-    try {
-        return ss::with_gate(_gate, [this] {
-            if (unlikely(_abort_source.abort_requested())) {
-                vlog(
-                  coproclog.info, "Abort source triggered, shutting down loop");
-                return ss::now();
-            }
-            return do_route();
-        });
-    } catch (const ss::gate_closed_exception& gce) {
-        vlog(coproclog.debug, "Gate closed exception encountered: {}", gce);
+    if (unlikely(_abort_source.abort_requested())) {
+        vlog(coproclog.info, "Abort source triggered, shutting down loop");
         return ss::now();
     }
+    return do_route();
 }
 
 ss::future<> router::do_route() {
-    auto reducer =
-      [](std::vector<process_batch_request::data> acc, opt_req_data x) {
-          if (x.has_value()) {
-              acc.emplace_back(std::move(*x));
-          }
-          return acc;
-      };
-    return ss::map_reduce(
-             _sources.begin(),
-             _sources.end(),
-             [this](std::pair<const model::ntp, topic_state>& p) {
-                 return route_ntp(p.first, p.second);
-             },
-             std::vector<process_batch_request::data>(),
-             std::move(reducer))
-      .then([this](std::vector<process_batch_request::data> batch) {
-          return process_batch(std::move(batch));
-      })
-      .then([this, next_loop = _jitter()] { _loop_timer.rearm(next_loop); });
+    auto reducer = [](std::vector<ntp_batches> acc, opt_ntp_batches x) {
+        if (x.has_value()) {
+            acc.emplace_back(std::move(*x));
+        }
+        return acc;
+    };
+    std::vector<model::ntp> routed;
+    routed.reserve(_pending.size());
+    for (auto& ntp : _pending) {
+        auto found = _sources.find(ntp);
+        if (found == _sources.end()) {
+            continue;
+        }
+        if (backlogged(found->second)) {
+            _held.emplace(ntp);
+            continue;
+        }
+        routed.emplace_back(ntp);
+    }
+    _pending.clear();
+    return ss::do_with(
+      std::move(routed),
+      [this, reducer = std::move(reducer)](
+        std::vector<model::ntp>& routed) mutable {
+          return ss::map_reduce(
+                   routed.begin(),
+                   routed.end(),
+                   [this](const model::ntp& ntp) {
+                       auto found = _sources.find(ntp);
+                       if (found == _sources.end()) {
+                           return ss::make_ready_future<opt_ntp_batches>(
+                             std::nullopt);
+                       }
+                       return route_ntp(ntp, found->second);
+                   },
+                   std::vector<ntp_batches>(),
+                   std::move(reducer))
+            .then([this, &routed](std::vector<ntp_batches> batch) {
+                const bool progress = !batch.empty();
+                // requests are sent by the queue of each script, routing
+                // does not wait for their replies
+                enqueue_batch(std::move(batch));
+                requeue_lagging(routed, progress);
+            });
+      });
 }
 
-ss::future<>
-router::process_batch(std::vector<process_batch_request::data> batch) {
-    if (batch.empty()) {
-        return ss::now();
+bool router::backlogged(const topic_state& ts) const {
+    return std::any_of(
+      ts.scripts.begin(), ts.scripts.end(), [this](const auto& p) {
+          auto found = _scripts.find(p.first);
+          return found != _scripts.end()
+                 && found->second->queued_bytes >= _max_inflight_bytes;
+      });
+}
+
+absl::flat_hash_map<script_id, std::vector<router::script_request>>
+router::partition_by_script(std::vector<ntp_batches> batch) {
+    /// Every script receives its own copy (shared buffers) of the batches
+    /// of the ntps it tracks, past the last offset it processed. Requests for
+    /// a script are capped to the script credit window so a single request
+    /// can always be admitted.
+    absl::flat_hash_map<script_id, std::vector<script_request>> by_script;
+    for (auto& nb : batch) {
+        for (const auto& [id, committed] : nb.scripts) {
+            if (!_scripts.contains(id)) {
+                continue;
+            }
+            size_t bytes = 0;
+            model::record_batch_reader::data_t copy;
+            copy.reserve(nb.batches.size());
+            for (auto& b : nb.batches) {
+                if (b.base_offset() > committed) {
+                    bytes += b.size_bytes();
+                    copy.push_back(b.share());
+                }
+            }
+            auto& reqs = by_script[id];
+            if (
+              reqs.empty()
+              || reqs.back().bytes + bytes > _max_inflight_bytes) {
+                reqs.emplace_back().id = id;
+            }
+            auto& req = reqs.back();
+            req.bytes += bytes;
+            req.offsets[nb.ntp] = nb.last_offset;
+            req.req.reqs.push_back(process_batch_request::data{
+              .ids = {id},
+              .ntp = nb.ntp,
+              .reader = model::make_memory_record_batch_reader(
+                std::move(copy))});
+        }
+    }
+    return by_script;
+}
+
+void router::enqueue_batch(std::vector<ntp_batches> batch) {
+    for (auto& [id, reqs] : partition_by_script(std::move(batch))) {
+        auto& state = _scripts.find(id)->second;
+        for (auto& r : reqs) {
+            state->queued_bytes += r.bytes;
+            state->queue.push_back(std::move(r));
+        }
+        maybe_drain(state);
+    }
+}
+
+void router::maybe_drain(ss::lw_shared_ptr<script_state> state) {
+    if (state->draining || state->queue.empty() || _gate.is_closed()) {
+        return;
+    }
+    state->draining = true;
+    (void)ss::with_gate(_gate, [this, state] {
+        return ss::do_until(
+                 [state] { return state->queue.empty(); },
+                 [this, state] { return send_next(state); })
+          .handle_exception_type([](const ss::broken_semaphore&) {
+              // the script was removed or the router is stopping
+          })
+          .handle_exception([](std::exception_ptr e) {
+              vlog(coproclog.error, "Error sending coproc requests: {}", e);
+          })
+          .finally([this, state] {
+              state->draining = false;
+              // ntps held back by a backlogged script are routed again
+              for (auto& ntp : std::exchange(_held, {})) {
+                  _pending.emplace(ntp);
+              }
+              maybe_dispatch_route();
+          });
+    });
+}
+
+ss::future<> router::send_next(ss::lw_shared_ptr<script_state> state) {
+    auto r = std::move(state->queue.front());
+    state->queue.pop_front();
+    state->queued_bytes -= r.bytes;
+    const auto units = std::min(r.bytes, _max_inflight_bytes);
+    if (state->credits.available_units() < static_cast<ssize_t>(units)) {
+        state->probe.waiting_for_credits();
     }
+    return ss::get_units(state->credits, units)
+      .then([this, state, r = std::move(r)](ss::semaphore_units<> u) mutable {
+          // the reply is awaited in the background, the next request goes
+          // out as soon as the credit window allows
+          (void)ss::with_gate(
+            _gate,
+            [this, state, r = std::move(r), u = std::move(u)]() mutable {
+                return send_script_request(state, std::move(r))
+                  .finally([u = std::move(u)] {});
+            });
+      });
+}
+
+ss::future<> router::send_script_request(
+  ss::lw_shared_ptr<script_state> state, script_request r) {
     return get_client().then(
-      [this, batch = std::move(batch)](
+      [this, state, r = std::move(r)](
         result<supervisor_client_protocol> transport) mutable {
           if (!transport) {
               const auto err = transport.error();
@@ -143,92 +352,171 @@ router::process_batch(std::vector<process_batch_request::data> batch) {
                     "coproc server");
                   _abort_source.request_abort();
               }
+              for (const auto& [ntp, _] : r.offsets) {
+                  rewind(ntp, r.id);
+              }
               return ss::now();
           }
-          return send_batch(
-            transport.value(), process_batch_request{.reqs = std::move(batch)});
+          auto m = state->probe.request_sent(r.bytes);
+          return send_batch(transport.value(), std::move(r), state)
+            .finally([m = std::move(m)] {});
       });
 }
 
-ss::future<router::opt_req_data>
+ss::future<router::opt_ntp_batches>
 router::route_ntp(const model::ntp& ntp, topic_state& ts) {
     /**
-     * Making a reader will grab a mutual exclusion lock on reading from the
-     * requested log. This is OK for now since the only topic_ingestion_policy
-     * supported will be 'latest'
-     *
-     * The last offset is recorded and the request is prepared and returned.
+     * A script has at most one request in flight per ntp, so that its replies
+     * are applied in order. The data is read once, from the lowest committed
+     * offset of the scripts with nothing in flight, and each of them is sent
+     * the part past its own committed offset.
      */
-    return make_reader_cfg(ts.log, ts.head)
-      .then([this, ntp, log = ts.log, sids = ts.scripts](
-              opt_cfg config) mutable {
-          if (!config) {
-              return ss::make_ready_future<opt_req_data>(std::nullopt);
+    std::vector<std::pair<script_id, model::offset>> ready;
+    for (const auto& [id, offsets] : ts.scripts) {
+        if (!offsets.inflight()) {
+            ready.emplace_back(id, offsets.committed);
+        }
+    }
+    if (ready.empty()) {
+        return ss::make_ready_future<opt_ntp_batches>(std::nullopt);
+    }
+    const auto from = std::min_element(
+                        ready.begin(),
+                        ready.end(),
+                        [](const auto& a, const auto& b) {
+                            return a.second < b.second;
+                        })
+                        ->second;
+    auto config = make_reader_cfg(ts.log, from);
+    if (!config) {
+        return ss::make_ready_future<opt_ntp_batches>(std::nullopt);
+    }
+    return ts.log.make_reader(*config)
+      .then([this](model::record_batch_reader reader) {
+          return extract_offset(std::move(reader));
+      })
+      .then([this, ntp, ready = std::move(ready)](
+              std::optional<offset_batches_pair> p) mutable {
+          if (!p) {
+              return opt_ntp_batches(std::nullopt);
           }
-          return log.make_reader(*config)
-            .then([this, ntp](model::record_batch_reader reader) {
-                return extract_offset(std::move(reader));
-            })
-            .then([this, ntp, sids = std::move(sids)](
-                    std::optional<offset_rbr_pair> p) {
-                if (!p) {
-                    return opt_req_data(std::nullopt);
-                }
-                auto& [offset, rbr] = *p;
-                auto found = _sources.find(ntp);
-                if (found == _sources.end()) {
-                    vlog(
-                      coproclog.info,
-                      "Ntp removed before batch assemble: {}",
-                      ntp);
-                    return opt_req_data(std::nullopt);
-                }
-                found->second.head.dirty = offset;
-                std::vector<script_id> ids(
-                  std::make_move_iterator(sids.begin()),
-                  std::make_move_iterator(sids.end()));
-                return opt_req_data(process_batch_request::data{
-                  .ids = std::move(ids), .ntp = ntp, .reader = std::move(rbr)});
-            });
+          auto& [offset, batches] = *p;
+          auto found = _sources.find(ntp);
+          if (found == _sources.end()) {
+              vlog(
+                coproclog.info, "Ntp removed before batch assemble: {}", ntp);
+              return opt_ntp_batches(std::nullopt);
+          }
+          std::vector<std::pair<script_id, model::offset>> scripts;
+          for (const auto& [id, committed] : ready) {
+              auto s = found->second.scripts.find(id);
+              if (s == found->second.scripts.end() || committed >= offset) {
+                  continue;
+              }
+              s->second.dirty = offset;
+              scripts.emplace_back(id, committed);
+          }
+          if (scripts.empty()) {
+              return opt_ntp_batches(std::nullopt);
+          }
+          return opt_ntp_batches(ntp_batches{
+            .ntp = ntp,
+            .scripts = std::move(scripts),
+            .batches = std::move(batches),
+            .last_offset = offset});
       });
 }
 
 ss::future<> router::send_batch(
-  supervisor_client_protocol transport, process_batch_request r) {
+  supervisor_client_protocol transport,
+  script_request r,
+  ss::lw_shared_ptr<script_state> state) {
     using reply_type = result<rpc::client_context<process_batch_reply>>;
     return transport
-      .process_batch(std::move(r), rpc::client_opts(model::no_timeout))
-      .then_wrapped([this](ss::future<reply_type> f) {
+      .process_batch(std::move(r.req), rpc::client_opts(model::no_timeout))
+      .then_wrapped([this, state, id = r.id, offsets = std::move(r.offsets)](
+                      ss::future<reply_type> f) mutable {
           try {
               auto reply = f.get0();
               if (reply) {
-                  return process_reply(std::move(reply.value().data));
+                  return ss::do_with(
+                    std::move(offsets),
+                    [this, id, reply = std::move(reply)](
+                      const source_offsets& offsets) mutable {
+                        return process_reply(
+                                 std::move(reply.value().data), id, offsets)
+                          .handle_exception(
+                            [this, id, &offsets](std::exception_ptr e) {
+                                vlog(
+                                  coproclog.error,
+                                  "Error processing copro reply: {}",
+                                  e);
+                                for (const auto& [ntp, _] : offsets) {
+                                    rewind(ntp, id);
+                                }
+                            });
+                    });
               }
               vlog(
                 coproclog.error, "Error on copro request: {}", reply.error());
           } catch (const std::exception& e) {
               vlog(coproclog.error, "Copro request future threw: {}", e.what());
           }
+          state->probe.request_failed();
+          for (const auto& [ntp, _] : offsets) {
+              rewind(ntp, id);
+          }
           return ss::now();
       });
 }
 
-ss::future<> router::process_reply(process_batch_reply r) {
-    if (r.resps.empty()) {
-        vlog(coproclog.error, "Erroneous empty response received");
-        return ss::now();
+ss::future<> router::process_reply(
+  process_batch_reply r, script_id id, const source_offsets& offsets) {
+    // a source ntp without a response would never be committed
+    absl::flat_hash_set<model::ntp> answered;
+    for (const auto& e : r.resps) {
+        answered.emplace(source_ntp(e.ntp));
+    }
+    for (const auto& [ntp, _] : offsets) {
+        if (!answered.contains(ntp)) {
+            vlog(coproclog.error, "Missing response for source ntp: {}", ntp);
+            fail_offset(ntp, id);
+        }
     }
     return ss::do_with(
       std::move(r.resps),
-      [this](std::vector<process_batch_reply::data>& resps) mutable {
-          const auto range = boost::irange<size_t>(0, resps.size());
-          return ss::do_for_each(range, [this, &resps](size_t i) {
-              return process_reply_one(std::move(resps[i]));
-          });
+      absl::flat_hash_set<model::ntp>(),
+      [this, id, &offsets](
+        std::vector<process_batch_reply::data>& resps,
+        absl::flat_hash_set<model::ntp>& dests) mutable {
+          return ss::do_for_each(
+                   resps,
+                   [this, &dests, &offsets](process_batch_reply::data& e) {
+                       return enqueue_reply(std::move(e), offsets)
+                         .then([&dests](std::optional<model::ntp> dest) {
+                             if (dest) {
+                                 dests.emplace(std::move(*dest));
+                             }
+                         });
+                   })
+            .then([this, &dests] {
+                return ss::parallel_for_each(
+                  dests, [this](const model::ntp& ntp) {
+                      return write_materialized(ntp);
+                  });
+            })
+            .then([this, id, &offsets] {
+                // every materialized write of the reply is done, including
+                // the ones of other replies it was coalesced with
+                for (const auto& [ntp, offset] : offsets) {
+                    bump_offset(ntp, id, offset);
+                }
+            });
       });
 }
 
-void router::bump_offset(const model::ntp& src_ntp, const script_id sid) {
+void router::bump_offset(
+  const model::ntp& src_ntp, const script_id sid, model::offset offset) {
     auto found = _sources.find(src_ntp);
     if (found == _sources.end()) {
         vlog(coproclog.warn, "Ntp removed before offset set: {}", src_ntp);
@@ -239,74 +527,154 @@ void router::bump_offset(const model::ntp& src_ntp, const script_id sid) {
         vlog(coproclog.warn, "Script id removed before offset set: {}", sid);
         return;
     }
-    found->second.head.committed = found->second.head.dirty;
+    auto& offsets = fsid->second;
+    if (!offsets.inflight() || offsets.dirty != offset) {
+        // rewound, the data is sent again
+        return;
+    }
+    if (offsets.failed) {
+        rewind(src_ntp, sid);
+        return;
+    }
+    offsets.committed = offset;
+    // the script is ready for the rest of the ntp
+    _pending.emplace(src_ntp);
+    maybe_dispatch_route();
+}
+
+void router::fail_offset(const model::ntp& ntp, const script_id sid) {
+    if (auto found = _sources.find(ntp); found != _sources.end()) {
+        if (auto fsid = found->second.scripts.find(sid);
+            fsid != found->second.scripts.end()) {
+            fsid->second.failed = true;
+        }
+    }
+}
+
+void router::rewind(const model::ntp& ntp, const script_id sid) {
+    auto found = _sources.find(ntp);
+    if (found == _sources.end()) {
+        return;
+    }
+    auto fsid = found->second.scripts.find(sid);
+    if (fsid == found->second.scripts.end()) {
+        return;
+    }
+    auto& offsets = fsid->second;
+    offsets.dirty = offsets.committed;
+    offsets.failed = false;
+    _pending.emplace(ntp);
+    // retried with a backoff, the engine may be unreachable
+    if (!_retry_timer.armed() && !_gate.is_closed()) {
+        _retry_timer.arm(_jitter());
+    }
 }
 
-ss::future<> router::process_reply_one(process_batch_reply::data e) {
-    // Strip the source/dest topics from the materialized topic
-    const auto mt = model::make_materialized_topic(e.ntp.tp.topic);
-    if (!mt) {
+ss::future<std::optional<model::ntp>> router::enqueue_reply(
+  process_batch_reply::data e, const source_offsets& offsets) {
+    model::ntp src_ntp = source_ntp(e.ntp);
+    if (!offsets.contains(src_ntp)) {
+        vlog(coproclog.warn, "Reply for an ntp not requested: {}", e.ntp);
+        return ss::make_ready_future<std::optional<model::ntp>>(std::nullopt);
+    }
+    if (src_ntp == e.ntp) {
         // For now this will signify a null response, which means the
         // record_batch was is to be filtered out of the materialized_topic.
-        // Mark offset, to continue to next record and do nothing else.
-        bump_offset(e.ntp, e.id);
+        // The offset is committed with the rest of the reply.
+        return ss::make_ready_future<std::optional<model::ntp>>(std::nullopt);
+    }
+    // The reply reader is backed by the batches deserialized from the rpc
+    // buffer, which share its memory. They are handed to the appender as-is.
+    return model::consume_reader_to_memory(
+             std::move(e.reader), model::no_timeout)
+      .then([this,
+             src = reply_source{.ntp = std::move(src_ntp), .id = e.id},
+             ntp = e.ntp](model::record_batch_reader::data_t batches) mutable {
+          auto& state = _materialized[ntp];
+          if (!state) {
+              state = ss::make_lw_shared<materialized_writes>();
+          }
+          std::move(
+            batches.begin(), batches.end(), std::back_inserter(state->batches));
+          state->sources.push_back(std::move(src));
+          return std::optional<model::ntp>(std::move(ntp));
+      });
+}
+
+ss::future<> router::write_materialized(const model::ntp& ntp) {
+    auto found = _materialized.find(ntp);
+    if (found == _materialized.end()) {
+        // drained by the writer of an earlier reply
         return ss::now();
     }
-    // The original ntp without the .$<destination>$ part of the topic
-    model::ntp src_ntp(e.ntp.ns, mt->src, e.ntp.tp.partition);
-    // Create the materialized log, the name of the log will be of the
-    // format: <src>.$<destination>$
-    return get_log(e.ntp).then([this,
-                                src_ntp,
-                                id = e.id,
-                                reader = std::move(e.reader)](
-                                 storage::log log) mutable {
-        // Append the requested data to the end of the log
-        storage::log_append_config cfg{
-          .should_fsync = storage::log_append_config::fsync::no,
-          .io_priority = ss::default_priority_class(),
-          .timeout = model::no_timeout};
-        return std::move(reader)
-          .for_each_ref(
-            coproc::reference_window_consumer(
-              model::record_batch_crc_checker(), log.make_appender(cfg)),
-            model::no_timeout)
-          .then(
-            [this, src_ntp, id, log](
-              std::tuple<bool, ss::future<storage::append_result>> t) mutable {
-                /// TODO(rob) NOT ideal to flush on every response.
-                /// Clubhouse ticket 'coprocessor enhancments' filed for this
-                const auto& [crc_parse_success, _] = t;
-                if (!crc_parse_success) {
-                    vlog(
-                      coproclog.warn,
-                      "record_batch failed to pass crc checks, not promoting "
-                      "log offset for source ntp: {}",
-                      src_ntp);
-                    return ss::now();
-                }
-                bump_offset(src_ntp, id);
-                return log.flush();
-            });
-    });
+    auto state = found->second;
+    ++state->writers;
+    /// Replies for the same materialized ntp that arrive while a write is in
+    /// progress accumulate in the state and are appended together by the next
+    /// lock holder, with a single flush.
+    return state->mtx
+      .with([this, ntp, state]() mutable {
+          auto batches = std::exchange(state->batches, {});
+          auto sources = std::exchange(state->sources, {});
+          if (batches.empty()) {
+              return ss::now();
+          }
+          // Create the materialized log, the name of the log will be of the
+          // format: <src>.$<destination>$
+          return get_log(ntp).then([this,
+                                    batches = std::move(batches),
+                                    sources = std::move(sources)](
+                                     storage::log log) mutable {
+              // Append the requested data to the end of the log
+              storage::log_append_config cfg{
+                .should_fsync = storage::log_append_config::fsync::no,
+                .io_priority = ss::default_priority_class(),
+                .timeout = model::no_timeout};
+              return model::make_memory_record_batch_reader(std::move(batches))
+                .for_each_ref(
+                  coproc::reference_window_consumer(
+                    model::record_batch_crc_checker(), log.make_appender(cfg)),
+                  model::no_timeout)
+                .then([this, sources = std::move(sources), log](
+                        std::tuple<bool, ss::future<storage::append_result>>
+                          t) mutable {
+                    const auto& [crc_parse_success, _] = t;
+                    if (!crc_parse_success) {
+                        vlog(
+                          coproclog.warn,
+                          "record_batch failed to pass crc checks, not "
+                          "promoting log offset for {} source ntps",
+                          sources.size());
+                        for (const auto& src : sources) {
+                            fail_offset(src.ntp, src.id);
+                        }
+                        return ss::now();
+                    }
+                    // the replies' sources are committed by process_reply
+                    return log.flush();
+                });
+          });
+      })
+      .finally([this, ntp, state] {
+          if (--state->writers == 0 && state->batches.empty()) {
+              _materialized.erase(ntp);
+          }
+      });
 }
 
-ss::future<router::opt_cfg>
-router::make_reader_cfg(storage::log log, topic_offsets& head) {
-    return head.mtx.with([this, log, committed = head.committed]() {
-        const storage::offset_stats ostats = log.offsets();
-        if (committed >= ostats.committed_offset) {
-            // Signifies materialized log is up-to-date with source, there
-            // isn't anything more to read
-            return opt_cfg(std::nullopt);
-        }
-        const model::offset start
-          = (committed == model::model_limits<model::offset>::min())
-              ? model::offset(0)
-              : committed + model::offset(1);
-        return opt_cfg(
-          reader_cfg(start, model::model_limits<model::offset>::max()));
-    });
+router::opt_cfg
+router::make_reader_cfg(const storage::log& log, model::offset committed) {
+    const storage::offset_stats ostats = log.offsets();
+    if (committed >= ostats.committed_offset) {
+        // Signifies materialized log is up-to-date with source, there
+        // isn't anything more to read
+        return std::nullopt;
+    }
+    const model::offset start
+      = (committed == model::model_limits<model::offset>::min())
+          ? model::offset(0)
+          : committed + model::offset(1);
+    return reader_cfg(start, model::model_limits<model::offset>::max());
 }
 
 ss::future<storage::log> router::get_log(const model::ntp& ntp) {
@@ -332,21 +700,39 @@ errc router::add_source(
         return errc::topic_does_not_exist;
     }
 
+    if (!_scripts.contains(id)) {
+        auto state = ss::make_lw_shared<script_state>(_max_inflight_bytes);
+        state->probe.setup_metrics(id);
+        _scripts.emplace(id, std::move(state));
+    }
     for (auto& [ntp, log] : logs) {
         auto found = _sources.find(ntp);
         if (found == _sources.end()) {
-            topic_state ts{
-              .log = log, .head = topic_offsets(), .scripts = {id}};
+            topic_state ts{.log = log, .scripts = {{id, topic_offsets()}}};
             _sources.emplace(ntp, std::move(ts));
         } else {
-            found->second.scripts.emplace(id);
+            found->second.scripts.emplace(id, topic_offsets());
         }
+        // the source may already hold data; pick it up without waiting for
+        // the next flush
+        _pending.emplace(ntp);
         vlog(coproclog.info, "Inserted ntp {} id {}", ntp, id);
     }
+    maybe_dispatch_route();
     return errc::success;
 }
 
 bool router::remove_source(const script_id sid) {
+    if (auto found = _scripts.find(sid); found != _scripts.end()) {
+        auto& state = found->second;
+        // requests in flight keep the state alive, its metrics go away now
+        // so that the script can be added again right away
+        state->probe.clear_metrics();
+        state->queue.clear();
+        state->queued_bytes = 0;
+        state->credits.broken();
+        _scripts.erase(found);
+    }
     absl::flat_hash_set<model::ntp> deleted;
     std::for_each(_sources.begin(), _sources.end(), [&deleted, sid](auto& p) {
         auto& scripts = p.second.scripts;
@@ -360,6 +746,12 @@ bool router::remove_source(const script_id sid) {
     absl::erase_if(_sources, [&deleted](const auto& p) {
         return deleted.contains(p.first);
     });
+    absl::erase_if(_pending, [&deleted](const model::ntp& ntp) {
+        return deleted.contains(ntp);
+    });
+    absl::erase_if(_held, [&deleted](const model::ntp& ntp) {
+        return deleted.contains(ntp);
+    });
 
     return !deleted.empty();
 }
@@ -11,6 +11,7 @@
 #pragma once
 #include "coproc/errc.h"
 #include "coproc/logger.h"
+#include "coproc/probe.h"
 #include "coproc/supervisor.h"
 #include "coproc/types.h"
 #include "model/fundamental.h"
@@ -27,34 +28,32 @@
 #include <seastar/core/future-util.hh>
 #include <seastar/core/future.hh>
 #include <seastar/core/gate.hh>
+#include <seastar/core/semaphore.hh>
+#include <seastar/core/shared_ptr.hh>
 #include <seastar/net/inet_address.hh>
 #include <seastar/net/socket_defs.hh>
 
 #include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
 
+#include <deque>
+
 namespace coproc {
 /// Reads data from registered input topics and routes them to the coprocessor
-/// engine connected locally. This is done by polling the registered ntps in a
-/// loop. Offsets are managed for each coprocessor/input topic so materialized
-/// topics can resume upon last processed record in the case of a failure.
+/// engine connected locally. Routing is driven by flush notifications from the
+/// storage layer: only ntps whose committed offset advanced are read and sent
+/// to the engine. Offsets are managed for each coprocessor/input topic so
+/// materialized topics can resume upon last processed record in the case of a
+/// failure.
 class router {
 public:
     router(ss::socket_address, ss::sharded<storage::api>&);
 
-    /// Begin the loop on the current shard
-    ss::future<> start() {
-        _loop_timer.set_callback([this] { (void)route(); });
-        _loop_timer.arm(_jitter());
-        return ss::now();
-    }
+    /// Begin listening for new data on the current shard
+    ss::future<> start();
 
-    /// Shut down the loop on the current shard
-    ss::future<> stop() {
-        _loop_timer.cancel();
-        _abort_source.request_abort();
-        return _gate.close().then([this] { return _transport.stop(); });
-    }
+    /// Shut down routing on the current shard
+    ss::future<> stop();
 
     errc add_source(
       const script_id, const model::topic_namespace&, topic_ingestion_policy);
@@ -65,41 +64,130 @@ public:
     }
 
 private:
-    using offset_rbr_pair
-      = std::pair<model::offset, model::record_batch_reader>;
-    using opt_req_data = std::optional<process_batch_request::data>;
+    using offset_batches_pair
+      = std::pair<model::offset, model::record_batch_reader::data_t>;
     using opt_cfg = std::optional<storage::log_reader_config>;
 
+    /// Batches read from a source ntp along with the scripts to send them
+    /// to, each with the last offset it already processed
+    struct ntp_batches {
+        model::ntp ntp;
+        std::vector<std::pair<script_id, model::offset>> scripts;
+        model::record_batch_reader::data_t batches;
+        model::offset last_offset;
+    };
+    using opt_ntp_batches = std::optional<ntp_batches>;
+
+    /// Last offset of each source ntp read into a request
+    using source_offsets = absl::flat_hash_map<model::ntp, model::offset>;
+
+    struct script_request {
+        script_id id;
+        size_t bytes{0};
+        process_batch_request req;
+        source_offsets offsets;
+    };
+
+    /// Flow control and statistics of a single script. Every script owns a
+    /// queue of requests, sent as its window of credits, in bytes, allows.
+    /// A slow script only holds up its own queue.
+    struct script_state {
+        explicit script_state(size_t max_inflight_bytes)
+          : credits(max_inflight_bytes) {}
+        ss::semaphore credits;
+        std::deque<script_request> queue;
+        size_t queued_bytes{0};
+        bool draining{false};
+        script_probe probe;
+    };
+
+    /// Offsets of a source ntp for one script: dirty is the last offset
+    /// sent to the script, committed the last one whose reply was applied. A
+    /// script has at most one request in flight per ntp, so replies are
+    /// applied in order and dirty is ahead of committed only while it is
+    /// outstanding.
     struct topic_offsets {
         model::offset committed{model::model_limits<model::offset>::min()};
         model::offset dirty{model::model_limits<model::offset>::min()};
+        /// Part of the reply in flight could not be applied, the request is
+        /// rewound rather than committed once the whole reply is processed
+        bool failed{false};
+
+        bool inflight() const { return dirty != committed; }
+    };
+
+    struct reply_source {
+        model::ntp ntp;
+        script_id id;
+    };
+
+    /// Pending writes to a materialized ntp. Batches from every reply
+    /// targeting the ntp are appended under the lock in one go. The entry is
+    /// dropped once it is drained and no writer is waiting on the lock.
+    struct materialized_writes {
+        model::record_batch_reader::data_t batches;
+        std::vector<reply_source> sources;
+        size_t writers{0};
         mutex mtx;
     };
 
     struct topic_state {
         /// For now the only possible topic_ingestion_policy is latest
         storage::log log;
-        topic_offsets head;
-        absl::flat_hash_set<script_id> scripts;
+        /// Scripts tracking the ntp and how far each of them got
+        absl::flat_hash_map<script_id, topic_offsets> scripts;
     };
 
     ss::future<result<supervisor_client_protocol>> get_client();
     ss::future<storage::log> get_log(const model::ntp& ntp);
 
-    ss::future<> process_reply(process_batch_reply);
-    ss::future<> process_reply_one(process_batch_reply::data);
+    ss::future<>
+    process_reply(process_batch_reply, script_id, const source_offsets&);
+    /// Queue the batches of one reply on its materialized ntp, returns the
+    /// materialized ntp if there is data to write
+    ss::future<std::optional<model::ntp>>
+    enqueue_reply(process_batch_reply::data, const source_offsets&);
+    ss::future<> write_materialized(const model::ntp&);
+
+    /// Invoked by the log manager when the committed offset of an ntp on
+    /// this shard advances
+    void notify_flushed(const model::ntp&);
+    /// Start a routing pass in the background unless one is already running
+    void maybe_dispatch_route();
+    /// Re-queue ntps that still have unread data after a routing pass
+    void requeue_lagging(const std::vector<model::ntp>&, bool progress);
 
     ss::future<> route();
     ss::future<> do_route();
-    ss::future<opt_req_data> route_ntp(const model::ntp&, topic_state&);
-    ss::future<> process_batch(std::vector<process_batch_request::data>);
-    ss::future<> send_batch(supervisor_client_protocol, process_batch_request);
-
-    ss::future<std::optional<offset_rbr_pair>>
+    ss::future<opt_ntp_batches> route_ntp(const model::ntp&, topic_state&);
+    /// True when a script tracking the ntp has a full window of requests
+    /// queued. Such ntps are held back until the script drains its queue
+    bool backlogged(const topic_state&) const;
+    void enqueue_batch(std::vector<ntp_batches>);
+    absl::flat_hash_map<script_id, std::vector<script_request>>
+      partition_by_script(std::vector<ntp_batches>);
+    /// Send the queued requests of a script in the background
+    void maybe_drain(ss::lw_shared_ptr<script_state>);
+    ss::future<> send_next(ss::lw_shared_ptr<script_state>);
+    ss::future<>
+      send_script_request(ss::lw_shared_ptr<script_state>, script_request);
+    ss::future<> send_batch(
+      supervisor_client_protocol,
+      script_request,
+      ss::lw_shared_ptr<script_state>);
+
+    ss::future<std::optional<offset_batches_pair>>
       extract_offset(model::record_batch_reader);
-    void bump_offset(const model::ntp&, const script_id);
-
-    ss::future<opt_cfg> make_reader_cfg(storage::log, topic_offsets&);
+    /// Commit the request of a script in flight for a source ntp, if it is
+    /// still the one ending at \p offset, or rewind it if it failed
+    void bump_offset(const model::ntp&, const script_id, model::offset);
+    /// Mark the request of a script in flight for a source ntp as failed
+    void fail_offset(const model::ntp&, const script_id);
+    /// Send the data of a source ntp to a script again from its committed
+    /// offset, e.g. after the request carrying it failed
+    void rewind(const model::ntp&, const script_id);
+
+    opt_cfg make_reader_cfg(const storage::log&, model::offset committed);
     storage::log_reader_config reader_cfg(model::offset, model::offset);
 
 private:
@@ -107,17 +195,37 @@ private:
     /// desired ntp to be tracked
     ss::sharded<storage::api>& _api;
 
-    /// Primitives used to manage the poll loop and close gracefully
+    /// Credit window of each script, see script_state
+    const size_t _max_inflight_bytes;
+    absl::flat_hash_map<script_id, ss::lw_shared_ptr<script_state>> _scripts;
+
+    /// Primitives used to manage routing and close gracefully
     ss::gate _gate;
     ss::abort_source _abort_source;
     uint8_t _connection_attempts{0};
+    std::optional<storage::log_manager::flush_notification_id>
+      _flush_notification;
+    bool _routing{false};
+
+    /// Backoff for retrying ntps that could not make progress, e.g. when the
+    /// engine is unreachable
     simple_time_jitter<ss::lowres_clock> _jitter;
-    ss::timer<ss::lowres_clock> _loop_timer;
+    ss::timer<ss::lowres_clock> _retry_timer;
 
     /// Core in-memory data structure that manages the relationships between
     /// topics and coprocessor scripts
     absl::flat_hash_map<model::ntp, topic_state> _sources;
 
+    /// Materialized ntps written by this shard
+    absl::flat_hash_map<model::ntp, ss::lw_shared_ptr<materialized_writes>>
+      _materialized;
+
+    /// Tracked ntps with new data that has not been routed yet
+    absl::flat_hash_set<model::ntp> _pending;
+
+    /// Ntps with new data held back by a backlogged script
+    absl::flat_hash_set<model::ntp> _held;
+
     /// Connection to the coprocessor engine
     rpc::reconnect_transport _transport;
 };
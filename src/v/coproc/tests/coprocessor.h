@@ -17,6 +17,8 @@
 #include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
 
+#include <chrono>
+#include <utility>
 #include <vector>
 
 struct coprocessor {
@@ -44,6 +46,16 @@ struct coprocessor {
     apply(const model::topic&, const std::vector<model::record_batch>&)
       = 0;
 
+    /// \brief Time the harness waits before replying with the result of apply,
+    /// override to simulate a slow script
+    virtual std::chrono::milliseconds delay() const {
+        return std::chrono::milliseconds(0);
+    }
+
+    /// \brief Whether the harness fails the request instead of replying,
+    /// override to simulate engine errors
+    virtual bool fail_request() { return false; }
+
     /// \brief Input topics are static, they can only be set at copro init phase
     const input_set& get_input_topics() const { return _input_topics; }
 
@@ -109,3 +121,51 @@ struct identity_coprocessor : public coprocessor {
     static const inline model::topic identity_topic = model::topic(
       "identity_topic");
 };
+
+/// Identity transform that takes 5s to reply to every request
+struct slow_coprocessor : public identity_coprocessor {
+    slow_coprocessor(coproc::script_id sid, input_set input)
+      : identity_coprocessor(sid, std::move(input)) {}
+
+    std::chrono::milliseconds delay() const override {
+        return std::chrono::seconds(5);
+    }
+};
+
+/// Copies its input to its own materialized topic, failing the first request
+/// only after a delay, so that other scripts reading the same input reply
+/// first
+struct flaky_coprocessor : public coprocessor {
+    flaky_coprocessor(coproc::script_id sid, input_set input)
+      : coprocessor(sid, std::move(input)) {}
+
+    coprocessor::result apply(
+      const model::topic&,
+      const std::vector<model::record_batch>& batches) override {
+        coprocessor::result r;
+        std::vector<model::record_batch> copies;
+        std::transform(
+          batches.cbegin(),
+          batches.cend(),
+          std::back_inserter(copies),
+          [](const model::record_batch& rb) { return rb.copy(); });
+        r.emplace(flaky_topic, std::move(copies));
+        return r;
+    }
+
+    std::chrono::milliseconds delay() const override {
+        return _failed ? std::chrono::milliseconds(0)
+                       : std::chrono::milliseconds(500);
+    }
+
+    bool fail_request() override { return !std::exchange(_failed, true); }
+
+    static absl::flat_hash_set<model::topic> output_topics() {
+        return {flaky_topic};
+    };
+
+    static const inline model::topic flaky_topic = model::topic("flaky_topic");
+
+private:
+    bool _failed{false};
+};
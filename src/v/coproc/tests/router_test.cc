@@ -157,3 +157,90 @@ FIXTURE_TEST(test_coproc_router_multi_route, router_test_fixture) {
       all_drained.cbegin(), all_drained.cend());
     BOOST_CHECK_EQUAL(known_totals, observed_totals);
 }
+
+FIXTURE_TEST(test_coproc_router_slow_script, router_test_fixture) {
+    auto client = make_client();
+    client.connect().get();
+    // The script reading 'bar' takes 5s to reply, the one reading 'foo'
+    // replies right away
+    add_copro<slow_coprocessor>(321, {{"bar", l}}).get();
+    add_copro<identity_coprocessor>(1234, {{"foo", l}}).get();
+    startup({{make_ts("foo"), 1}, {make_ts("bar"), 1}}, client)
+      .then([&client] { return client.stop(); })
+      .get();
+
+    model::ntp slow_ntp(
+      default_ns, model::topic("bar"), model::partition_id(0));
+    push(
+      slow_ntp,
+      model::make_memory_record_batch_reader(
+        storage::test::make_random_batches(model::offset(0), 4, false)))
+      .get();
+
+    // The slow request is in flight, routing of 'foo' must not wait for it
+    model::topic src_topic("foo");
+    model::ntp input_ntp(default_ns, src_topic, model::partition_id(0));
+    model::ntp output_ntp(
+      default_ns,
+      model::to_materialized_topic(
+        src_topic, identity_coprocessor::identity_topic),
+      model::partition_id(0));
+    auto batches = storage::test::make_random_batches(
+      model::offset(0), 4, false);
+    const auto n_records = sum_records(batches);
+
+    using namespace std::literals;
+    auto f1 = push(
+      input_ntp, model::make_memory_record_batch_reader(std::move(batches)));
+    auto f2 = drain(output_ntp, n_records, model::timeout_clock::now() + 2s);
+    auto read_batches
+      = ss::when_all_succeed(std::move(f1), std::move(f2)).get();
+
+    BOOST_REQUIRE(std::get<1>(read_batches).has_value());
+    const model::record_batch_reader::data_t& data = *std::get<1>(read_batches);
+    BOOST_CHECK_EQUAL(sum_records(data), n_records);
+}
+
+FIXTURE_TEST(test_coproc_router_failed_request_replays, router_test_fixture) {
+    auto client = make_client();
+    client.connect().get();
+    // Both scripts read 'foo'. The identity script replies right away, the
+    // flaky one fails its first request after the identity reply was applied
+    add_copro<identity_coprocessor>(1234, {{"foo", l}}).get();
+    add_copro<flaky_coprocessor>(4321, {{"foo", l}}).get();
+    startup({{make_ts("foo"), 1}}, client)
+      .then([&client] { return client.stop(); })
+      .get();
+
+    model::topic src_topic("foo");
+    model::ntp input_ntp(default_ns, src_topic, model::partition_id(0));
+    model::ntp identity_ntp(
+      default_ns,
+      model::to_materialized_topic(
+        src_topic, identity_coprocessor::identity_topic),
+      model::partition_id(0));
+    model::ntp flaky_ntp(
+      default_ns,
+      model::to_materialized_topic(src_topic, flaky_coprocessor::flaky_topic),
+      model::partition_id(0));
+    auto batches = storage::test::make_random_batches(
+      model::offset(0), 4, false);
+    const auto n_records = sum_records(batches);
+    push(input_ntp, model::make_memory_record_batch_reader(std::move(batches)))
+      .get();
+
+    // The failed request is sent again from the offset the flaky script
+    // committed, not from the one the identity script did
+    using namespace std::literals;
+    auto timeout = model::timeout_clock::now() + 10s;
+    auto drained = ss::when_all_succeed(
+                     drain(identity_ntp, n_records, timeout),
+                     drain(flaky_ntp, n_records, timeout))
+                     .get();
+    const auto& identity = std::get<0>(drained);
+    const auto& flaky = std::get<1>(drained);
+    BOOST_REQUIRE(identity.has_value());
+    BOOST_REQUIRE(flaky.has_value());
+    BOOST_CHECK_EQUAL(sum_records(*identity), n_records);
+    BOOST_CHECK_EQUAL(sum_records(*flaky), n_records);
+}
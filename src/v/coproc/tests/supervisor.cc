@@ -13,6 +13,9 @@
 #include "model/fundamental.h"
 #include "storage/record_batch_builder.h"
 
+#include <seastar/core/sleep.hh>
+
+#include <stdexcept>
 #include <type_traits>
 
 namespace coproc {
@@ -82,6 +85,20 @@ void supervisor::invoke_coprocessor(
     }
 }
 
+bool supervisor::fail_request(const script_id sid) {
+    auto found = _coprocessors.local().find(sid);
+    return found != _coprocessors.local().end()
+           && found->second->fail_request();
+}
+
+std::chrono::milliseconds supervisor::delay(const script_id sid) const {
+    auto found = _coprocessors.local().find(sid);
+    if (found == _coprocessors.local().end()) {
+        return std::chrono::milliseconds(0);
+    }
+    return found->second->delay();
+}
+
 ss::future<std::vector<process_batch_reply::data>>
 supervisor::invoke_coprocessors(process_batch_request::data d) {
     return model::consume_reader_to_memory(
@@ -103,7 +120,15 @@ supervisor::invoke_coprocessors(process_batch_request::data d) {
                 return ss::do_for_each(
                          sids,
                          [this, &ntp, &vdata, &results](const auto& sid) {
-                             invoke_coprocessor(ntp, sid, vdata, results);
+                             return ss::sleep(delay(sid)).then(
+                               [this, &ntp, &vdata, &results, sid] {
+                                   if (fail_request(sid)) {
+                                       throw std::runtime_error(fmt::format(
+                                         "Script id: {} failed", sid));
+                                   }
+                                   invoke_coprocessor(
+                                     ntp, sid, vdata, results);
+                               });
                          })
                   .then([&results]() { return std::move(results); });
             });
@@ -50,6 +50,9 @@ private:
     ss::future<std::vector<process_batch_reply::data>>
       invoke_coprocessors(process_batch_request::data);
 
+    std::chrono::milliseconds delay(const script_id) const;
+    bool fail_request(const script_id);
+
     /// Map of coprocessors organized by their global identifiers
     ss::sharded<copro_map>& _coprocessors;
 
@@ -91,6 +91,12 @@ public:
                    r.encode(wr, request_version);
                })
           .then([response_version](iobuf buf) {
+              if (flexible_header(T::api_type::key, response_version)) {
+                  // skip the tagged fields of the response header
+                  request_reader rd(buf.share(0, buf.size_bytes()));
+                  rd.skip_tags();
+                  buf.trim_front(rd.bytes_consumed());
+              }
               using response_type = typename T::api_type::response_type;
               response_type r;
               r.decode(std::move(buf), response_version);
@@ -117,6 +123,9 @@ private:
         wr.write(int16_t(version()));
         wr.write(int32_t(_correlation()));
         wr.write(std::string_view("test_client"));
+        if (flexible_header(key, version)) {
+            wr.write_tags();
+        }
         _correlation = _correlation + correlation_id(1);
     }
 
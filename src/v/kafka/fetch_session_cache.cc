@@ -0,0 +1,259 @@
+// Copyright 2020 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "kafka/fetch_session_cache.h"
+
+#include "config/configuration.h"
+#include "kafka/logger.h"
+#include "kafka/requests/fetch_request.h"
+#include "prometheus/prometheus_sanitize.h"
+#include "random/generators.h"
+#include "vlog.h"
+
+#include <seastar/core/metrics.hh>
+
+#include <algorithm>
+
+namespace kafka {
+
+void fetch_session::apply(fetch_request& request) {
+    for (auto& t : request.topics) {
+        for (auto& p : t.partitions) {
+            auto& sp = _partitions[model::topic_partition(t.name, p.id)];
+            sp.fetch_offset = p.fetch_offset;
+            sp.max_bytes = p.partition_max_bytes;
+        }
+    }
+    for (auto& t : request.forgotten_topics) {
+        for (auto p : t.partitions) {
+            _partitions.erase(
+              model::topic_partition(t.name, model::partition_id(p)));
+        }
+    }
+
+    request.topics.clear();
+    for (auto& [tp, sp] : _partitions) {
+        if (request.topics.empty() || request.topics.back().name != tp.topic) {
+            request.topics.push_back(fetch_request::topic{.name = tp.topic});
+        }
+        request.topics.back().partitions.push_back(fetch_request::partition{
+          .id = tp.partition,
+          .fetch_offset = sp.fetch_offset,
+          .partition_max_bytes = sp.max_bytes,
+        });
+    }
+}
+
+size_t fetch_session::update(fetch_response& response, bool incremental) {
+    size_t omitted = 0;
+    for (auto& t : response.partitions) {
+        auto it = std::remove_if(
+          t.responses.begin(),
+          t.responses.end(),
+          [this, &t, incremental, &omitted](
+            const fetch_response::partition_response& r) {
+              auto sp = _partitions.find(model::topic_partition(t.name, r.id));
+              if (sp == _partitions.end()) {
+                  return false;
+              }
+              const bool changed
+                = r.has_error() || (r.record_set && !r.record_set->empty())
+                  || r.high_watermark != sp->second.high_watermark
+                  || r.last_stable_offset != sp->second.last_stable_offset;
+              sp->second.high_watermark = r.high_watermark;
+              sp->second.last_stable_offset = r.last_stable_offset;
+              if (incremental && !changed) {
+                  ++omitted;
+                  return true;
+              }
+              return false;
+          });
+        t.responses.erase(it, t.responses.end());
+    }
+    if (omitted) {
+        response.partitions.erase(
+          std::remove_if(
+            response.partitions.begin(),
+            response.partitions.end(),
+            [](const fetch_response::partition& t) {
+                return t.responses.empty();
+            }),
+          response.partitions.end());
+    }
+    return omitted;
+}
+
+fetch_session_cache::fetch_session_cache(size_t max_sessions)
+  : _max_sessions(max_sessions) {
+    setup_metrics();
+}
+
+fetch_session_cache::fetch_session_cache()
+  : fetch_session_cache(
+    config::shard_local_cfg().fetch_session_cache_max_sessions()) {}
+
+fetch_session_cache::~fetch_session_cache() noexcept {
+    _lru.clear();
+    _sessions.clear();
+}
+
+ss::future<> fetch_session_cache::stop() {
+    _metrics.clear();
+    _lru.clear();
+    _sessions.clear();
+    return ss::now();
+}
+
+fetch_session_ctx fetch_session_cache::maybe_get_session(fetch_request& r) {
+    const auto id = fetch_session_id(r.session_id);
+    const auto epoch = fetch_session_epoch(r.session_epoch);
+
+    if (epoch == final_fetch_session_epoch) {
+        // closes the session, if any, with a full sessionless fetch
+        if (id != invalid_fetch_session_id) {
+            remove_session(id);
+        }
+        ++_full_fetches;
+        return fetch_session_ctx{};
+    }
+
+    if (epoch == initial_fetch_session_epoch) {
+        // a full fetch that replaces the client's previous session
+        if (id != invalid_fetch_session_id) {
+            remove_session(id);
+        }
+        ++_full_fetches;
+        auto session = create_session();
+        if (!session) {
+            // sessions are disabled, fall back to a sessionless fetch
+            return fetch_session_ctx{};
+        }
+        session->apply(r);
+        session->bump_epoch();
+        return fetch_session_ctx{.session = std::move(session)};
+    }
+
+    if (id == invalid_fetch_session_id) {
+        ++_session_errors;
+        return fetch_session_ctx{
+          .error = error_code::invalid_fetch_session_epoch};
+    }
+    auto it = _sessions.find(id);
+    if (it == _sessions.end()) {
+        ++_session_errors;
+        return fetch_session_ctx{.error = error_code::fetch_session_id_not_found};
+    }
+    auto session = it->second;
+    if (session->epoch() != epoch) {
+        vlog(
+          klog.debug,
+          "fetch session {} expected epoch {}, got {}",
+          id,
+          session->epoch(),
+          epoch);
+        ++_session_errors;
+        return fetch_session_ctx{
+          .error = error_code::invalid_fetch_session_epoch};
+    }
+
+    ++_incremental_fetches;
+    // most recently used goes to the back
+    session->_hook.unlink();
+    _lru.push_back(*session);
+    session->apply(r);
+    session->bump_epoch();
+    return fetch_session_ctx{.session = std::move(session), .incremental = true};
+}
+
+void fetch_session_cache::update_session(
+  const fetch_session_ctx& ctx, fetch_response& response) {
+    if (!ctx.session) {
+        return;
+    }
+    _omitted_partitions += ctx.session->update(response, ctx.incremental);
+}
+
+fetch_session_ptr fetch_session_cache::create_session() {
+    if (_max_sessions == 0) {
+        return nullptr;
+    }
+    while (_sessions.size() >= _max_sessions) {
+        evict_lru();
+    }
+    auto session = ss::make_lw_shared<fetch_session>(new_session_id());
+    _sessions.emplace(session->id(), session);
+    _lru.push_back(*session);
+    return session;
+}
+
+void fetch_session_cache::remove_session(fetch_session_id id) {
+    if (auto it = _sessions.find(id); it != _sessions.end()) {
+        it->second->_hook.unlink();
+        _sessions.erase(it);
+    }
+}
+
+void fetch_session_cache::evict_lru() {
+    auto& session = _lru.front();
+    vlog(klog.trace, "evicting fetch session {}", session.id());
+    _lru.pop_front();
+    // the session stays alive while an in-flight request still holds it
+    _sessions.erase(session.id());
+    ++_evictions;
+}
+
+fetch_session_id fetch_session_cache::new_session_id() const {
+    while (true) {
+        auto id = fetch_session_id(random_generators::get_int<int32_t>(
+          1, std::numeric_limits<int32_t>::max()));
+        if (!_sessions.contains(id)) {
+            return id;
+        }
+    }
+}
+
+void fetch_session_cache::setup_metrics() {
+    if (config::shard_local_cfg().disable_metrics()) {
+        return;
+    }
+    namespace sm = ss::metrics;
+    _metrics.add_group(
+      prometheus_sanitize::metrics_name("kafka:fetch_sessions"),
+      {
+        sm::make_gauge(
+          "sessions",
+          [this] { return _sessions.size(); },
+          sm::description("Number of cached fetch sessions")),
+        sm::make_derive(
+          "evictions",
+          [this] { return _evictions; },
+          sm::description("Number of fetch sessions evicted to make room for "
+                          "new ones")),
+        sm::make_derive(
+          "full_fetches",
+          [this] { return _full_fetches; },
+          sm::description("Number of full fetch requests")),
+        sm::make_derive(
+          "incremental_fetches",
+          [this] { return _incremental_fetches; },
+          sm::description("Number of incremental fetch requests")),
+        sm::make_derive(
+          "session_errors",
+          [this] { return _session_errors; },
+          sm::description("Number of fetch requests rejected for an unknown "
+                          "session or an unexpected session epoch")),
+        sm::make_derive(
+          "omitted_partitions",
+          [this] { return _omitted_partitions; },
+          sm::description("Number of unchanged partitions left out of "
+                          "incremental fetch responses")),
+      });
+}
+
+} // namespace kafka
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2020 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+#include "kafka/errors.h"
+#include "kafka/types.h"
+#include "model/fundamental.h"
+#include "seastarx.h"
+#include "utils/intrusive_list_helpers.h"
+
+#include <seastar/core/future.hh>
+#include <seastar/core/metrics_registration.hh>
+#include <seastar/core/shared_ptr.hh>
+
+#include <absl/container/btree_map.h>
+#include <absl/container/flat_hash_map.h>
+
+#include <limits>
+
+namespace kafka {
+
+struct fetch_request;
+struct fetch_response;
+
+/**
+ * An incremental fetch session (KIP-227).
+ *
+ * The session remembers the partitions a client is fetching and their fetch
+ * positions, so that incremental fetch requests only carry partitions whose
+ * position changed, and incremental responses leave out partitions that have
+ * nothing new to report since the previous response.
+ *
+ * Partitions are kept grouped by topic so that the full set can be turned
+ * back into the topics of a fetch request without regrouping.
+ */
+class fetch_session {
+public:
+    struct partition {
+        int32_t max_bytes{0};
+        model::offset fetch_offset;
+        // last values sent to the client
+        model::offset high_watermark{-1};
+        model::offset last_stable_offset{-1};
+    };
+
+    using partitions_t = absl::btree_map<model::topic_partition, partition>;
+
+    explicit fetch_session(fetch_session_id id) noexcept
+      : _id(id) {}
+    fetch_session(fetch_session&&) = delete;
+    fetch_session& operator=(fetch_session&&) = delete;
+    fetch_session(const fetch_session&) = delete;
+    fetch_session& operator=(const fetch_session&) = delete;
+    ~fetch_session() noexcept = default;
+
+    fetch_session_id id() const { return _id; }
+    /// the epoch expected from the next request of the session
+    fetch_session_epoch epoch() const { return _epoch; }
+    const partitions_t& partitions() const { return _partitions; }
+
+    /// adds or updates the partitions of the request and drops its forgotten
+    /// topics. the request topics are then replaced by all of the session
+    /// partitions.
+    void apply(fetch_request&);
+
+    /**
+     * Records what the response reports for each partition. For incremental
+     * fetches partitions without records, errors or changed offsets are
+     * removed from the response. Returns the number of partitions removed.
+     */
+    size_t update(fetch_response&, bool incremental);
+
+private:
+    friend class fetch_session_cache;
+
+    void bump_epoch() {
+        // epochs wrap around to 1, zero is reserved for new sessions
+        _epoch = _epoch() == std::numeric_limits<int32_t>::max()
+                   ? fetch_session_epoch(1)
+                   : _epoch + fetch_session_epoch(1);
+    }
+
+    fetch_session_id _id;
+    fetch_session_epoch _epoch{initial_fetch_session_epoch};
+    partitions_t _partitions;
+    intrusive_list_hook _hook;
+};
+
+using fetch_session_ptr = ss::lw_shared_ptr<fetch_session>;
+
+/**
+ * Session of a single fetch request. A request without a session is a full
+ * sessionless fetch, as is the request that creates a new session.
+ */
+struct fetch_session_ctx {
+    fetch_session_ptr session;
+    bool incremental{false};
+    error_code error{error_code::none};
+
+    bool has_error() const { return error != error_code::none; }
+};
+
+/**
+ * Per-shard cache of fetch sessions. Connections are pinned to a shard, so
+ * a session is only found by the connection's shard; a client reconnecting
+ * elsewhere gets fetch_session_id_not_found and starts a new session.
+ *
+ * The cache holds at most `max_sessions` sessions. When it is full the least
+ * recently used session is evicted to make room for a new one.
+ */
+class fetch_session_cache {
+public:
+    explicit fetch_session_cache(size_t max_sessions);
+    fetch_session_cache();
+    fetch_session_cache(fetch_session_cache&&) = delete;
+    fetch_session_cache& operator=(fetch_session_cache&&) = delete;
+    fetch_session_cache(const fetch_session_cache&) = delete;
+    fetch_session_cache& operator=(const fetch_session_cache&) = delete;
+    ~fetch_session_cache() noexcept;
+
+    ss::future<> stop();
+
+    /**
+     * Resolves the session of a request, creating, closing or advancing it
+     * as requested by its session id and epoch. For requests of a session
+     * the request topics are replaced by the session partitions.
+     */
+    fetch_session_ctx maybe_get_session(fetch_request&);
+
+    /// records the response of a session request, see fetch_session::update
+    void update_session(const fetch_session_ctx&, fetch_response&);
+
+    size_t size() const { return _sessions.size(); }
+    uint64_t evictions() const { return _evictions; }
+
+private:
+    fetch_session_ptr create_session();
+    void remove_session(fetch_session_id);
+    void evict_lru();
+    fetch_session_id new_session_id() const;
+    void setup_metrics();
+
+    const size_t _max_sessions;
+    absl::flat_hash_map<fetch_session_id, fetch_session_ptr> _sessions;
+    intrusive_list<fetch_session, &fetch_session::_hook> _lru;
+
+    uint64_t _evictions{0};
+    uint64_t _full_fetches{0};
+    uint64_t _incremental_fetches{0};
+    uint64_t _session_errors{0};
+    uint64_t _omitted_partitions{0};
+    ss::metrics::metric_groups _metrics;
+};
+
+} // namespace kafka
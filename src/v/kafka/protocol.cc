@@ -10,10 +10,14 @@
 #include "protocol.h"
 
 #include "cluster/topics_frontend.h"
+#include "config/configuration.h"
 #include "kafka/logger.h"
 #include "kafka/protocol_utils.h"
+#include "kafka/requests/fetch_request.h"
+#include "kafka/requests/produce_request.h"
 #include "kafka/requests/request_context.h"
 #include "kafka/requests/response.h"
+#include "prometheus/prometheus_sanitize.h"
 #include "utils/utf8.h"
 #include "vlog.h"
 
@@ -26,6 +30,7 @@
 
 #include <fmt/format.h>
 
+#include <algorithm>
 #include <exception>
 #include <limits>
 
@@ -41,15 +46,92 @@ protocol::protocol(
   ss::sharded<kafka::group_router_type>& router,
   ss::sharded<cluster::shard_table>& tbl,
   ss::sharded<cluster::partition_manager>& pm,
-  ss::sharded<coordinator_ntp_mapper>& coordinator_mapper) noexcept
+  ss::sharded<coordinator_ntp_mapper>& coordinator_mapper,
+  ss::sharded<fetch_session_cache>& session_cache) noexcept
   : _smp_group(smp)
+  , _max_inflight_per_connection(std::max<size_t>(
+      1, config::shard_local_cfg().kafka_max_inflight_requests_per_connection()))
+  , _produce_streaming_threshold(
+      config::shard_local_cfg().kafka_produce_streaming_threshold())
   , _topics_frontend(tf)
   , _metadata_cache(meta)
   , _quota_mgr(quota)
   , _group_router(router)
   , _shard_table(tbl)
   , _partition_manager(pm)
-  , _coordinator_mapper(coordinator_mapper) {}
+  , _coordinator_mapper(coordinator_mapper)
+  , _fetch_session_cache(session_cache) {
+    setup_metrics();
+}
+
+void protocol::setup_metrics() {
+    if (config::shard_local_cfg().disable_metrics()) {
+        return;
+    }
+    namespace sm = ss::metrics;
+    _metrics.add_group(
+      prometheus_sanitize::metrics_name("kafka:connections"),
+      {
+        sm::make_gauge(
+          "inflight_requests",
+          [this] { return _inflight_requests; },
+          sm::description("Number of requests being processed or waiting for "
+                          "their response to be sent")),
+        sm::make_gauge(
+          "queued_responses",
+          [this] { return _queued_responses; },
+          sm::description("Number of completed responses waiting for an "
+                          "earlier response of their connection")),
+        sm::make_derive(
+          "inflight_limit_waits",
+          [this] { return _inflight_limit_waits; },
+          sm::description("Number of times reading a request waited for the "
+                          "connection in-flight request limit")),
+        sm::make_derive(
+          "response_writes",
+          [this] { return _response_writes; },
+          sm::description("Number of writes of responses to connections")),
+        sm::make_derive(
+          "coalesced_responses",
+          [this] { return _coalesced_responses; },
+          sm::description("Number of responses written together with an "
+                          "earlier response of their connection")),
+        sm::make_gauge(
+          "fetch_memory_used",
+          [this] {
+              return _fetch_memory_size - _fetch_memory.available_units();
+          },
+          sm::description("Memory reserved by fetch requests and their "
+                          "responses")),
+        sm::make_gauge(
+          "control_memory_used",
+          [this] {
+              return _control_memory_size - _control_memory.available_units();
+          },
+          sm::description("Memory reserved by requests other than produce "
+                          "and fetch")),
+        sm::make_derive(
+          "local_partition_requests",
+          [this] { return _shard_locality.local(); },
+          sm::description("Number of partitions requested from the shard "
+                          "owning them")),
+        sm::make_derive(
+          "remote_partition_requests",
+          [this] { return _shard_locality.remote(); },
+          sm::description("Number of partitions requested from another shard "
+                          "than the one owning them")),
+        sm::make_gauge(
+          "shard_hop_ratio",
+          [this] { return _shard_locality.hop_ratio(); },
+          sm::description("Fraction of requested partitions owned by another "
+                          "shard")),
+        sm::make_derive(
+          "misplaced_connections",
+          [this] { return _misplaced_connections; },
+          sm::description("Number of closed connections that mostly requested "
+                          "partitions of a single other shard")),
+      });
+}
 
 ss::future<> protocol::apply(rpc::server::resources rs) {
     auto ctx = ss::make_lw_shared<protocol::connection_context>(
@@ -60,6 +142,31 @@ ss::future<> protocol::apply(rpc::server::resources rs) {
       .finally([ctx] {});
 }
 
+protocol::connection_context::~connection_context() noexcept {
+    // requests whose responses were never sent
+    _proto._inflight_requests -= _proto._max_inflight_per_connection
+                                 - _inflight.available_units();
+    _proto._queued_responses -= _responses.size();
+
+    const auto& l = *_shard_locality;
+    if (l.local() + l.remote() == 0) {
+        return;
+    }
+    const auto preferred = l.preferred_shard();
+    if (l.mostly_owned_by_other_shard()) {
+        ++_proto._misplaced_connections;
+    }
+    vlog(
+      klog.debug,
+      "connection {} requested {} local and {} remote partitions (hop ratio "
+      "{:.2f}), most were owned by shard {}",
+      _rs.conn->addr,
+      l.local(),
+      l.remote(),
+      l.hop_ratio(),
+      preferred);
+}
+
 ss::future<> protocol::connection_context::process_one_request() {
     return parse_size(_rs.conn->input())
       .then([this](std::optional<size_t> sz) mutable {
@@ -79,7 +186,16 @@ ss::future<> protocol::connection_context::process_one_request() {
                       _rs.probe().header_corrupted();
                       return ss::make_ready_future<>();
                   }
-                  return dispatch_method_once(std::move(h.value()), s);
+                  // the unit is given back once the response is handed to
+                  // the connection
+                  return reserve_inflight()
+                    .then([this, h = std::move(h.value()), s]() mutable {
+                        return dispatch_method_once(std::move(h), s);
+                    })
+                    .handle_exception_type([](const ss::broken_semaphore&) {
+                        // a request failed or the server is stopping, the
+                        // input is shut down and the next read ends parsing
+                    });
               });
       });
 }
@@ -89,7 +205,7 @@ bool protocol::connection_context::is_finished_parsing() const {
 }
 
 ss::future<session_resources> protocol::connection_context::throttle_request(
-  std::optional<std::string_view> client_id, size_t request_size) {
+  const request_header& hdr, size_t request_size) {
     // update the throughput tracker for this client using the
     // size of the current request and return any computed delay
     // to apply for quota throttling.
@@ -101,16 +217,25 @@ ss::future<session_resources> protocol::connection_context::throttle_request(
     // distinguish throttling delays from real delays. delays
     // applied to subsequent messages allow backpressure to take
     // affect.
-    auto delay = _proto._quota_mgr.local().record_tp_and_throttle(
-      client_id, request_size);
+    //
+    // fetch requests are charged by the size of their responses (see
+    // do_process) so here we only compute the delay from what has already
+    // been sent to the client. produce and all other requests are charged by
+    // request size against the produce quota.
+    auto& qm = _proto._quota_mgr.local();
+    auto delay = hdr.key == fetch_api::key
+                   ? qm.throttle_fetch_tp(hdr.client_id)
+                   : qm.record_produce_tp_and_throttle(
+                     hdr.client_id, request_size);
 
     auto fut = ss::now();
     if (!delay.first_violation) {
         fut = ss::sleep_abortable(delay.duration, _rs.abort_source());
     }
     return fut
-      .then(
-        [this, request_size] { return reserve_request_units(request_size); })
+      .then([this, key = hdr.key, request_size] {
+          return reserve_request_units(key, request_size);
+      })
       .then([this, delay](ss::semaphore_units<> units) {
           return session_resources{
             .backpressure_delay = delay.duration,
@@ -121,7 +246,13 @@ ss::future<session_resources> protocol::connection_context::throttle_request(
 }
 
 ss::future<ss::semaphore_units<>>
-protocol::connection_context::reserve_request_units(size_t size) {
+protocol::connection_context::reserve_request_units(api_key key, size_t size) {
+    if (key == fetch_api::key) {
+        // reserved together with the response once the request is read, so
+        // that a fetch never holds part of the budget while waiting for more
+        return ss::make_ready_future<ss::semaphore_units<>>(
+          ss::semaphore_units<>());
+    }
     // Allow for extra copies and bookkeeping
     auto mem_estimate = size * 2 + 8000;
     if (mem_estimate >= (size_t)std::numeric_limits<int32_t>::max()) {
@@ -131,30 +262,82 @@ protocol::connection_context::reserve_request_units(size_t size) {
           size,
           mem_estimate));
     }
-    auto fut = ss::get_units(_rs.memory(), mem_estimate);
-    if (_rs.memory().waiters()) {
+    const bool is_produce = key == produce_api::key;
+    auto& memory = is_produce ? _rs.memory() : _proto._control_memory;
+    auto fut = ss::get_units(
+      memory,
+      request_memory_estimate(
+        size,
+        is_produce ? _proto._produce_memory_size
+                   : _proto._control_memory_size));
+    if (memory.waiters()) {
+        _rs.probe().waiting_for_available_memory();
+    }
+    return fut;
+}
+
+ss::future<ss::semaphore_units<>>
+protocol::connection_context::reserve_response_units(
+  api_key key, const iobuf& buf) {
+    if (key != fetch_api::key) {
+        // other responses are small or, like the produce acks, bounded by
+        // their request
+        return ss::make_ready_future<ss::semaphore_units<>>(
+          ss::semaphore_units<>());
+    }
+    auto fut = ss::get_units(
+      _proto._fetch_memory,
+      fetch_memory_estimate(buf, _proto._fetch_memory_size));
+    if (_proto._fetch_memory.waiters()) {
         _rs.probe().waiting_for_available_memory();
     }
     return fut;
 }
 
+ss::future<> protocol::connection_context::reserve_inflight() {
+    if (_inflight.available_units() <= 0) {
+        ++_proto._inflight_limit_waits;
+    }
+    return _inflight.wait(1).then([this] { ++_proto._inflight_requests; });
+}
+
+void protocol::connection_context::release_inflight() {
+    --_proto._inflight_requests;
+    _inflight.signal(1);
+}
+
 ss::future<> protocol::connection_context::dispatch_method_once(
   request_header hdr, size_t size) {
-    return throttle_request(hdr.client_id, size)
+    return throttle_request(hdr, size)
       .then([this, hdr = std::move(hdr), size](session_resources sres) mutable {
           if (_rs.abort_requested()) {
               // protect against shutdown behavior
+              release_inflight();
               return ss::make_ready_future<>();
           }
           auto remaining = size - sizeof(raw_request_header)
                            - hdr.client_id_buffer.size();
+          // unsupported versions take the buffered path, which rejects them
+          if (
+            hdr.key == produce_api::key && _proto._produce_streaming_threshold
+            && remaining >= _proto._produce_streaming_threshold
+            && hdr.version >= produce_api::min_supported
+            && hdr.version <= produce_api::max_supported) {
+              return dispatch_streaming_produce(
+                std::move(hdr), remaining, std::move(sres));
+          }
           return read_iobuf_exactly(_rs.conn->input(), remaining)
             .then([this, hdr = std::move(hdr), sres = std::move(sres)](
                     iobuf buf) mutable {
                 if (_rs.abort_requested()) {
                     // _proto._cntrl etc might not be alive
+                    release_inflight();
                     return;
                 }
+                // responses are sent in the order requests were read
+                const sequence_id seq = _seq_idx;
+                _seq_idx = _seq_idx + sequence_id(1);
+                auto response_units = reserve_response_units(hdr.key, buf);
                 auto rctx = request_context(
                   _proto._metadata_cache,
                   _proto._topics_frontend.local(),
@@ -164,17 +347,28 @@ ss::future<> protocol::connection_context::dispatch_method_once(
                   _proto._group_router.local(),
                   _proto._shard_table.local(),
                   _proto._partition_manager,
-                  _proto._coordinator_mapper);
+                  _proto._coordinator_mapper,
+                  _proto._fetch_session_cache);
+                rctx.set_shard_locality(_shard_locality);
                 // background process this one full request
                 auto self = shared_from_this();
                 (void)ss::with_gate(
                   _rs.conn_gate(),
-                  [this, rctx = std::move(rctx)]() mutable {
-                      return do_process(std::move(rctx));
+                  [this,
+                   seq,
+                   rctx = std::move(rctx),
+                   response_units = std::move(response_units)]() mutable {
+                      return std::move(response_units)
+                        .then([this, seq, rctx = std::move(rctx)](
+                                ss::semaphore_units<> units) mutable {
+                            return do_process(
+                              std::move(rctx), seq, std::move(units));
+                        });
                   })
                   .handle_exception([self](std::exception_ptr e) {
                       vlog(
                         klog.info, "Detected error processing request: {}", e);
+                      self->break_inflight();
                       self->_rs.conn->shutdown_input();
                   })
                   .finally([s = std::move(sres), self] {});
@@ -182,38 +376,132 @@ ss::future<> protocol::connection_context::dispatch_method_once(
       });
 }
 
-ss::future<> protocol::connection_context::do_process(request_context ctx) {
-    const auto correlation = ctx.header().correlation;
+ss::future<> protocol::connection_context::dispatch_streaming_produce(
+  request_header hdr, size_t body_size, session_resources sres) {
+    // responses are sent in the order requests were read
     const sequence_id seq = _seq_idx;
     _seq_idx = _seq_idx + sequence_id(1);
+    const auto correlation = hdr.correlation;
+    auto rctx = request_context(
+      _proto._metadata_cache,
+      _proto._topics_frontend.local(),
+      std::move(hdr),
+      iobuf(),
+      sres.backpressure_delay,
+      _proto._group_router.local(),
+      _proto._shard_table.local(),
+      _proto._partition_manager,
+      _proto._coordinator_mapper,
+      _proto._fetch_session_cache);
+    rctx.set_shard_locality(_shard_locality);
+    ss::promise<> body_read;
+    auto f = body_read.get_future();
+    auto self = shared_from_this();
+    (void)ss::with_gate(
+      _rs.conn_gate(),
+      [this,
+       seq,
+       correlation,
+       body_size,
+       rctx = std::move(rctx),
+       body_read = std::move(body_read)]() mutable {
+          return produce_api::process_streaming(
+                   std::move(rctx),
+                   _rs.conn->input(),
+                   body_size,
+                   std::move(body_read),
+                   _proto._smp_group)
+            .then([this, seq, correlation](response_ptr r) {
+                r->set_correlation(correlation);
+                return queue_response(
+                  seq, pending_response{.response = std::move(r)});
+            });
+      })
+      .handle_exception([self](std::exception_ptr e) {
+          vlog(klog.info, "Detected error processing request: {}", e);
+          self->break_inflight();
+          self->_rs.conn->shutdown_input();
+      })
+      .finally([s = std::move(sres), self] {});
+    // the next request is read once this one was
+    return f;
+}
+
+ss::future<> protocol::connection_context::do_process(
+  request_context ctx, sequence_id seq, ss::semaphore_units<> units) {
+    const auto correlation = ctx.header().correlation;
+    // fetch quotas are charged with the response size
+    const bool is_fetch = ctx.header().key == fetch_api::key;
+    std::optional<ss::sstring> client_id;
+    if (is_fetch && ctx.header().client_id) {
+        client_id = ss::sstring(*ctx.header().client_id);
+    }
     return kafka::process_request(std::move(ctx), _proto._smp_group)
-      .then([this, seq, correlation](response_ptr r) mutable {
+      .then([this,
+             seq,
+             correlation,
+             is_fetch,
+             client_id = std::move(client_id),
+             units = std::move(units)](response_ptr r) mutable {
           r->set_correlation(correlation);
-          _responses.insert({seq, std::move(r)});
-          return process_next_response();
+          if (is_fetch) {
+              _proto._quota_mgr.local().record_fetch_tp(
+                client_id, r->buf().size_bytes());
+          }
+          return queue_response(
+            seq,
+            pending_response{
+              .response = std::move(r), .units = std::move(units)});
       });
 }
 
+ss::future<> protocol::connection_context::queue_response(
+  sequence_id seq, pending_response r) {
+    _responses.insert({seq, std::move(r)});
+    ++_proto._queued_responses;
+    return process_next_response();
+}
+
 ss::future<> protocol::connection_context::process_next_response() {
     return ss::repeat([this]() mutable {
-        auto it = _responses.find(_next_response);
-        if (it == _responses.end()) {
-            return ss::make_ready_future<ss::stop_iteration>(
-              ss::stop_iteration::yes);
+        /*
+         * coalesce every consecutive response that is ready into a single
+         * write, so a slow response at the head is followed by one write of
+         * everything that completed behind it
+         */
+        ss::scattered_message<char> msg;
+        size_t responses = 0;
+        size_t fragments = 0;
+        for (auto it = _responses.find(_next_response); it != _responses.end();
+             it = _responses.find(_next_response)) {
+            auto& pending = it->second;
+            if (!pending.response->is_noop()) {
+                const auto n = scattered_fragments(*pending.response);
+                if (responses > 0 && fragments + n > max_scattered_fragments) {
+                    break;
+                }
+                fragments += n;
+                ++responses;
+                append_response_as_scattered(
+                  msg, std::move(pending.response));
+                // the response memory is given back once it has been sent
+                msg.on_delete([units = std::move(pending.units)] {});
+            }
+            // found one; increment counter
+            _next_response = _next_response + sequence_id(1);
+            _responses.erase(it);
+            --_proto._queued_responses;
+            _rs.probe().request_completed();
+            release_inflight();
         }
-        // found one; increment counter
-        _next_response = _next_response + sequence_id(1);
 
-        auto r = std::move(it->second);
-        _responses.erase(it);
-        _rs.probe().request_completed();
-
-        if (r->is_noop()) {
+        if (responses == 0) {
             return ss::make_ready_future<ss::stop_iteration>(
-              ss::stop_iteration::no);
+              ss::stop_iteration::yes);
         }
 
-        auto msg = response_as_scattered(std::move(r));
+        ++_proto._response_writes;
+        _proto._coalesced_responses += responses - 1;
         _rs.probe().add_bytes_sent(msg.size());
         try {
             return _rs.conn->write(std::move(msg)).then([] {
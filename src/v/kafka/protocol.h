@@ -14,17 +14,22 @@
 #include "cluster/partition_manager.h"
 #include "cluster/shard_table.h"
 #include "cluster/topics_frontend.h"
+#include "kafka/fetch_session_cache.h"
 #include "kafka/groups/group_router.h"
 #include "kafka/quota_manager.h"
 #include "kafka/requests/request_context.h"
 #include "kafka/requests/response.h"
+#include "kafka/shard_locality.h"
+#include "resource_mgmt/memory_groups.h"
 #include "rpc/server.h"
 #include "utils/hdr_hist.h"
 
+#include <seastar/core/abort_source.hh>
 #include <seastar/core/future.hh>
 #include <seastar/core/lowres_clock.hh>
 #include <seastar/core/metrics_registration.hh>
 #include <seastar/core/scattered_message.hh>
+#include <seastar/core/semaphore.hh>
 #include <seastar/core/sharded.hh>
 #include <seastar/core/shared_ptr.hh>
 
@@ -61,12 +66,14 @@ public:
       ss::sharded<kafka::group_router_type>&,
       ss::sharded<cluster::shard_table>&,
       ss::sharded<cluster::partition_manager>&,
-      ss::sharded<coordinator_ntp_mapper>& coordinator_mapper) noexcept;
+      ss::sharded<coordinator_ntp_mapper>& coordinator_mapper,
+      ss::sharded<fetch_session_cache>&) noexcept;
 
     ~protocol() noexcept override = default;
     protocol(const protocol&) = delete;
     protocol& operator=(const protocol&&) = delete;
-    protocol(protocol&&) noexcept = default;
+    // metrics refer to the protocol
+    protocol(protocol&&) noexcept = delete;
     protocol& operator=(protocol&&) noexcept = delete;
 
     const char* name() const final { return "kafka rpc protocol"; }
@@ -75,15 +82,25 @@ public:
     ss::future<> apply(rpc::server::resources) final;
 
 private:
-    using map_t = absl::flat_hash_map<sequence_id, response_ptr>;
+    /// a completed response and the memory it holds until it is sent
+    struct pending_response {
+        response_ptr response;
+        ss::semaphore_units<> units;
+    };
+    using map_t = absl::flat_hash_map<sequence_id, pending_response>;
 
     class connection_context final
       : public ss::enable_lw_shared_from_this<connection_context> {
     public:
         connection_context(protocol& p, rpc::server::resources&& r) noexcept
           : _proto(p)
-          , _rs(std::move(r)) {}
-        ~connection_context() noexcept = default;
+          , _rs(std::move(r))
+          , _inflight(p._max_inflight_per_connection)
+          , _abort_sub(_rs.abort_source().subscribe(
+              [this]() noexcept { break_inflight(); }))
+          , _shard_locality(
+              ss::make_lw_shared<shard_locality>(&p._shard_locality)) {}
+        ~connection_context() noexcept;
         connection_context(const connection_context&) = delete;
         connection_context(connection_context&&) = delete;
         connection_context& operator=(const connection_context&) = delete;
@@ -94,15 +111,36 @@ private:
 
     private:
         /// called by throttle_request
-        ss::future<ss::semaphore_units<>> reserve_request_units(size_t size);
+        ss::future<ss::semaphore_units<>>
+        reserve_request_units(api_key, size_t size);
+
+        /// reserves the memory of the response to a request whose body is
+        /// \p buf, held until the response is sent. fetches reserve their
+        /// request here as well
+        ss::future<ss::semaphore_units<>>
+        reserve_response_units(api_key, const iobuf& buf);
 
         /// apply correct backpressure sequence
         ss::future<session_resources>
-        throttle_request(std::optional<std::string_view>, size_t sz);
+        throttle_request(const request_header&, size_t sz);
 
         ss::future<> dispatch_method_once(request_header, size_t sz);
+        /// dispatches a large produce request while its body is read, the
+        /// returned future resolves once the body was read
+        ss::future<> dispatch_streaming_produce(
+          request_header, size_t body_size, session_resources);
         ss::future<> process_next_response();
-        ss::future<> do_process(request_context);
+        ss::future<>
+          do_process(request_context, sequence_id, ss::semaphore_units<>);
+        ss::future<> queue_response(sequence_id, pending_response);
+
+        /// bounds the requests processed or waiting for an earlier response
+        ss::future<> reserve_inflight();
+        void release_inflight();
+        /// wakes up the reader waiting for an in-flight unit. called when a
+        /// request fails, as its unit and its response are never given back,
+        /// and on shutdown
+        void break_inflight() { _inflight.broken(); }
 
     private:
         protocol& _proto;
@@ -110,11 +148,39 @@ private:
         sequence_id _next_response;
         sequence_id _seq_idx;
         map_t _responses;
+        ss::semaphore _inflight;
+        ss::optimized_optional<ss::abort_source::subscription> _abort_sub;
+        // shared with the requests of the connection
+        ss::lw_shared_ptr<shard_locality> _shard_locality;
     };
     friend connection_context;
 
+    void setup_metrics();
+
 private:
     ss::smp_service_group _smp_group;
+    const size_t _max_inflight_per_connection;
+    const size_t _produce_streaming_threshold;
+
+    // produce requests reserve from the server memory, fetches and every
+    // other request have a budget of their own
+    const size_t _produce_memory_size{memory_groups::kafka_produce_memory()};
+    const size_t _fetch_memory_size{memory_groups::kafka_fetch_memory()};
+    ss::semaphore _fetch_memory{_fetch_memory_size};
+    const size_t _control_memory_size{memory_groups::kafka_control_memory()};
+    ss::semaphore _control_memory{_control_memory_size};
+
+    // requests of all connections processed or waiting for their response
+    size_t _inflight_requests{0};
+    // responses completed ahead of an earlier response of their connection
+    size_t _queued_responses{0};
+    uint64_t _inflight_limit_waits{0};
+    uint64_t _response_writes{0};
+    uint64_t _coalesced_responses{0};
+    // partitions requested by all connections, by the shard owning them
+    shard_locality _shard_locality;
+    uint64_t _misplaced_connections{0};
+    ss::metrics::metric_groups _metrics;
 
     // services needed by kafka proto
     ss::sharded<cluster::topics_frontend>& _topics_frontend;
@@ -124,6 +190,7 @@ private:
     ss::sharded<cluster::shard_table>& _shard_table;
     ss::sharded<cluster::partition_manager>& _partition_manager;
     ss::sharded<kafka::coordinator_ntp_mapper>& _coordinator_mapper;
+    ss::sharded<fetch_session_cache>& _fetch_session_cache;
 };
 
 } // namespace kafka
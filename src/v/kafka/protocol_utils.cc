@@ -11,9 +11,11 @@
 
 #include "bytes/iobuf.h"
 #include "bytes/iobuf_parser.h"
+#include "kafka/requests/fetch_request.h"
 
 #include <seastar/core/temporary_buffer.hh>
 
+#include <algorithm>
 #include <stdexcept>
 #include <vector>
 
@@ -89,7 +91,13 @@ ss::future<std::optional<size_t>> parse_size(ss::input_stream<char>& src) {
       });
 }
 
-ss::scattered_message<char> response_as_scattered(response_ptr response) {
+size_t scattered_fragments(const response& r) {
+    // one more for the frame header
+    return std::distance(r.buf().begin(), r.buf().end()) + 1;
+}
+
+void append_response_as_scattered(
+  ss::scattered_message<char>& msg, response_ptr response) {
     auto correlation = response->correlation();
     auto header = ss::temporary_buffer<char>(sizeof(raw_response_header));
     // NOLINTNEXTLINE
@@ -100,14 +108,13 @@ ss::scattered_message<char> response_as_scattered(response_ptr response) {
     raw_header->correlation = ss::cpu_to_be(correlation());
     auto& buf = response->buf();
     buf.prepend(std::move(header));
-    ss::scattered_message<char> msg;
     auto in = iobuf::iterator_consumer(buf.cbegin(), buf.cend());
     int32_t chunk_no = 0;
     in.consume(
       buf.size_bytes(), [&msg, &chunk_no, &buf](const char* src, size_t sz) {
           ++chunk_no;
           vassert(
-            chunk_no <= std::numeric_limits<int16_t>::max(),
+            chunk_no <= static_cast<int32_t>(max_scattered_fragments),
             "Invalid construction of scattered_message. max count:{}. Usually "
             "a bug with small append() to iobuf. {}",
             chunk_no,
@@ -117,7 +124,33 @@ ss::scattered_message<char> response_as_scattered(response_ptr response) {
       });
     // MUST be the foreign ptr not the iobuf
     msg.on_delete([response = std::move(response)] {});
+}
+
+ss::scattered_message<char> response_as_scattered(response_ptr response) {
+    ss::scattered_message<char> msg;
+    append_response_as_scattered(msg, std::move(response));
     return msg;
 }
 
+size_t request_memory_estimate(size_t size, size_t budget) {
+    return std::min(size * 2 + 8000, budget);
+}
+
+size_t fetch_memory_estimate(const iobuf& buf, size_t budget) {
+    // the request itself, as for other requests
+    size_t estimate = buf.size_bytes() * 2 + 8000;
+    // replica_id, max_wait_time and min_bytes come before max_bytes, which
+    // every supported version has
+    static constexpr size_t max_bytes_offset = 12;
+    if (buf.size_bytes() >= max_bytes_offset + sizeof(int32_t)) {
+        iobuf_const_parser parser(buf);
+        parser.skip(max_bytes_offset);
+        auto max_bytes = parser.consume_be_type<int32_t>();
+        estimate += std::min(
+          size_t(std::max(max_bytes, 0)), fetch_api::max_response_size);
+    }
+    // a reservation larger than the budget could never be granted
+    return std::min(estimate, budget);
+}
+
 } // namespace kafka
@@ -19,6 +19,7 @@
 #include <seastar/core/scattered_message.hh>
 #include <seastar/core/temporary_buffer.hh>
 
+#include <limits>
 #include <optional>
 
 namespace kafka {
@@ -29,6 +30,26 @@ ss::future<std::optional<request_header>> parse_header(ss::input_stream<char>&);
 size_t parse_size_buffer(ss::temporary_buffer<char>&);
 ss::future<std::optional<size_t>> parse_size(ss::input_stream<char>&);
 
+/// scattered messages are backed by packets, which limit their fragments
+static constexpr size_t max_scattered_fragments
+  = std::numeric_limits<int16_t>::max();
+
+/// number of fragments the response adds to a scattered message
+size_t scattered_fragments(const response&);
+
+/// appends the framed response to \p msg, which keeps it alive
+void append_response_as_scattered(
+  ss::scattered_message<char>& msg, response_ptr response);
+
 ss::scattered_message<char> response_as_scattered(response_ptr response);
 
+/// memory reserved while a request of \p size bytes is processed. allows for
+/// extra copies and bookkeeping, bounded by the \p budget of its memory group
+/// so that a large request waits for all of it rather than forever
+size_t request_memory_estimate(size_t size, size_t budget);
+
+/// memory reserved for a fetch request body \p buf and the response it asks
+/// for, bounded by \p budget like request_memory_estimate()
+size_t fetch_memory_estimate(const iobuf& buf, size_t budget);
+
 } // namespace kafka
@@ -13,31 +13,33 @@
 #include "kafka/logger.h"
 #include "vlog.h"
 
+#include <seastar/core/smp.hh>
+
 namespace kafka {
 using clock = quota_manager::clock;
 using throttle_delay = quota_manager::throttle_delay;
 
-quota_manager::~quota_manager() { _gc_timer.cancel(); }
+quota_manager::~quota_manager() {
+    _gc_timer.cancel();
+    _aggregation_timer.cancel();
+}
 
 ss::future<> quota_manager::stop() {
     _gc_timer.cancel();
-    return ss::make_ready_future<>();
+    _aggregation_timer.cancel();
+    return _gate.close();
 }
 
 ss::future<> quota_manager::start() {
     _gc_timer.arm_periodic(_gc_freq);
+    if (ss::this_shard_id() == 0 && ss::smp::count > 1) {
+        _aggregation_timer.arm(_aggregation_freq);
+    }
     return ss::make_ready_future<>();
 }
 
-// record a new observation and return <previous delay, new delay>
-throttle_delay quota_manager::record_tp_and_throttle(
-  std::optional<std::string_view> client_id,
-  uint64_t bytes,
-  clock::time_point now) {
-    // requests without a client id are grouped into an anonymous group that
-    // shares a default quota. the anonymous group is keyed on empty string.
-    auto cid = client_id ? *client_id : "";
-
+quota_manager::quota&
+quota_manager::get_or_create_quota(std::string_view cid, clock::time_point now) {
     // find or create the throughput tracker for this client
     //
     // c++20: heterogeneous lookup for unordered_map can avoid creation of
@@ -50,22 +52,30 @@ throttle_delay quota_manager::record_tp_and_throttle(
       quota{
         now,
         clock::duration(0),
+        clock::duration(0),
+        {_default_num_windows, _default_window_width},
         {_default_num_windows, _default_window_width}});
 
     // bump to prevent gc
     if (!inserted) {
         it->second.last_seen = now;
     }
+    return it->second;
+}
 
-    auto rate = it->second.tp_rate.record_and_measure(bytes, now);
-
+throttle_delay quota_manager::throttle(
+  std::string_view cid,
+  double rate,
+  uint32_t target_rate,
+  clock::duration window_size,
+  clock::duration& last_delay) {
     uint64_t delay_ms = 0;
-    if (rate > _target_tp_rate) {
-        auto diff = rate - _target_tp_rate;
+    if (rate > target_rate) {
+        auto diff = rate - target_rate;
         double delay
-          = (diff / _target_tp_rate)
+          = (diff / target_rate)
             * (double)std::chrono::duration_cast<std::chrono::milliseconds>(
-                it->second.tp_rate.window_size())
+                window_size)
                 .count();
         delay_ms = static_cast<uint64_t>(delay);
     }
@@ -81,14 +91,55 @@ throttle_delay quota_manager::record_tp_and_throttle(
         delay_ms = _max_delay.count();
     }
 
-    auto prev = it->second.delay;
-    it->second.delay = std::chrono::milliseconds(delay_ms);
+    auto prev = last_delay;
+    last_delay = std::chrono::milliseconds(delay_ms);
 
     throttle_delay res{};
     res.first_violation = prev.count() == 0;
-    res.duration = it->second.delay;
+    res.duration = last_delay;
     return res;
 }
+
+// record a new observation and return <previous delay, new delay>
+throttle_delay quota_manager::record_produce_tp_and_throttle(
+  std::optional<std::string_view> client_id,
+  uint64_t bytes,
+  clock::time_point now) {
+    // requests without a client id are grouped into an anonymous group that
+    // shares a default quota. the anonymous group is keyed on empty string.
+    auto cid = client_id ? *client_id : "";
+    auto& q = get_or_create_quota(cid, now);
+    auto rate = q.produce_rate.record_and_measure(bytes, now)
+                + q.remote_produce_rate;
+    return throttle(
+      cid,
+      rate,
+      _target_produce_tp_rate,
+      q.produce_rate.window_size(),
+      q.produce_delay);
+}
+
+throttle_delay quota_manager::throttle_fetch_tp(
+  std::optional<std::string_view> client_id, clock::time_point now) {
+    auto cid = client_id ? *client_id : "";
+    auto& q = get_or_create_quota(cid, now);
+    auto rate = q.fetch_rate.measure(now) + q.remote_fetch_rate;
+    return throttle(
+      cid,
+      rate,
+      _target_fetch_tp_rate,
+      q.fetch_rate.window_size(),
+      q.fetch_delay);
+}
+
+void quota_manager::record_fetch_tp(
+  std::optional<std::string_view> client_id,
+  uint64_t bytes,
+  clock::time_point now) {
+    auto cid = client_id ? *client_id : "";
+    get_or_create_quota(cid, now).fetch_rate.record_and_measure(bytes, now);
+}
+
 // erase inactive tracked quotas. windows are considered inactive if they
 // have not received any updates in ten window's worth of time.
 void quota_manager::gc(clock::duration full_window) {
@@ -101,4 +152,75 @@ void quota_manager::gc(clock::duration full_window) {
       });
 }
 
+quota_manager::client_rates quota_manager::local_rates(clock::time_point now) {
+    client_rates ret;
+    ret.reserve(_quotas.size());
+    for (auto& [cid, q] : _quotas) {
+        ret.emplace(
+          cid,
+          shard_rates{
+            .produce = q.produce_rate.measure(now),
+            .fetch = q.fetch_rate.measure(now),
+          });
+    }
+    return ret;
+}
+
+void quota_manager::update_remote_rates(const node_rates& rates) {
+    const auto self = ss::this_shard_id();
+    for (auto& [cid, q] : _quotas) {
+        q.remote_produce_rate = 0.;
+        q.remote_fetch_rate = 0.;
+        auto it = rates.find(cid);
+        if (it == rates.end()) {
+            continue;
+        }
+        for (ss::shard_id s = 0; s < it->second.size(); ++s) {
+            if (s == self) {
+                continue;
+            }
+            q.remote_produce_rate += it->second[s].produce;
+            q.remote_fetch_rate += it->second[s].fetch;
+        }
+    }
+}
+
+void quota_manager::dispatch_aggregation() {
+    // the timer is re-armed inside the gate so that stop() cannot complete
+    // while the continuation still refers to this service
+    (void)ss::with_gate(_gate, [this] {
+        return aggregate()
+          .handle_exception([](std::exception_ptr e) {
+              vlog(klog.info, "Error aggregating quota rates: {}", e);
+          })
+          .finally([this] {
+              if (!_gate.is_closed()) {
+                  _aggregation_timer.arm(_aggregation_freq);
+              }
+          });
+    }).handle_exception_type([](const ss::gate_closed_exception&) {});
+}
+
+ss::future<> quota_manager::aggregate() {
+    return ss::do_with(node_rates{}, [this](node_rates& rates) {
+        return container()
+          .invoke_on_all([&rates](quota_manager& qm) {
+              auto local = qm.local_rates(clock::now());
+              const auto shard = ss::this_shard_id();
+              return ss::smp::submit_to(
+                0, [&rates, shard, local = std::move(local)]() mutable {
+                    for (auto& [cid, r] : local) {
+                        auto& v = rates[cid];
+                        v.resize(ss::smp::count);
+                        v[shard] = r;
+                    }
+                });
+          })
+          .then([this, &rates] {
+              return container().invoke_on_all(
+                [&rates](quota_manager& qm) { qm.update_remote_rates(rates); });
+          });
+    });
+}
+
 } // namespace kafka
@@ -15,7 +15,9 @@
 #include "seastarx.h"
 
 #include <seastar/core/future.hh>
+#include <seastar/core/gate.hh>
 #include <seastar/core/lowres_clock.hh>
+#include <seastar/core/sharded.hh>
 #include <seastar/core/sstring.hh>
 #include <seastar/core/timer.hh>
 
@@ -24,27 +26,33 @@
 #include <chrono>
 #include <optional>
 #include <string_view>
+#include <vector>
 
 namespace kafka {
 
 // quota_manager tracks quota usage
 //
+// produce and fetch throughput are tracked separately per client_id. produce
+// requests are charged with the size of the request and fetch requests are
+// charged with the size of the response that was sent back to the client.
+// all other requests are charged with their size against the produce quota,
+// which is how every request was throttled before fetch had its own quota.
+//
+// each shard records the throughput it observes locally. periodically shard 0
+// collects the per-client rates from every core and hands back to each shard
+// the throughput the same client generated on all other cores. throttling
+// decisions are then made against the node-wide rate, so a client that spreads
+// its connections across cores cannot exceed its quota by a factor of the core
+// count.
+//
 // TODO:
 //   - we will want to eventually add support for configuring the quotas and
 //   quota settings as runtime through the kafka api and other mechanisms.
 //
-//   - currently only total throughput per client_id is tracked. in the future
-//   we will want to support additional quotas and accouting granularities to be
-//   at parity with kafka. for example:
-//
-//      - splitting out rates separately for produce and fetch
-//      - accounting per user vs per client (these are separate in kafka)
-//
-//   - it may eventually be beneficial to periodically reduce stats across
-//   shards or track stats globally to produce a more accurate per-node
-//   representation of a statistic (e.g. bandwidth).
+//   - accounting per user vs per client (these are separate in kafka). this
+//   requires an authenticated principal on the connection.
 //
-class quota_manager {
+class quota_manager : public ss::peering_sharded_service<quota_manager> {
 public:
     using clock = ss::lowres_clock;
 
@@ -53,14 +61,30 @@ public:
         clock::duration duration;
     };
 
+    // produce/fetch throughput of a single client observed on one shard
+    struct shard_rates {
+        double produce{0.};
+        double fetch{0.};
+    };
+
+    using client_rates = absl::flat_hash_map<ss::sstring, shard_rates>;
+    using node_rates
+      = absl::flat_hash_map<ss::sstring, std::vector<shard_rates>>;
+
     quota_manager()
       : _default_num_windows(config::shard_local_cfg().default_num_windows())
       , _default_window_width(config::shard_local_cfg().default_window_sec())
-      , _target_tp_rate(config::shard_local_cfg().target_quota_byte_rate())
+      , _target_produce_tp_rate(
+          config::shard_local_cfg().target_quota_byte_rate())
+      , _target_fetch_tp_rate(
+          config::shard_local_cfg().target_fetch_quota_byte_rate())
       , _gc_freq(config::shard_local_cfg().quota_manager_gc_sec())
+      , _aggregation_freq(
+          config::shard_local_cfg().quota_manager_aggregation_interval_ms())
       , _max_delay(config::shard_local_cfg().max_kafka_throttle_delay_ms()) {
         auto full_window = _default_num_windows * _default_window_width;
         _gc_timer.set_callback([this, full_window] { gc(full_window); });
+        _aggregation_timer.set_callback([this] { dispatch_aggregation(); });
     }
 
     quota_manager(const quota_manager&) = delete;
@@ -74,36 +98,82 @@ public:
 
     ss::future<> start();
 
-    // record a new observation and return <previous delay, new delay>
-    throttle_delay record_tp_and_throttle(
+    // record a produce (or any non-fetch) request observation and return
+    // <previous delay, new delay>
+    throttle_delay record_produce_tp_and_throttle(
       std::optional<std::string_view> client_id,
       uint64_t bytes,
       clock::time_point now = clock::now());
 
-private:
-    // erase inactive tracked quotas. windows are considered inactive if they
-    // have not received any updates in ten window's worth of time.
-    void gc(clock::duration full_window);
+    // compute the delay to apply to a fetch from the fetch throughput that
+    // was previously recorded for this client
+    throttle_delay throttle_fetch_tp(
+      std::optional<std::string_view> client_id,
+      clock::time_point now = clock::now());
+
+    // record the size of a fetch response sent to a client
+    void record_fetch_tp(
+      std::optional<std::string_view> client_id,
+      uint64_t bytes,
+      clock::time_point now = clock::now());
+
+    // collect the per-client rates of every shard on shard 0 and hand each
+    // shard the rates seen on the others. runs periodically on shard 0.
+    ss::future<> aggregate();
 
 private:
     // last_seen: used for gc keepalive
-    // delay: last calculated delay
-    // tp_rate: throughput tracking
+    // *_delay: last calculated delay
+    // *_rate: throughput tracking on this shard
+    // remote_*_rate: throughput of the same client on all other shards, as of
+    // the last aggregation round
     struct quota {
         clock::time_point last_seen;
-        clock::duration delay;
-        rate_tracker tp_rate;
+        clock::duration produce_delay;
+        clock::duration fetch_delay;
+        rate_tracker produce_rate;
+        rate_tracker fetch_rate;
+        double remote_produce_rate{0.};
+        double remote_fetch_rate{0.};
     };
 
+    quota& get_or_create_quota(std::string_view cid, clock::time_point now);
+
+    throttle_delay throttle(
+      std::string_view cid,
+      double rate,
+      uint32_t target_rate,
+      clock::duration window_size,
+      clock::duration& last_delay);
+
+    // erase inactive tracked quotas. windows are considered inactive if they
+    // have not received any updates in ten window's worth of time.
+    void gc(clock::duration full_window);
+
+    // rates of every client tracked on this shard
+    client_rates local_rates(clock::time_point now);
+
+    // install the rates observed on other shards. `rates` is owned by shard 0
+    // and is only read here.
+    void update_remote_rates(const node_rates& rates);
+
+    // runs on shard 0 only
+    void dispatch_aggregation();
+
+private:
     const std::size_t _default_num_windows;
     const clock::duration _default_window_width;
 
-    const uint32_t _target_tp_rate;
+    const uint32_t _target_produce_tp_rate;
+    const uint32_t _target_fetch_tp_rate;
     absl::flat_hash_map<ss::sstring, quota> _quotas;
 
     ss::timer<> _gc_timer;
     const clock::duration _gc_freq;
+    ss::timer<> _aggregation_timer;
+    const clock::duration _aggregation_freq;
     const clock::duration _max_delay;
+    ss::gate _gate;
 };
 
 } // namespace kafka
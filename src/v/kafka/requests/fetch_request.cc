@@ -11,6 +11,7 @@
 
 #include "cluster/namespace.h"
 #include "cluster/partition_manager.h"
+#include "config/configuration.h"
 #include "kafka/errors.h"
 #include "kafka/requests/batch_consumer.h"
 #include "likely.h"
@@ -313,6 +314,27 @@ static ss::future<read_result> read_from_partition(
       std::nullopt);
 
     reader_config.strict_max_bytes = config.strict_max_bytes;
+    // consumers following the tail are served without touching the log
+    if (auto tail = pw.read_tail(reader_config)) {
+        return ss::make_ready_future<read_result>(read_result(
+          ss::make_foreign(
+            std::make_unique<storage::raw_read_result>(std::move(*tail))),
+          hw,
+          lso));
+    }
+    if (config::shard_local_cfg().kafka_fetch_raw_reads()) {
+        auto cache = storage::use_batch_cache(
+          config::shard_local_cfg().kafka_fetch_raw_reads_from_batch_cache());
+        return pw.read_raw(reader_config, cache)
+          .then([hw, lso](storage::raw_read_result raw) {
+              // the payloads are freed back on this core
+              return read_result(
+                ss::make_foreign(std::make_unique<storage::raw_read_result>(
+                  std::move(raw))),
+                hw,
+                lso);
+          });
+    }
     return pw.make_reader(reader_config)
       .then([hw, lso, foreign_read, deadline](model::record_batch_reader rdr) {
           // if we are on remote core, we MUST use foreign record batch reader.
@@ -332,6 +354,23 @@ static ss::future<read_result> read_from_partition(
       });
 }
 
+/**
+ * Splices the payloads of a raw read into the response after their kafka
+ * headers. Payloads read on another core are copied so that the response
+ * does not hold on to that core's buffers.
+ */
+static iobuf serialize_raw_read(
+  ss::foreign_ptr<std::unique_ptr<storage::raw_read_result>> raw) {
+    const bool local = raw.get_owner_shard() == ss::this_shard_id();
+    iobuf data;
+    response_writer wr(data);
+    for (auto& b : raw->batches) {
+        writer_serialize_batch_header(wr, b.header);
+        wr.write_direct(local ? std::move(b.payload) : b.payload.copy());
+    }
+    return data;
+}
+
 /**
  * Entry point for reading from an ntp. This will forward the request to
  * the ntp's home core and build error responses if anything goes wrong.
@@ -344,7 +383,7 @@ read_from_ntp(op_context& octx, model::ntp ntp, fetch_config config) {
      * to pass.
      */
     auto mntpv = model::materialized_ntp(std::move(ntp));
-    auto shard = octx.rctx.shards().shard_for(mntpv.source_ntp());
+    auto shard = octx.rctx.shard_for(mntpv.source_ntp());
 
     if (unlikely(!shard)) {
         return make_ready_partition_response_error(
@@ -401,18 +440,41 @@ read_from_ntp(op_context& octx, model::ntp ntp, fetch_config config) {
         })
       .then([timeout = config.timeout](read_result res) mutable {
           vlog(klog.trace, "fetch reader {}", res.reader);
+          const auto hw = res.high_watermark;
+          const auto lso = res.last_stable_offset;
+          if (res.raw) {
+              return ss::make_ready_future<fetch_response::partition_response>(
+                fetch_response::partition_response{
+                  .error = error_code::none,
+                  .high_watermark = hw,
+                  .last_stable_offset = lso,
+                  .record_set = serialize_raw_read(std::move(*res.raw)),
+                });
+          }
           // error case
-          if (!res.reader) {
+          if (res.error != error_code::none) {
               return make_ready_partition_response_error(res.error);
           }
+          // nothing to read yet
+          if (!res.reader) {
+              return ss::make_ready_future<fetch_response::partition_response>(
+                fetch_response::partition_response{
+                  .error = error_code::none,
+                  .high_watermark = hw,
+                  .last_stable_offset = lso,
+                  .record_set = iobuf(),
+                });
+          }
           return std::move(*res.reader)
             .consume(kafka_batch_serializer(), timeout)
-            .then([](kafka_batch_serializer::result res) mutable {
+            .then([hw, lso](kafka_batch_serializer::result res) mutable {
                 /*
                  * return path will fill in other response fields.
                  */
                 return fetch_response::partition_response{
                   .error = error_code::none,
+                  .high_watermark = hw,
+                  .last_stable_offset = lso,
                   .record_set = std::move(res.data),
                 };
             });
@@ -547,9 +609,6 @@ static ss::future<> fetch_topic_partitions(op_context& octx) {
 ss::future<response_ptr>
 fetch_api::process(request_context&& rctx, ss::smp_service_group ssg) {
     return ss::do_with(op_context(std::move(rctx), ssg), [](op_context& octx) {
-        // top-level error is used for session-level errors, but we do
-        // not yet implement session management.
-        octx.response.error = error_code::none;
         // first fetch, do not wait
         return fetch_topic_partitions(octx)
           .then([&octx] {
@@ -573,6 +632,18 @@ op_context::op_context(request_context&& ctx, ss::smp_service_group ssg)
      * decode request and prepare the inital response
      */
     request.decode(rctx);
+    if (rctx.header().version >= api_version(7)) {
+        /*
+         * requests of a session fetch all of the session partitions. the
+         * top-level error reports session errors, in which case nothing is
+         * fetched.
+         */
+        session_ctx = rctx.fetch_sessions().maybe_get_session(request);
+        if (session_ctx.has_error()) {
+            request.topics.clear();
+        }
+    }
+    response.error = session_ctx.error;
     if (likely(!request.topics.empty())) {
         response.partitions.reserve(request.topics.size());
     }
@@ -581,13 +652,8 @@ op_context::op_context(request_context&& ctx, ss::smp_service_group ssg)
         deadline = model::timeout_clock::now() + delay.value();
     }
 
-    /*
-     * TODO: max size is multifaceted. it needs to be absolute, but also
-     * integrate with other resource contraints that are dynamic within the
-     * kafka server itself.
-     */
-    static constexpr size_t max_size = 128_KiB;
-    bytes_left = std::min(max_size, size_t(request.max_bytes));
+    bytes_left = std::min(
+      fetch_api::max_response_size, size_t(request.max_bytes));
 
     create_response_placeholders();
 }
@@ -621,7 +687,12 @@ void op_context::create_response_placeholders() {
 }
 
 ss::future<response_ptr> op_context::send_response() && {
-    response.session_id = invalid_fetch_session_id;
+    if (session_ctx.session) {
+        rctx.fetch_sessions().update_session(session_ctx, response);
+        response.session_id = session_ctx.session->id();
+    } else {
+        response.session_id = invalid_fetch_session_id;
+    }
     return rctx.respond(std::move(response));
 }
 
@@ -12,14 +12,17 @@
 #pragma once
 
 #include "cluster/partition.h"
+#include "kafka/fetch_session_cache.h"
 #include "kafka/requests/request_context.h"
 #include "kafka/requests/response.h"
 #include "likely.h"
 #include "model/metadata.h"
 #include "model/timeout_clock.h"
 #include "seastarx.h"
+#include "units.h"
 
 #include <seastar/core/future.hh>
+#include <seastar/core/sharded.hh>
 
 namespace kafka {
 
@@ -33,6 +36,13 @@ struct fetch_api final {
     static constexpr api_version min_supported = api_version(4);
     static constexpr api_version max_supported = api_version(10);
 
+    /*
+     * TODO: max size is multifaceted. it needs to be absolute, but also
+     * integrate with other resource contraints that are dynamic within the
+     * kafka server itself.
+     */
+    static constexpr size_t max_response_size = 128_KiB;
+
     static ss::future<response_ptr>
     process(request_context&&, ss::smp_service_group);
 };
@@ -65,8 +75,9 @@ struct fetch_request final {
     int32_t min_bytes;
     int32_t max_bytes;      // >= v3
     int8_t isolation_level; // >= v4
-    int32_t session_id;     // >= v7
-    int32_t session_epoch;  // >= v7
+    // sessionless unless set
+    int32_t session_id = invalid_fetch_session_id();     // >= v7
+    int32_t session_epoch = final_fetch_session_epoch(); // >= v7
     std::vector<topic> topics;
     std::vector<forgotten_topic> forgotten_topics; // >= v7
 
@@ -401,6 +412,7 @@ struct op_context {
     ss::smp_service_group ssg;
     fetch_request request;
     fetch_response response;
+    fetch_session_ctx session_ctx;
 
     // operation budgets
     size_t bytes_left;
@@ -428,6 +440,17 @@ public:
                     : _partition->make_reader(config);
     }
 
+    std::optional<storage::raw_read_result>
+    read_tail(storage::log_reader_config config) {
+        return _log ? _log->read_tail(config) : _partition->read_tail(config);
+    }
+
+    ss::future<storage::raw_read_result> read_raw(
+      storage::log_reader_config config, storage::use_batch_cache cache) {
+        return _log ? _log->read_raw(config, cache)
+                    : _partition->read_raw(config, cache);
+    }
+
     cluster::partition_probe& probe() { return _partition->probe(); }
 
     model::offset high_watermark() const {
@@ -465,12 +488,24 @@ struct read_result {
       , last_stable_offset(lso)
       , error(error_code::none) {}
 
+    read_result(
+      ss::foreign_ptr<std::unique_ptr<storage::raw_read_result>> raw,
+      model::offset hw,
+      model::offset lso)
+      : raw(std::move(raw))
+      , high_watermark(hw)
+      , last_stable_offset(lso)
+      , error(error_code::none) {}
+
     read_result(model::offset hw, model::offset lso)
       : high_watermark(hw)
       , last_stable_offset(lso)
       , error(error_code::none) {}
 
     std::optional<model::record_batch_reader> reader;
+    /// set instead of the reader for raw reads
+    std::optional<ss::foreign_ptr<std::unique_ptr<storage::raw_read_result>>>
+      raw;
     model::offset high_watermark;
     model::offset last_stable_offset;
     error_code error;
@@ -31,7 +31,8 @@ public:
     static constexpr const char* name = "find coordinator";
     static constexpr api_key key = api_key(10);
     static constexpr api_version min_supported = api_version(0);
-    static constexpr api_version max_supported = api_version(2);
+    static constexpr api_version max_supported = api_version(3);
+    static constexpr api_version min_flexible = api_version(3);
 
     static ss::future<response_ptr>
     process(request_context&&, ss::smp_service_group);
@@ -27,7 +27,8 @@ struct heartbeat_api final {
     static constexpr const char* name = "heartbeat";
     static constexpr api_key key = api_key(12);
     static constexpr api_version min_supported = api_version(0);
-    static constexpr api_version max_supported = api_version(3);
+    static constexpr api_version max_supported = api_version(4);
+    static constexpr api_version min_flexible = api_version(4);
 
     static ss::future<response_ptr>
     process(request_context&&, ss::smp_service_group);
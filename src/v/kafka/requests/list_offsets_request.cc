@@ -75,7 +75,7 @@ static ss::future<list_offset_partition_response> list_offsets_partition(
       model::get_source_topic(topic.name),
       part.partition_index);
 
-    auto shard = octx.rctx.shards().shard_for(ntp);
+    auto shard = octx.rctx.shard_for(ntp);
     if (!shard) {
         return ss::make_ready_future<list_offset_partition_response>(
           list_offsets_response::make_partition(
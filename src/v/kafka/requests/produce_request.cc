@@ -15,6 +15,7 @@
 #include "cluster/partition_manager.h"
 #include "kafka/errors.h"
 #include "kafka/requests/kafka_batch_adapter.h"
+#include "kafka/requests/request_reader.h"
 #include "kafka/requests/response_writer_utils.h"
 #include "likely.h"
 #include "model/fundamental.h"
@@ -29,6 +30,7 @@
 
 #include <seastar/core/execution_stage.hh>
 #include <seastar/core/future.hh>
+#include <seastar/core/thread.hh>
 #include <seastar/util/log.hh>
 
 #include <fmt/ostream.h>
@@ -297,7 +299,7 @@ static ss::future<produce_response::partition> produce_topic_partition(
      * A single produce request may contain record batches for many
      * different partitions that are managed different cores.
      */
-    auto shard = octx.rctx.shards().shard_for(ntp);
+    auto shard = octx.rctx.shard_for(ntp);
 
     if (!shard) {
         return ss::make_ready_future<produce_response::partition>(
@@ -352,51 +354,46 @@ static ss::future<produce_response::partition> produce_topic_partition(
 }
 
 /**
- * \brief Dispatch and collect topic partition produce responses
+ * \brief Validate and dispatch the batch of a single partition
  */
-static ss::future<produce_response::topic>
-produce_topic(produce_ctx& octx, produce_request::topic& topic) {
-    std::vector<ss::future<produce_response::partition>> partitions;
-    partitions.reserve(topic.partitions.size());
-
-    for (auto& part : topic.partitions) {
-        if (!octx.rctx.metadata_cache().contains(
-              model::topic_namespace_view(cluster::kafka_namespace, topic.name),
-              part.id)) {
-            partitions.push_back(
-              ss::make_ready_future<produce_response::partition>(
-                produce_response::partition{
-                  .id = part.id,
-                  .error = error_code::unknown_topic_or_partition}));
-            continue;
-        }
-
-        if (unlikely(!part.adapter.valid_crc)) {
-            partitions.push_back(
-              ss::make_ready_future<produce_response::partition>(
-                produce_response::partition{
-                  .id = part.id, .error = error_code::corrupt_message}));
-            continue;
-        }
+static ss::future<produce_response::partition> produce_partition(
+  produce_ctx& octx,
+  produce_request::topic& topic,
+  produce_request::partition& part) {
+    if (!octx.rctx.metadata_cache().contains(
+          model::topic_namespace_view(cluster::kafka_namespace, topic.name),
+          part.id)) {
+        return ss::make_ready_future<produce_response::partition>(
+          produce_response::partition{
+            .id = part.id, .error = error_code::unknown_topic_or_partition});
+    }
 
-        // produce version >= 3 (enforced for all produce requests)
-        // requires exactly one record batch per request and it must use
-        // the v2 format.
-        if (unlikely(!part.adapter.v2_format || !part.adapter.batch)) {
-            partitions.push_back(
-              ss::make_ready_future<produce_response::partition>(
-                produce_response::partition{
-                  .id = part.id, .error = error_code::invalid_record}));
-            continue;
-        }
+    if (unlikely(!part.adapter.valid_crc)) {
+        return ss::make_ready_future<produce_response::partition>(
+          produce_response::partition{
+            .id = part.id, .error = error_code::corrupt_message});
+    }
 
-        auto pr = produce_topic_partition(octx, topic, part);
-        partitions.push_back(std::move(pr));
+    // produce version >= 3 (enforced for all produce requests)
+    // requires exactly one record batch per request and it must use
+    // the v2 format.
+    if (unlikely(!part.adapter.v2_format || !part.adapter.batch)) {
+        return ss::make_ready_future<produce_response::partition>(
+          produce_response::partition{
+            .id = part.id, .error = error_code::invalid_record});
     }
 
-    // collect partition responses and build the topic response
+    return produce_topic_partition(octx, topic, part);
+}
+
+/**
+ * \brief Collect topic partition produce responses
+ */
+static ss::future<produce_response::topic> collect_topic(
+  model::topic name,
+  std::vector<ss::future<produce_response::partition>> partitions) {
     return when_all_succeed(partitions.begin(), partitions.end())
-      .then([name = std::move(topic.name)](
+      .then([name = std::move(name)](
               std::vector<produce_response::partition> parts) mutable {
           return produce_response::topic{
             .name = std::move(name),
@@ -405,6 +402,21 @@ produce_topic(produce_ctx& octx, produce_request::topic& topic) {
       });
 }
 
+/**
+ * \brief Dispatch and collect topic partition produce responses
+ */
+static ss::future<produce_response::topic>
+produce_topic(produce_ctx& octx, produce_request::topic& topic) {
+    std::vector<ss::future<produce_response::partition>> partitions;
+    partitions.reserve(topic.partitions.size());
+
+    for (auto& part : topic.partitions) {
+        partitions.push_back(produce_partition(octx, topic, part));
+    }
+
+    return collect_topic(std::move(topic.name), std::move(partitions));
+}
+
 /**
  * \brief Dispatch and collect topic produce responses
  */
@@ -421,6 +433,51 @@ produce_topics(produce_ctx& octx) {
     return topics;
 }
 
+/**
+ * \brief Respond once every partition was produced
+ */
+static ss::future<response_ptr> send_response(produce_ctx& octx) {
+    // send response immediately
+    if (octx.request.acks != 0) {
+        return octx.rctx.respond(std::move(octx.response));
+    }
+
+    // acks = 0 is handled separately. first, check for
+    // errors
+    bool has_error = false;
+    for (const auto& topic : octx.response.topics) {
+        for (const auto& p : topic.partitions) {
+            if (p.error != error_code::none) {
+                has_error = true;
+                break;
+            }
+        }
+    }
+
+    // in the absense of errors, acks = 0 results in the
+    // response being dropped, as the client does not expect
+    // a response. here we mark the response as noop, but
+    // let it flow back so that it can be accounted for in
+    // quota and stats tracking. it is dropped later during
+    // processing.
+    if (!has_error) {
+        return octx.rctx.respond(std::move(octx.response))
+          .then([](response_ptr resp) {
+              resp->mark_noop();
+              return resp;
+          });
+    }
+
+    // errors in a response from an acks=0 produce request
+    // result in the connection being dropped to signal an
+    // issue to the client
+    return ss::make_exception_future<response_ptr>(
+      std::runtime_error(fmt::format(
+        "Closing connection due to error in produce "
+        "response: {}",
+        octx.response)));
+}
+
 ss::future<response_ptr>
 produce_api::process(request_context&& ctx, ss::smp_service_group ssg) {
     produce_request request(ctx);
@@ -468,47 +525,213 @@ produce_api::process(request_context&& ctx, ss::smp_service_group ssg) {
             .then([&octx](std::vector<produce_response::topic> topics) {
                 octx.response.topics = std::move(topics);
             })
-            .then([&octx] {
-                // send response immediately
-                if (octx.request.acks != 0) {
-                    return octx.rctx.respond(std::move(octx.response));
-                }
+            .then([&octx] { return send_response(octx); });
+      });
+}
 
-                // acks = 0 is handled separately. first, check for
-                // errors
-                bool has_error = false;
-                for (const auto& topic : octx.response.topics) {
-                    for (const auto& p : topic.partitions) {
-                        if (p.error != error_code::none) {
-                            has_error = true;
-                            break;
-                        }
-                    }
-                }
+namespace {
+
+/**
+ * Reads the fields of a request body from a connection as they arrive. Reads
+ * block the calling seastar thread and never go past the end of the body.
+ */
+class body_stream {
+public:
+    body_stream(ss::input_stream<char>& in, size_t size) noexcept
+      : _in(in)
+      , _remaining(size) {}
+
+    size_t remaining() const { return _remaining; }
+
+    iobuf read(size_t n) {
+        if (n > _remaining) {
+            throw std::out_of_range(fmt::format(
+              "read of {} bytes past the end of a produce request with {} "
+              "bytes left",
+              n,
+              _remaining));
+        }
+        auto buf = read_iobuf_exactly(_in, n).get0();
+        if (buf.size_bytes() != n) {
+            throw std::runtime_error(
+              "connection closed while reading a produce request");
+        }
+        _remaining -= n;
+        return buf;
+    }
+
+    int16_t read_int16() {
+        return request_reader(read(sizeof(int16_t))).read_int16();
+    }
+    int32_t read_int32() {
+        return request_reader(read(sizeof(int32_t))).read_int32();
+    }
+
+    ss::sstring read_string() {
+        auto n = read_int16();
+        if (n < 0) {
+            throw std::out_of_range(
+              fmt::format("invalid string length {} in produce request", n));
+        }
+        iobuf_parser parser(read(n));
+        return parser.read_string(n);
+    }
+
+    std::optional<ss::sstring> read_nullable_string() {
+        auto n = read_int16();
+        if (n < 0) {
+            return std::nullopt;
+        }
+        iobuf_parser parser(read(n));
+        return parser.read_string(n);
+    }
+
+    std::optional<iobuf> read_nullable_bytes() {
+        auto n = read_int32();
+        if (n < 0) {
+            return std::nullopt;
+        }
+        return read(n);
+    }
+
+    /// array lengths are bounded by the smallest size of an element, so that
+    /// a corrupt length is caught before reserving space for it
+    int32_t read_array_size(size_t min_element_size) {
+        auto n = read_int32();
+        if (n > 0 && size_t(n) * min_element_size > _remaining) {
+            throw std::out_of_range(fmt::format(
+              "array of {} elements does not fit in the {} bytes left of a "
+              "produce request",
+              n,
+              _remaining));
+        }
+        return std::max(n, 0);
+    }
+
+private:
+    ss::input_stream<char>& _in;
+    size_t _remaining;
+};
 
-                // in the absense of errors, acks = 0 results in the
-                // response being dropped, as the client does not expect
-                // a response. here we mark the response as noop, but
-                // let it flow back so that it can be accounted for in
-                // quota and stats tracking. it is dropped later during
-                // processing.
-                if (!has_error) {
-                    return octx.rctx.respond(std::move(octx.response))
-                      .then([](response_ptr resp) {
-                          resp->mark_noop();
-                          return resp;
-                      });
+using dispatched_topics
+  = std::vector<std::vector<ss::future<produce_response::partition>>>;
+
+/*
+ * Runs in a seastar thread. Topics and partitions are reserved up front so
+ * that dispatched partitions keep referring to the same elements.
+ */
+void decode_and_dispatch(
+  produce_ctx& octx, body_stream& body, dispatched_topics& dispatched) {
+    auto& request = octx.request;
+    request.transactional_id = body.read_nullable_string();
+    request.acks = body.read_int16();
+    request.timeout = std::chrono::milliseconds(body.read_int32());
+
+    const bool valid_acks = request.acks >= -1 && request.acks <= 1;
+    if (!valid_acks) {
+        klog.error(
+          "unsupported acks {} see "
+          "https://docs.confluent.io/current/installation/"
+          "configuration/"
+          "producer-configs.html",
+          request.acks);
+    }
+
+    // topic name length and partition count
+    const auto topics = body.read_array_size(2 + 4);
+    request.topics.reserve(topics);
+    dispatched.reserve(topics);
+    for (int32_t i = 0; i < topics; ++i) {
+        auto& topic = request.topics.emplace_back(
+          produce_request::topic{.name = model::topic(body.read_string())});
+        auto& parts = dispatched.emplace_back();
+        // partition id and batch size
+        const auto partitions = body.read_array_size(4 + 4);
+        topic.partitions.reserve(partitions);
+        parts.reserve(partitions);
+        for (int32_t j = 0; j < partitions; ++j) {
+            auto& part = topic.partitions.emplace_back(
+              produce_request::partition{
+                .id = model::partition_id(body.read_int32()),
+                .data = body.read_nullable_bytes(),
+              });
+            if (part.data) {
+                part.adapter.adapt(std::move(part.data.value()));
+            }
+
+            auto error = error_code::none;
+            if (!valid_acks) {
+                error = error_code::invalid_required_acks;
+            } else if (part.adapter.batch) {
+                const auto& hdr = part.adapter.batch->header();
+                if (hdr.attrs.is_transactional()) {
+                    request.has_transactional = true;
+                    error = error_code::transactional_id_authorization_failed;
+                } else if (hdr.producer_id >= 0) {
+                    request.has_idempotent = true;
+                    error = error_code::cluster_authorization_failed;
                 }
+            }
+            if (error != error_code::none) {
+                parts.push_back(
+                  ss::make_ready_future<produce_response::partition>(
+                    produce_response::partition{.id = part.id, .error = error}));
+                continue;
+            }
+            parts.push_back(produce_partition(octx, topic, part));
+        }
+    }
+    // like the buffered decode, ignore anything after the topics
+    if (body.remaining()) {
+        body.read(body.remaining());
+    }
+}
 
-                // errors in a response from an acks=0 produce request
-                // result in the connection being dropped to signal an
-                // issue to the client
-                return ss::make_exception_future<response_ptr>(
-                  std::runtime_error(fmt::format(
-                    "Closing connection due to error in produce "
-                    "response: {}",
-                    octx.response)));
-            });
+} // namespace
+
+ss::future<response_ptr> produce_api::process_streaming(
+  request_context&& ctx,
+  ss::input_stream<char>& in,
+  size_t size,
+  ss::promise<> body_read,
+  ss::smp_service_group ssg) {
+    return ss::do_with(
+      produce_ctx(
+        std::move(ctx), produce_request(std::nullopt, 0, {}), ssg),
+      std::move(body_read),
+      [&in, size](produce_ctx& octx, ss::promise<>& body_read) {
+          return ss::async([&octx, &body_read, &in, size] {
+              dispatched_topics dispatched;
+              std::exception_ptr error;
+              try {
+                  body_stream body(in, size);
+                  decode_and_dispatch(octx, body, dispatched);
+                  body_read.set_value();
+              } catch (...) {
+                  error = std::current_exception();
+                  body_read.set_exception(error);
+              }
+              vlog(klog.trace, "handling produce request {}", octx.request);
+
+              // dispatched partitions refer to the request, wait for them
+              // even if the rest of it could not be read
+              std::vector<ss::future<produce_response::topic>> topics;
+              topics.reserve(dispatched.size());
+              for (size_t i = 0; i < dispatched.size(); ++i) {
+                  topics.push_back(collect_topic(
+                    octx.request.topics[i].name, std::move(dispatched[i])));
+              }
+              auto responses
+                = when_all_succeed(topics.begin(), topics.end());
+              if (error) {
+                  responses.discard_result()
+                    .handle_exception([](const std::exception_ptr&) {})
+                    .get();
+                  std::rethrow_exception(error);
+              }
+              octx.response.topics = responses.get0();
+              return send_response(octx).get0();
+          });
       });
 }
 
@@ -20,6 +20,7 @@
 #include "seastarx.h"
 
 #include <seastar/core/future.hh>
+#include <seastar/core/iostream.hh>
 
 namespace kafka {
 
@@ -40,6 +41,22 @@ public:
 
     static ss::future<response_ptr>
     process(request_context&&, ss::smp_service_group);
+
+    /**
+     * Processes a produce request whose body of \p size bytes is still being
+     * read from \p in. Each partition is dispatched to its shard as soon as
+     * its batch has been read, overlapping the rest of the read with
+     * replication. \p body_read is resolved once the whole body was read.
+     *
+     * Batches with a producer id or a transactional attribute fail on their
+     * own since partitions read before them may already be replicating.
+     */
+    static ss::future<response_ptr> process_streaming(
+      request_context&&,
+      ss::input_stream<char>& in,
+      size_t size,
+      ss::promise<> body_read,
+      ss::smp_service_group);
 };
 
 struct produce_response;
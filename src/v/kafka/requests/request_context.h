@@ -13,6 +13,7 @@
 #include "bytes/iobuf.h"
 #include "kafka/logger.h"
 #include "kafka/requests/request_reader.h"
+#include "kafka/shard_locality.h"
 #include "kafka/types.h"
 #include "seastarx.h"
 #include "vlog.h"
@@ -20,6 +21,7 @@
 #include <seastar/core/future.hh>
 #include <seastar/core/reactor.hh>
 #include <seastar/core/sharded.hh>
+#include <seastar/core/shared_ptr.hh>
 #include <seastar/core/unaligned.hh>
 #include <seastar/util/log.hh>
 
@@ -34,6 +36,7 @@ class topics_frontend;
 
 namespace kafka {
 class coordinator_ntp_mapper;
+class fetch_session_cache;
 
 template<typename T>
 class group_router;
@@ -66,6 +69,12 @@ struct request_header {
 
 std::ostream& operator<<(std::ostream&, const request_header&);
 
+/**
+ * Whether the api version is a flexible version (KIP-482). Its request header
+ * (v2) and response header (v1) then end with tagged fields.
+ */
+bool flexible_header(api_key, api_version);
+
 class response;
 using response_ptr = ss::foreign_ptr<std::unique_ptr<response>>;
 
@@ -80,7 +89,8 @@ public:
       kafka::group_router_type& group_router,
       cluster::shard_table& shard_table,
       ss::sharded<cluster::partition_manager>& partition_manager,
-      ss::sharded<coordinator_ntp_mapper>& coordinator_mapper) noexcept
+      ss::sharded<coordinator_ntp_mapper>& coordinator_mapper,
+      ss::sharded<fetch_session_cache>& fetch_sessions) noexcept
       : _metadata_cache(&metadata_cache)
       , _topics_frontend(&topics_frontend)
       , _header(std::move(header))
@@ -89,7 +99,8 @@ public:
       , _group_router(&group_router)
       , _shard_table(&shard_table)
       , _partition_manager(&partition_manager)
-      , _coordinator_mapper(&coordinator_mapper) {
+      , _coordinator_mapper(&coordinator_mapper)
+      , _fetch_sessions(&fetch_sessions) {
         // XXX: don't forget to extend the move ctor
     }
     ~request_context() noexcept = default;
@@ -102,7 +113,9 @@ public:
       , _group_router(o._group_router)
       , _shard_table(o._shard_table)
       , _partition_manager(o._partition_manager)
-      , _coordinator_mapper(o._coordinator_mapper) {}
+      , _coordinator_mapper(o._coordinator_mapper)
+      , _fetch_sessions(o._fetch_sessions)
+      , _shard_locality(std::move(o._shard_locality)) {}
     request_context& operator=(request_context&& o) noexcept {
         if (this != &o) {
             this->~request_context();
@@ -139,6 +152,14 @@ public:
 
     cluster::shard_table& shards() { return *_shard_table; }
 
+    /// the shard owning the partition, counted towards the shard locality
+    /// of the connection
+    std::optional<ss::shard_id> shard_for(const model::ntp&);
+
+    void set_shard_locality(ss::lw_shared_ptr<shard_locality> l) {
+        _shard_locality = std::move(l);
+    }
+
     ss::sharded<cluster::partition_manager>& partition_manager() {
         return *_partition_manager;
     }
@@ -158,6 +179,10 @@ public:
           ResponseType::api_type::name,
           r);
         auto resp = std::make_unique<response>();
+        if (flexible_header(_header.key, _header.version)) {
+            // tagged fields of the response header follow the correlation id
+            resp->writer().write_tags();
+        }
         r.encode(*this, *resp.get());
         return ss::make_ready_future<response_ptr>(std::move(resp));
     }
@@ -166,6 +191,8 @@ public:
         return *_coordinator_mapper;
     }
 
+    fetch_session_cache& fetch_sessions() { return _fetch_sessions->local(); }
+
 private:
     ss::sharded<cluster::metadata_cache>* _metadata_cache;
     cluster::topics_frontend* _topics_frontend;
@@ -176,6 +203,8 @@ private:
     cluster::shard_table* _shard_table;
     ss::sharded<cluster::partition_manager>* _partition_manager;
     ss::sharded<kafka::coordinator_ntp_mapper>* _coordinator_mapper;
+    ss::sharded<fetch_session_cache>* _fetch_sessions;
+    ss::lw_shared_ptr<shard_locality> _shard_locality;
 };
 
 // Executes the API call identified by the specified request_context.
@@ -95,7 +95,85 @@ public:
         return do_read_array(len, std::forward<ElementParser>(parser));
     }
 
+    /*
+     * Flexible versions (KIP-482) encode lengths as unsigned varints of the
+     * length plus one, zero being null, and end every struct with a section
+     * of tagged fields.
+     */
+
+    uint32_t read_unsigned_varint() {
+        uint32_t value = 0;
+        for (uint32_t shift = 0; shift < 35; shift += 7) {
+            auto b = _parser.consume_type<uint8_t>();
+            value |= uint32_t(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                return value;
+            }
+        }
+        throw std::out_of_range("Unsigned varint is longer than 5 bytes");
+    }
+
+    ss::sstring read_compact_string() {
+        auto n = read_compact_length();
+        if (unlikely(n < 0)) {
+            throw std::out_of_range("Asked to read a null compact string");
+        }
+        return _parser.read_string(n);
+    }
+
+    std::optional<ss::sstring> read_compact_nullable_string() {
+        auto n = read_compact_length();
+        if (n < 0) {
+            return std::nullopt;
+        }
+        return _parser.read_string(n);
+    }
+
+    bytes read_compact_bytes() {
+        auto n = read_compact_length();
+        if (unlikely(n < 0)) {
+            throw std::out_of_range("Asked to read null compact bytes");
+        }
+        return _parser.read_bytes(n);
+    }
+
+    template<
+      typename ElementParser,
+      typename T = std::invoke_result_t<ElementParser, request_reader&>>
+    std::vector<T> read_compact_array(ElementParser&& parser) {
+        auto len = read_compact_length();
+        if (unlikely(len < 0)) {
+            throw std::out_of_range("Asked to read a null compact array");
+        }
+        return do_read_array(len, std::forward<ElementParser>(parser));
+    }
+
+    template<
+      typename ElementParser,
+      typename T = std::invoke_result_t<ElementParser, request_reader&>>
+    std::optional<std::vector<T>>
+    read_compact_nullable_array(ElementParser&& parser) {
+        auto len = read_compact_length();
+        if (len < 0) {
+            return std::nullopt;
+        }
+        return do_read_array(len, std::forward<ElementParser>(parser));
+    }
+
+    /// skips the tagged fields ending a struct, none of which are used
+    void skip_tags() {
+        auto n = read_unsigned_varint();
+        while (n-- > 0) {
+            read_unsigned_varint(); // tag
+            _parser.skip(read_unsigned_varint());
+        }
+    }
+
 private:
+    int32_t read_compact_length() {
+        return static_cast<int32_t>(read_unsigned_varint()) - 1;
+    }
+
     ss::sstring do_read_string(int16_t n) {
         if (unlikely(n < 0)) {
             /// FIXME: maybe return empty string?
@@ -9,6 +9,7 @@
 
 #include "kafka/requests/requests.h"
 
+#include "cluster/shard_table.h"
 #include "kafka/requests/alter_configs_request.h"
 #include "kafka/requests/api_versions_request.h"
 #include "kafka/requests/create_topics_request.h"
@@ -55,6 +56,10 @@ struct process_dispatch {
                 ctx.header().version,
                 Request::name)));
         }
+        if (flexible_header(ctx.header().key, ctx.header().version)) {
+            // tagged fields of the request header precede the body
+            ctx.reader().skip_tags();
+        }
         return Request::process(std::move(ctx), g);
     }
 };
@@ -137,6 +142,30 @@ process_request(request_context&& ctx, ss::smp_service_group g) {
       std::runtime_error(fmt::format("Unsupported API {}", ctx.header().key)));
 }
 
+bool flexible_header(api_key key, api_version version) {
+    switch (key) {
+    case list_groups_api::key:
+        return version >= list_groups_api::min_flexible;
+    case find_coordinator_api::key:
+        return version >= find_coordinator_api::min_flexible;
+    case heartbeat_api::key:
+        return version >= heartbeat_api::min_flexible;
+    case sync_group_api::key:
+        return version >= sync_group_api::min_flexible;
+    default:
+        // no flexible version of the other apis is supported yet
+        return false;
+    }
+}
+
+std::optional<ss::shard_id> request_context::shard_for(const model::ntp& ntp) {
+    auto shard = _shard_table->shard_for(ntp);
+    if (shard && _shard_locality) {
+        _shard_locality->record(*shard);
+    }
+    return shard;
+}
+
 std::ostream& operator<<(std::ostream& os, const request_header& header) {
     fmt::print(
       os,
@@ -26,6 +26,7 @@
 
 #include <boost/range/numeric.hpp>
 
+#include <array>
 #include <optional>
 #include <string_view>
 
@@ -117,6 +118,66 @@ public:
         return size;
     }
 
+    /*
+     * Flexible versions (KIP-482) encode lengths as unsigned varints of the
+     * length plus one, zero being null, and end every struct with a section
+     * of tagged fields.
+     */
+
+    uint32_t write_unsigned_varint(uint32_t v) {
+        std::array<char, 5> buf;
+        size_t n = 0;
+        while (v >= 0x80) {
+            buf[n++] = static_cast<char>((v & 0x7f) | 0x80);
+            v >>= 7;
+        }
+        buf[n++] = static_cast<char>(v);
+        _out->append(buf.data(), n);
+        return n;
+    }
+
+    uint32_t write_compact(std::string_view v) {
+        auto size = write_unsigned_varint(v.size() + 1) + v.size();
+        _out->append(v.data(), v.size());
+        return size;
+    }
+
+    uint32_t write_compact(const ss::sstring& v) {
+        return write_compact(std::string_view(v));
+    }
+
+    uint32_t write_compact(std::optional<std::string_view> v) {
+        if (!v) {
+            return write_unsigned_varint(0);
+        }
+        return write_compact(*v);
+    }
+
+    uint32_t write_compact(const std::optional<ss::sstring>& v) {
+        if (!v) {
+            return write_unsigned_varint(0);
+        }
+        return write_compact(std::string_view(*v));
+    }
+
+    uint32_t write_compact(bytes_view bv) {
+        auto size = write_unsigned_varint(bv.size() + 1) + bv.size();
+        _out->append(reinterpret_cast<const char*>(bv.data()), bv.size());
+        return size;
+    }
+
+    uint32_t write_compact(const model::topic& topic) {
+        return write_compact(topic());
+    }
+
+    template<typename T, typename Tag>
+    uint32_t write_compact(const named_type<T, Tag>& t) {
+        return write_compact(t());
+    }
+
+    /// an empty section of tagged fields
+    uint32_t write_tags() { return write_unsigned_varint(0); }
+
     // write bytes directly to output without a length prefix
     uint32_t write_direct(iobuf&& f) {
         auto size = f.size_bytes();
@@ -181,6 +242,38 @@ public:
         return write_array(*v, std::forward<ElementWriter>(writer));
     }
 
+    // clang-format off
+    template<typename T, typename ElementWriter>
+    CONCEPT(
+          requires requires(ElementWriter writer, response_writer& rw, T& elem) {
+            { writer(elem, rw) } -> void;
+    })
+    // clang-format on
+    uint32_t
+    write_compact_array(std::vector<T>& v, ElementWriter&& writer) {
+        auto start_size = uint32_t(_out->size_bytes());
+        write_unsigned_varint(v.size() + 1);
+        for (auto& elem : v) {
+            writer(elem, *this);
+        }
+        return _out->size_bytes() - start_size;
+    }
+
+    // clang-format off
+    template<typename T, typename ElementWriter>
+    CONCEPT(
+          requires requires(ElementWriter writer, response_writer& rw, T& elem) {
+            { writer(elem, rw) } -> void;
+    })
+    // clang-format on
+    uint32_t write_compact_nullable_array(
+      std::optional<std::vector<T>>& v, ElementWriter&& writer) {
+        if (!v) {
+            return write_unsigned_varint(0);
+        }
+        return write_compact_array(*v, std::forward<ElementWriter>(writer));
+    }
+
     // wrap a writer in a kafka bytes array object. the writer should return
     // true if writing no bytes should result in the encoding as nullable bytes,
     // and false otherwise.
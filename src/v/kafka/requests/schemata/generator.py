@@ -21,12 +21,9 @@
 #   path_type_map to override types, it would be more efficient to specify the
 #   same mapping using the field_name_type_map + a whitelist of request types.
 #
-#   - The current version does not handle flexible versions. It will be some
-#   time before we encounter clients requiring this, but in principle this
-#   generator should be extensible (see type maps below). Note that when the
-#   time comes to support flexible versions, there is a filter in the templates
-#   within this file that ignores such fields, and that filter should be
-#   removed.
+#   - Tagged fields of flexible versions are skipped when decoding and never
+#   written when encoding, which is valid since tagged fields are optional.
+#   None of the fields we serve are tagged.
 #
 #   - Handle ignorable fields. Currently we handle nullable fields properly. The
 #   ignorable flag on a field doesn't change the wire protocol, but gives
@@ -205,6 +202,16 @@ basic_type_map = dict(
     int64=("int64_t", "read_int64()"),
 )
 
+# decoders of length prefixed types in flexible versions, whose lengths are
+# unsigned varints (KIP-482)
+compact_decoders = {
+    "read_string()": "read_compact_string()",
+    "read_nullable_string()": "read_compact_nullable_string()",
+    "read_bytes()": "read_compact_bytes()",
+}
+
+COMPACT_TYPES = ["string", "bytes"]
+
 # a listing of expected struct types
 STRUCT_TYPES = [
     "ApiVersionsRequestKey",
@@ -518,10 +525,37 @@ class Field:
             return plain_decoder[2], named_type
         return plain_decoder[1], named_type
 
+    @property
+    def compact_decoder(self):
+        """
+        The decoder of the field in flexible versions, see decoder.
+        """
+        decoder, named_type = self.decoder
+        return compact_decoders.get(decoder, decoder), named_type
+
     @property
     def is_array(self):
         return isinstance(self._type, ArrayType)
 
+    @property
+    def is_tagged(self):
+        return "tag" in self._field
+
+    @property
+    def is_compact(self):
+        """
+        True if the encoding of the field differs in flexible versions.
+        """
+        return self.is_array or self._type.name in COMPACT_TYPES
+
+    @property
+    def is_compact_element(self):
+        """
+        True if array elements are encoded differently in flexible versions.
+        """
+        assert self.is_array
+        return self._type.value_type().name in COMPACT_TYPES
+
     @property
     def type_name(self):
         name, default_value = self._redpanda_type()
@@ -622,47 +656,82 @@ if ({{ cond }}) {
 {%- endif %}
 {%- endmacro %}
 
-{% macro field_encoder(field, obj) %}
+{#- lambdas of array elements capture what the field serde depends on #}
+{%- if flexible %}
+{%- set captures = "version, flexible" %}
+{%- else %}
+{%- set captures = "version" %}
+{%- endif %}
+
+{#- fields whose encoding differs in flexible versions pick one at runtime #}
+{% macro flexible_guard(field, field_serde, obj) %}
+{%- if flexible and field.is_compact %}
+if (flexible) {
+{{- field_serde(field, obj, True) | indent }}
+} else {
+{{- field_serde(field, obj, False) | indent }}
+}
+{%- else %}
+{{- field_serde(field, obj, False) }}
+{%- endif %}
+{%- endmacro %}
+
+{% macro field_encoder(field, obj, compact) %}
 {%- if obj %}
 {%- set fname = obj + "." + field.name %}
 {%- else %}
 {%- set fname = field.name %}
 {%- endif %}
+{%- if compact %}
+{%- set prefix = "write_compact" %}
+{%- else %}
+{%- set prefix = "write" %}
+{%- endif %}
 {%- if field.is_array %}
 {%- if field.nullable() %}
-writer.write_nullable_array({{ fname }}, [version]({{ field.value_type }}& v, response_writer& writer) {
+{%- set array_writer = prefix + "_nullable_array" %}
+{%- elif compact %}
+{%- set array_writer = "write_compact_array" %}
 {%- else %}
-writer.write_array({{ fname }}, [version]({{ field.value_type }}& v, response_writer& writer) {
+{%- set array_writer = "write_array" %}
 {%- endif %}
+writer.{{ array_writer }}({{ fname }}, [{{ captures }}]({{ field.value_type }}& v, response_writer& writer) {
 {%- if field.type().value_type().is_struct %}
 {{- struct_serde(field.type().value_type(), field_encoder, "v") | indent }}
+{%- elif compact and field.is_compact_element %}
+    writer.write_compact(v);
 {%- else %}
     writer.write(v);
 {%- endif %}
 });
 {%- else %}
-writer.write({{ fname }});
+writer.{{ prefix }}({{ fname }});
 {%- endif %}
 {%- endmacro %}
 
-{% macro field_decoder(field, obj) %}
+{% macro field_decoder(field, obj, compact) %}
 {%- if obj %}
 {%- set fname = obj + "." + field.name %}
 {%- else %}
 {%- set fname = field.name %}
 {%- endif %}
 {%- if field.is_array %}
-{%- if field.nullable() %}
-{{ fname }} = reader.read_nullable_array([version](request_reader& reader) {
+{%- if field.nullable() and compact %}
+{%- set array_reader = "read_compact_nullable_array" %}
+{%- elif field.nullable() %}
+{%- set array_reader = "read_nullable_array" %}
+{%- elif compact %}
+{%- set array_reader = "read_compact_array" %}
 {%- else %}
-{{ fname }} = reader.read_array([version](request_reader& reader) {
+{%- set array_reader = "read_array" %}
 {%- endif %}
+{{ fname }} = reader.{{ array_reader }}([{{ captures }}](request_reader& reader) {
 {%- if field.type().value_type().is_struct %}
     {{ field.type().value_type().name }} v;
 {{- struct_serde(field.type().value_type(), field_decoder, "v") | indent }}
     return v;
 {%- else %}
-{%- set decoder, named_type = field.decoder %}
+{%- set decoder, named_type = field_decoder_of(field, compact) %}
 {%- if named_type == None %}
     return reader.{{ decoder }};
 {%- elif field.nullable() %}
@@ -679,7 +748,7 @@ writer.write({{ fname }});
 {%- endif %}
 });
 {%- else %}
-{%- set decoder, named_type = field.decoder %}
+{%- set decoder, named_type = field_decoder_of(field, compact) %}
 {%- if named_type == None %}
 {{ fname }} = reader.{{ decoder }};
 {%- elif field.nullable() %}
@@ -695,28 +764,49 @@ writer.write({{ fname }});
 {%- endif %}
 {%- endmacro %}
 
+{#- tagged fields only exist in flexible versions, see the note on top #}
 {% macro struct_serde(struct, field_serde, obj = "") %}
-{%- for field in struct.fields %}
+{%- for field in struct.fields if not field.is_tagged %}
 {%- call version_guard(field) %}
-{{- field_serde(field, obj) }}
+{{- flexible_guard(field, field_serde, obj) }}
 {%- endcall %}
 {%- endfor %}
+{%- if flexible %}
+{%- if field_serde == field_encoder %}
+if (flexible) {
+    writer.write_tags();
+}
+{%- else %}
+if (flexible) {
+    reader.skip_tags();
+}
+{%- endif %}
+{%- endif %}
+{%- endmacro %}
+
+{%- macro flexible_version() %}
+{%- if flexible %}
+    const bool flexible = {{ flexible.guard() }};
+{%- endif %}
 {%- endmacro %}
 
 namespace kafka {
 
 {%- if struct.fields %}
 void {{ struct.name }}::encode(response_writer& writer, [[maybe_unused]] api_version version) {
+{{- flexible_version() }}
 {{- struct_serde(struct, field_encoder) | indent }}
 }
 
 {%- if op_type == "request" %}
 void {{ struct.name }}::decode(request_reader& reader, [[maybe_unused]] api_version version) {
+{{- flexible_version() }}
 {{- struct_serde(struct, field_decoder) | indent }}
 }
 {%- else %}
 void {{ struct.name }}::decode(iobuf buf, api_version version) {
     request_reader reader(std::move(buf));
+{{- flexible_version() }}
 
 {{- struct_serde(struct, field_decoder) | indent }}
 }
@@ -856,6 +946,11 @@ SCHEMA = {
 # yapf: enable
 
 
+# helper called from template to pick the decoder of a field
+def field_decoder_of(field, compact):
+    return field.compact_decoder if compact else field.decoder
+
+
 # helper called from template to render a nice struct comment
 def render_struct_comment(struct):
     indent = " * "
@@ -910,6 +1005,11 @@ if __name__ == "__main__":
     # request or response
     op_type = msg["type"]
 
+    # versions using compact lengths and tagged fields
+    flexible = None
+    if msg["flexibleVersions"] != "none":
+        flexible = VersionRange(msg["flexibleVersions"])
+
     with open(hdr, 'w') as f:
         f.write(
             jinja2.Template(HEADER_TEMPLATE).render(
@@ -921,4 +1021,6 @@ if __name__ == "__main__":
         f.write(
             jinja2.Template(SOURCE_TEMPLATE).render(struct=struct,
                                                     header=hdr.name,
-                                                    op_type=op_type))
+                                                    op_type=op_type,
+                                                    flexible=flexible,
+                                                    field_decoder_of=field_decoder_of))
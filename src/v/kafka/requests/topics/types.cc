@@ -53,6 +53,17 @@ static std::optional<T> get_config_value(
     return std::nullopt;
 }
 
+// "producer" keeps batches in the codec they were produced in, any other
+// codec is enforced by recompressing the batches of closed segments
+static std::optional<model::compression> get_compression_value(
+  const absl::flat_hash_map<ss::sstring, ss::sstring>& config) {
+    if (auto it = config.find("compression.type");
+        it != config.end() && it->second == "producer") {
+        return std::nullopt;
+    }
+    return get_config_value<model::compression>(config, "compression.type");
+}
+
 // Special case for options where Kafka allows -1
 // In redpanda the mapping is following
 //
@@ -78,8 +89,7 @@ cluster::topic_configuration to_cluster_type(const creatable_topic& t) {
 
     auto config_entries = config_map(t.configs);
     // Parse topic configuration
-    cfg.compression = get_config_value<model::compression>(
-      config_entries, "compression.type");
+    cfg.compression = get_compression_value(config_entries);
     cfg.cleanup_policy_bitflags
       = get_config_value<model::cleanup_policy_bitflags>(
         config_entries, "cleanup.policy");
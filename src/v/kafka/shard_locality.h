@@ -0,0 +1,77 @@
+/*
+ * Copyright 2020 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+#include "seastarx.h"
+
+#include <seastar/core/smp.hh>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace kafka {
+
+/**
+ * Counts the partitions requests touch by the shard owning them. A partition
+ * owned by another shard than the one serving the connection costs a hop to
+ * that shard. Counts of a connection are also added to the counts of its
+ * server, if any.
+ */
+class shard_locality {
+public:
+    explicit shard_locality(shard_locality* totals = nullptr)
+      : _totals(totals)
+      , _partitions(ss::smp::count, 0) {}
+
+    void record(ss::shard_id shard) {
+        ++_partitions[shard];
+        if (shard == ss::this_shard_id()) {
+            ++_local;
+        } else {
+            ++_remote;
+        }
+        if (_totals) {
+            _totals->record(shard);
+        }
+    }
+
+    uint64_t local() const { return _local; }
+    uint64_t remote() const { return _remote; }
+
+    /// fraction of the partitions that were owned by another shard
+    double hop_ratio() const {
+        const auto total = _local + _remote;
+        return total ? static_cast<double>(_remote) / total : 0;
+    }
+
+    /// the shard owning most of the partitions
+    ss::shard_id preferred_shard() const {
+        return std::distance(
+          _partitions.begin(),
+          std::max_element(_partitions.begin(), _partitions.end()));
+    }
+
+    /// whether a single other shard owns more than half of the partitions
+    bool mostly_owned_by_other_shard() const {
+        const auto preferred = preferred_shard();
+        return preferred != ss::this_shard_id()
+               && _partitions[preferred] > (_local + _remote) / 2;
+    }
+
+private:
+    shard_locality* _totals;
+    std::vector<uint64_t> _partitions;
+    uint64_t _local{0};
+    uint64_t _remote{0};
+};
+
+} // namespace kafka
@@ -0,0 +1,78 @@
+// Copyright 2020 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "kafka/requests/list_groups_request.h"
+#include "kafka/requests/response_writer.h"
+#include "random/generators.h"
+
+#include <seastar/testing/perf_tests.hh>
+
+static constexpr size_t groups = 1000;
+// list groups v3 is the first flexible version
+static constexpr auto classic_version = kafka::api_version(2);
+static constexpr auto flexible_version = kafka::api_version(3);
+
+struct codec_bench {
+    codec_bench() {
+        for (size_t i = 0; i < groups; ++i) {
+            response.groups.push_back(kafka::listed_group{
+              .group_id = kafka::group_id(
+                random_generators::gen_alphanum_string(20)),
+              .protocol_type = "consumer",
+            });
+        }
+        classic = encode(classic_version);
+        flexible = encode(flexible_version);
+    }
+
+    iobuf encode(kafka::api_version version) {
+        iobuf out;
+        kafka::response_writer writer(out);
+        response.encode(writer, version);
+        return out;
+    }
+
+    size_t decode(const iobuf& in, kafka::api_version version) {
+        kafka::list_groups_response_data data;
+        data.decode(in.share(0, in.size_bytes()), version);
+        return data.groups.size();
+    }
+
+    kafka::list_groups_response_data response;
+    iobuf classic;
+    iobuf flexible;
+};
+
+PERF_TEST_F(codec_bench, encode_classic) {
+    perf_tests::start_measuring_time();
+    auto out = encode(classic_version);
+    perf_tests::do_not_optimize(out);
+    perf_tests::stop_measuring_time();
+}
+
+PERF_TEST_F(codec_bench, encode_flexible) {
+    perf_tests::start_measuring_time();
+    auto out = encode(flexible_version);
+    perf_tests::do_not_optimize(out);
+    perf_tests::stop_measuring_time();
+}
+
+PERF_TEST_F(codec_bench, decode_classic) {
+    perf_tests::start_measuring_time();
+    auto n = decode(classic, classic_version);
+    perf_tests::do_not_optimize(n);
+    perf_tests::stop_measuring_time();
+}
+
+PERF_TEST_F(codec_bench, decode_flexible) {
+    perf_tests::start_measuring_time();
+    auto n = decode(flexible, flexible_version);
+    perf_tests::do_not_optimize(n);
+    perf_tests::stop_measuring_time();
+}
@@ -159,7 +159,8 @@ static kafka::request_context make_request_context(application& app) {
       app.group_router.local(),
       app.shard_table.local(),
       app.partition_manager,
-      app.coordinator_ntp_mapper);
+      app.coordinator_ntp_mapper,
+      app.fetch_session_cache);
 
     iobuf buf;
     kafka::fetch_request request;
@@ -176,7 +177,8 @@ static kafka::request_context make_request_context(application& app) {
       app.group_router.local(),
       app.shard_table.local(),
       app.partition_manager,
-      app.coordinator_ntp_mapper);
+      app.coordinator_ntp_mapper,
+      app.fetch_session_cache);
 }
 
 // TODO: when we have a more precise log builder tool we can make these finer
@@ -492,3 +494,150 @@ FIXTURE_TEST(fetch_one_debounce, redpanda_thread_fixture) {
     BOOST_REQUIRE(resp.partitions[0].responses[0].record_set);
     BOOST_REQUIRE(resp.partitions[0].responses[0].record_set->size_bytes() > 0);
 }
+
+static kafka::fetch_request make_session_request(
+  kafka::fetch_session_id id,
+  kafka::fetch_session_epoch epoch,
+  std::vector<model::partition_id> partitions) {
+    kafka::fetch_request req;
+    req.session_id = id();
+    req.session_epoch = epoch();
+    if (!partitions.empty()) {
+        req.topics.push_back({.name = model::topic("t0")});
+        for (auto p : partitions) {
+            req.topics.back().partitions.push_back(
+              {.id = p,
+               .fetch_offset = model::offset(p()),
+               .partition_max_bytes = 1});
+        }
+    }
+    return req;
+}
+
+SEASTAR_THREAD_TEST_CASE(fetch_session_lifecycle) {
+    kafka::fetch_session_cache cache(2);
+    const model::partition_id p0(0);
+    const model::partition_id p1(1);
+
+    // a full fetch starts a new session
+    auto req = make_session_request(
+      kafka::invalid_fetch_session_id,
+      kafka::initial_fetch_session_epoch,
+      {p0, p1});
+    auto ctx = cache.maybe_get_session(req);
+    BOOST_REQUIRE(ctx.session);
+    BOOST_REQUIRE(!ctx.incremental);
+    BOOST_REQUIRE(!ctx.has_error());
+    BOOST_REQUIRE_EQUAL(ctx.session->partitions().size(), 2);
+    BOOST_REQUIRE_EQUAL(cache.size(), 1);
+    const auto id = ctx.session->id();
+
+    // an incremental fetch only carries the changed partition, but fetches
+    // all of the session partitions
+    req = make_session_request(id, kafka::fetch_session_epoch(1), {p1});
+    ctx = cache.maybe_get_session(req);
+    BOOST_REQUIRE(ctx.incremental);
+    BOOST_REQUIRE_EQUAL(req.topics.size(), 1);
+    BOOST_REQUIRE_EQUAL(req.topics[0].partitions.size(), 2);
+
+    // forgotten topics leave the session
+    req = make_session_request(id, kafka::fetch_session_epoch(2), {});
+    req.forgotten_topics.push_back(
+      {.name = model::topic("t0"), .partitions = {0}});
+    ctx = cache.maybe_get_session(req);
+    BOOST_REQUIRE_EQUAL(ctx.session->partitions().size(), 1);
+    BOOST_REQUIRE_EQUAL(req.topics[0].partitions.size(), 1);
+    BOOST_REQUIRE_EQUAL(req.topics[0].partitions[0].id, p1);
+
+    // replays of an epoch and unknown sessions are rejected
+    req = make_session_request(id, kafka::fetch_session_epoch(2), {});
+    ctx = cache.maybe_get_session(req);
+    BOOST_REQUIRE_EQUAL(
+      ctx.error, kafka::error_code::invalid_fetch_session_epoch);
+    req = make_session_request(
+      kafka::fetch_session_id(id() == 1 ? 2 : 1),
+      kafka::fetch_session_epoch(1),
+      {});
+    ctx = cache.maybe_get_session(req);
+    BOOST_REQUIRE_EQUAL(
+      ctx.error, kafka::error_code::fetch_session_id_not_found);
+
+    // the final epoch closes the session
+    req = make_session_request(id, kafka::final_fetch_session_epoch, {p0});
+    ctx = cache.maybe_get_session(req);
+    BOOST_REQUIRE(!ctx.session);
+    BOOST_REQUIRE_EQUAL(cache.size(), 0);
+}
+
+SEASTAR_THREAD_TEST_CASE(fetch_session_eviction) {
+    kafka::fetch_session_cache cache(2);
+    auto new_session = [&cache] {
+        auto req = make_session_request(
+          kafka::invalid_fetch_session_id,
+          kafka::initial_fetch_session_epoch,
+          {model::partition_id(0)});
+        return cache.maybe_get_session(req).session->id();
+    };
+    auto s0 = new_session();
+    auto s1 = new_session();
+    // touch s0 so that s1 is the least recently used
+    auto req = make_session_request(s0, kafka::fetch_session_epoch(1), {});
+    BOOST_REQUIRE(!cache.maybe_get_session(req).has_error());
+
+    new_session();
+    BOOST_REQUIRE_EQUAL(cache.size(), 2);
+    BOOST_REQUIRE_EQUAL(cache.evictions(), 1);
+    req = make_session_request(s1, kafka::fetch_session_epoch(1), {});
+    BOOST_REQUIRE_EQUAL(
+      cache.maybe_get_session(req).error,
+      kafka::error_code::fetch_session_id_not_found);
+    req = make_session_request(s0, kafka::fetch_session_epoch(2), {});
+    BOOST_REQUIRE(!cache.maybe_get_session(req).has_error());
+}
+
+SEASTAR_THREAD_TEST_CASE(fetch_session_omits_unchanged_partitions) {
+    kafka::fetch_session_cache cache(1);
+    auto make_response = [](model::offset hw0, model::offset hw1) {
+        kafka::fetch_response resp;
+        resp.partitions.emplace_back(model::topic("t0"));
+        for (auto [id, hw] : {std::pair{0, hw0}, std::pair{1, hw1}}) {
+            resp.partitions.back().responses.push_back(
+              kafka::fetch_response::partition_response{
+                .id = model::partition_id(id),
+                .error = kafka::error_code::none,
+                .high_watermark = hw,
+                .last_stable_offset = hw,
+                .record_set = iobuf()});
+        }
+        return resp;
+    };
+
+    auto req = make_session_request(
+      kafka::invalid_fetch_session_id,
+      kafka::initial_fetch_session_epoch,
+      {model::partition_id(0), model::partition_id(1)});
+    auto ctx = cache.maybe_get_session(req);
+    // full responses are never trimmed
+    auto resp = make_response(model::offset(10), model::offset(10));
+    cache.update_session(ctx, resp);
+    BOOST_REQUIRE_EQUAL(resp.partitions[0].responses.size(), 2);
+
+    // only the partition whose high watermark moved is reported
+    req = make_session_request(
+      ctx.session->id(), kafka::fetch_session_epoch(1), {});
+    ctx = cache.maybe_get_session(req);
+    resp = make_response(model::offset(10), model::offset(11));
+    cache.update_session(ctx, resp);
+    BOOST_REQUIRE_EQUAL(resp.partitions.size(), 1);
+    BOOST_REQUIRE_EQUAL(resp.partitions[0].responses.size(), 1);
+    BOOST_REQUIRE_EQUAL(
+      resp.partitions[0].responses[0].id, model::partition_id(1));
+
+    // nothing changed, nothing reported
+    req = make_session_request(
+      ctx.session->id(), kafka::fetch_session_epoch(2), {});
+    ctx = cache.maybe_get_session(req);
+    resp = make_response(model::offset(10), model::offset(11));
+    cache.update_session(ctx, resp);
+    BOOST_REQUIRE(resp.partitions.empty());
+}
@@ -49,3 +49,20 @@ FIXTURE_TEST(find_coordinator, redpanda_thread_fixture) {
     BOOST_TEST(resp.data.host == "127.0.0.1");
     BOOST_TEST(resp.data.port == 9092);
 }
+
+FIXTURE_TEST(find_coordinator_flexible_version, redpanda_thread_fixture) {
+    wait_for_controller_leadership().get();
+
+    auto client = make_kafka_client().get0();
+    client.connect().get();
+
+    kafka::find_coordinator_request req("key");
+
+    auto resp = client.dispatch(req, kafka::api_version(3)).get0();
+    client.stop().then([&client] { client.shutdown(); }).get();
+
+    BOOST_TEST(resp.data.error_code == kafka::error_code::none);
+    BOOST_TEST(resp.data.node_id == model::node_id(1));
+    BOOST_TEST(resp.data.host == "127.0.0.1");
+    BOOST_TEST(resp.data.port == 9092);
+}
@@ -0,0 +1,104 @@
+// Copyright 2020 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "kafka/client.h"
+#include "kafka/requests/api_versions_request.h"
+#include "kafka/requests/response_writer.h"
+#include "redpanda/tests/fixture.h"
+#include "test_utils/fixture.h"
+
+#include <seastar/core/with_timeout.hh>
+
+using namespace std::chrono_literals;
+
+// a single in-flight request per connection, so that a second pipelined
+// request waits for the unit of the first one
+struct single_inflight_config {
+    single_inflight_config()
+      : prev(config::shard_local_cfg()
+               .kafka_max_inflight_requests_per_connection()) {
+        set(1);
+    }
+    ~single_inflight_config() { set(prev); }
+
+    static void set(size_t v) {
+        ss::smp::invoke_on_all([v] {
+            config::shard_local_cfg()
+              .get("kafka_max_inflight_requests_per_connection")
+              .set_value(v);
+        }).get0();
+    }
+
+    size_t prev;
+};
+
+struct inflight_fixture
+  : single_inflight_config
+  , redpanda_thread_fixture {};
+
+// writes requests without waiting for their responses
+class pipelining_client : public kafka::client {
+public:
+    using kafka::client::client;
+
+    ss::future<> write_requests(
+      std::vector<std::pair<kafka::api_key, kafka::api_version>> headers) {
+        iobuf buf;
+        for (auto& [key, version] : headers) {
+            // header only, the requests have empty bodies
+            iobuf req;
+            kafka::response_writer wr(req);
+            wr.write(int16_t(key()));
+            wr.write(int16_t(version()));
+            wr.write(int32_t(0));
+            wr.write(std::string_view("test_client"));
+            int32_t size = ss::cpu_to_be(int32_t(req.size_bytes()));
+            buf.append(reinterpret_cast<const char*>(&size), sizeof(size));
+            buf.append(std::move(req));
+        }
+        return _out.write(iobuf_as_scattered(std::move(buf)));
+    }
+
+    /// resolves once the server closed the connection
+    ss::future<> wait_for_eof() {
+        return ss::repeat([this] {
+            return _in.read().then([](ss::temporary_buffer<char> b) {
+                return b.empty() ? ss::stop_iteration::yes
+                                 : ss::stop_iteration::no;
+            });
+        });
+    }
+};
+
+FIXTURE_TEST(failed_request_wakes_inflight_waiter, inflight_fixture) {
+    wait_for_controller_leadership().get0();
+    auto client = config::shard_local_cfg()
+                    .kafka_api()
+                    .resolve()
+                    .then([](ss::socket_address addr) {
+                        return pipelining_client(
+                          rpc::base_transport::configuration{
+                            .server_addr = addr,
+                          });
+                    })
+                    .get0();
+    client.connect().get0();
+    auto deferred = ss::defer([&client] { client.stop().get0(); });
+
+    // the unsupported api fails while the api versions request waits for
+    // its in-flight unit. the connection must still be closed, otherwise
+    // the server would never finish stopping
+    client
+      .write_requests(
+        {{kafka::api_key(1000), kafka::api_version(0)},
+         {kafka::api_versions_api::key, kafka::api_version(0)}})
+      .get0();
+    ss::with_timeout(model::timeout_clock::now() + 10s, client.wait_for_eof())
+      .get0();
+}
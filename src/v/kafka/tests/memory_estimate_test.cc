@@ -0,0 +1,60 @@
+// Copyright 2020 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#define BOOST_TEST_MODULE memory_estimate
+#include "bytes/iobuf.h"
+#include "kafka/protocol_utils.h"
+#include "kafka/requests/fetch_request.h"
+#include "units.h"
+
+#include <seastar/core/byteorder.hh>
+
+#include <boost/test/unit_test.hpp>
+
+#include <array>
+#include <limits>
+
+/// a fetch request body up to its max_bytes field
+static iobuf fetch_body(int32_t max_bytes) {
+    iobuf buf;
+    // replica_id, max_wait_time, min_bytes
+    const std::array<int32_t, 3> fields{-1, 500, 1};
+    for (auto f : fields) {
+        auto be = ss::cpu_to_be(f);
+        buf.append(reinterpret_cast<const char*>(&be), sizeof(be));
+    }
+    auto be = ss::cpu_to_be(max_bytes);
+    buf.append(reinterpret_cast<const char*>(&be), sizeof(be));
+    return buf;
+}
+
+BOOST_AUTO_TEST_CASE(request_estimate_is_bounded_by_budget) {
+    BOOST_CHECK_EQUAL(kafka::request_memory_estimate(1_KiB, 1_MiB), 10048);
+    // larger than the whole budget: waits for all of it
+    BOOST_CHECK_EQUAL(kafka::request_memory_estimate(1_MiB, 1_MiB), 1_MiB);
+}
+
+BOOST_AUTO_TEST_CASE(fetch_estimate_includes_response) {
+    // too short to carry max_bytes: only the request is counted
+    BOOST_CHECK_EQUAL(kafka::fetch_memory_estimate(iobuf(), 1_GiB), 8000);
+
+    const auto body = fetch_body(64_KiB);
+    const size_t request = body.size_bytes() * 2 + 8000;
+    BOOST_CHECK_EQUAL(
+      kafka::fetch_memory_estimate(body, 1_GiB), request + 64_KiB);
+    // a negative max_bytes asks for nothing
+    BOOST_CHECK_EQUAL(
+      kafka::fetch_memory_estimate(fetch_body(-1), 1_GiB), request);
+    // capped by the largest response and by the budget
+    BOOST_CHECK_EQUAL(
+      kafka::fetch_memory_estimate(
+        fetch_body(std::numeric_limits<int32_t>::max()), 1_GiB),
+      request + kafka::fetch_api::max_response_size);
+    BOOST_CHECK_EQUAL(kafka::fetch_memory_estimate(body, 32_KiB), 32_KiB);
+}
@@ -63,6 +63,28 @@ struct prod_consume_fixture : public redpanda_thread_fixture {
         return res;
     }
 
+    /// a batch above the produce streaming threshold
+    std::vector<kafka::produce_request::partition> large_batch(size_t count) {
+        storage::record_batch_builder builder(
+          model::well_known_record_batch_types[1], model::offset(0));
+
+        for (int i = 0; i < count; ++i) {
+            iobuf v{};
+            auto value = random_generators::gen_alphanum_string(256_KiB);
+            v.append(value.data(), value.size());
+            builder.add_raw_kv(iobuf{}, std::move(v));
+        }
+
+        std::vector<kafka::produce_request::partition> res;
+
+        kafka::produce_request::partition partition;
+        partition.id = model::partition_id(0);
+        partition.adapter = kafka::kafka_batch_adapter();
+        partition.adapter.batch = std::move(std::move(builder).build());
+        res.push_back(std::move(partition));
+        return res;
+    }
+
     template<typename T>
     ss::future<> produce(T&& batch_factory) {
         kafka::produce_request::topic tp;
@@ -158,3 +180,53 @@ FIXTURE_TEST(test_produce_consume_small_batches, prod_consume_fixture) {
       resp_2.partitions.begin()->responses.begin()->error,
       kafka::error_code::none);
 };
+
+FIXTURE_TEST(test_produce_consume_streamed_request, prod_consume_fixture) {
+    wait_for_controller_leadership().get0();
+    start();
+    // 5 values of 256KiB go over the 1MiB streaming threshold
+    produce([this](size_t) { return large_batch(5); }).get0();
+    auto resp_1 = fetch_next().get0();
+    // the connection reads the next request after a streamed one
+    produce([this](size_t cnt) { return small_batches(cnt); }).get0();
+    auto resp_2 = fetch_next().get0();
+
+    BOOST_REQUIRE_EQUAL(resp_1.partitions.empty(), false);
+    BOOST_REQUIRE_EQUAL(resp_1.partitions.begin()->responses.empty(), false);
+    BOOST_REQUIRE_EQUAL(
+      resp_1.partitions.begin()->responses.begin()->error,
+      kafka::error_code::none);
+    BOOST_REQUIRE_EQUAL(resp_2.partitions.empty(), false);
+    BOOST_REQUIRE_EQUAL(resp_2.partitions.begin()->responses.empty(), false);
+    BOOST_REQUIRE_EQUAL(
+      resp_2.partitions.begin()->responses.begin()->error,
+      kafka::error_code::none);
+};
+
+FIXTURE_TEST(
+  test_produce_streamed_request_unsupported_version, prod_consume_fixture) {
+    wait_for_controller_leadership().get0();
+    start();
+    kafka::produce_request::topic tp;
+    tp.partitions = large_batch(5);
+    tp.name = test_topic;
+    std::vector<kafka::produce_request::topic> topics;
+    topics.push_back(std::move(tp));
+    kafka::produce_request req(std::nullopt, 1, std::move(topics));
+    req.timeout = std::chrono::seconds(2);
+    req.has_idempotent = false;
+    req.has_transactional = false;
+    // above the streaming threshold, but past the supported versions. the
+    // request is rejected and the connection closed instead of decoding it
+    const auto version = kafka::api_version(
+      kafka::produce_api::max_supported() + 1);
+    BOOST_REQUIRE_THROW(
+      producer->dispatch(std::move(req), version).get0(), std::exception);
+
+    auto resp = fetch_next().get0();
+    for (auto& p : resp.partitions) {
+        for (auto& r : p.responses) {
+            BOOST_REQUIRE(!r.record_set || r.record_set->empty());
+        }
+    }
+};
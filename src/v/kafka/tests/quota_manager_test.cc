@@ -0,0 +1,79 @@
+// Copyright 2020 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "kafka/quota_manager.h"
+#include "seastarx.h"
+#include "units.h"
+
+#include <seastar/core/sharded.hh>
+#include <seastar/core/smp.hh>
+#include <seastar/testing/thread_test_case.hh>
+#include <seastar/util/defer.hh>
+
+#include <boost/test/tools/old/interface.hpp>
+
+#include <chrono>
+
+using namespace std::chrono_literals;
+
+// fresh trackers measure over all but one of the 10 default windows of 1s
+static constexpr uint64_t bytes_for_rate(uint64_t rate) { return rate * 9; }
+
+static ss::future<kafka::quota_manager::throttle_delay>
+produce_on(ss::sharded<kafka::quota_manager>& qm, ss::shard_id s, uint64_t b) {
+    return qm.invoke_on(s, [b](kafka::quota_manager& q) {
+        return q.record_produce_tp_and_throttle("client", b);
+    });
+}
+
+SEASTAR_THREAD_TEST_CASE(produce_rates_are_aggregated_across_shards) {
+    BOOST_REQUIRE_GE(ss::smp::count, 2);
+    ss::sharded<kafka::quota_manager> qm;
+    qm.start().get();
+    auto stop = ss::defer([&qm] { qm.stop().get(); });
+
+    // 40MiB/s on each of two shards is below the 64MiB/s default quota
+    BOOST_REQUIRE_EQUAL(
+      produce_on(qm, 0, bytes_for_rate(40_MiB)).get0().duration.count(), 0);
+    BOOST_REQUIRE_EQUAL(
+      produce_on(qm, 1, bytes_for_rate(40_MiB)).get0().duration.count(), 0);
+
+    // shard 0 collects the rates and every shard sees the node-wide 80MiB/s
+    qm.local().aggregate().get();
+    BOOST_REQUIRE_GT(produce_on(qm, 0, 0).get0().duration.count(), 0);
+    BOOST_REQUIRE_GT(produce_on(qm, 1, 0).get0().duration.count(), 0);
+}
+
+SEASTAR_THREAD_TEST_CASE(fetch_rates_are_aggregated_across_shards) {
+    BOOST_REQUIRE_GE(ss::smp::count, 2);
+    ss::sharded<kafka::quota_manager> qm;
+    qm.start().get();
+    auto stop = ss::defer([&qm] { qm.stop().get(); });
+
+    qm.invoke_on_all([](kafka::quota_manager& q) {
+          q.record_fetch_tp("client", bytes_for_rate(40_MiB));
+          q.record_fetch_tp("other", bytes_for_rate(1_MiB));
+      }).get();
+    auto fetch_delay = [&qm](ss::shard_id s, std::string_view cid) {
+        return qm
+          .invoke_on(
+            s,
+            [cid](kafka::quota_manager& q) {
+                return q.throttle_fetch_tp(cid).duration;
+            })
+          .get0();
+    };
+    BOOST_REQUIRE_EQUAL(fetch_delay(1, "client").count(), 0);
+
+    qm.local().aggregate().get();
+    BOOST_REQUIRE_GT(fetch_delay(0, "client").count(), 0);
+    BOOST_REQUIRE_GT(fetch_delay(1, "client").count(), 0);
+    // clients are aggregated independently
+    BOOST_REQUIRE_EQUAL(fetch_delay(1, "other").count(), 0);
+}
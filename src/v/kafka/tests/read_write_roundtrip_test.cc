@@ -9,10 +9,14 @@
 
 #include "kafka/requests/request_reader.h"
 #include "kafka/requests/response_writer.h"
+#include "kafka/requests/sync_group_request.h"
 #include "random/generators.h"
 #include "utils/to_string.h"
 
 #include <seastar/testing/thread_test_case.hh>
+
+#include <limits>
+
 using namespace kafka; // NOLINT
 
 #define roundtrip_test(value, type_cast, read_method)                          \
@@ -27,6 +31,19 @@ using namespace kafka; // NOLINT
         BOOST_REQUIRE_EQUAL(val, (r.*read_method)());                          \
     }
 
+#define compact_roundtrip_test(value, type_cast, read_method)                  \
+    {                                                                          \
+        BOOST_TEST_CHECKPOINT("write_compact<" #type_cast                      \
+                              "> :: read<" #read_method ">");                  \
+        auto val = value;                                                      \
+        auto out = iobuf();                                                    \
+        kafka::response_writer w(out);                                         \
+        w.write_compact((type_cast)val);                                       \
+        kafka::request_reader r(std::move(out));                               \
+        BOOST_REQUIRE_EQUAL(val, (r.*read_method)());                          \
+        BOOST_REQUIRE_EQUAL(r.bytes_left(), 0);                                \
+    }
+
 SEASTAR_THREAD_TEST_CASE(write_and_read_value_test) {
     roundtrip_test(static_cast<int8_t>(64), int8_t, &request_reader::read_int8);
     roundtrip_test(
@@ -50,3 +67,125 @@ SEASTAR_THREAD_TEST_CASE(write_and_read_value_test) {
     roundtrip_test(
       model::topic{"test_topic"}, ss::sstring, &request_reader::read_string);
 }
+
+SEASTAR_THREAD_TEST_CASE(write_and_read_compact_value_test) {
+    compact_roundtrip_test(
+      ss::sstring{"test_string"},
+      ss::sstring,
+      &request_reader::read_compact_string);
+    compact_roundtrip_test(
+      ss::sstring{}, ss::sstring, &request_reader::read_compact_string);
+    compact_roundtrip_test(
+      ss::sstring(200, 'x'), ss::sstring, &request_reader::read_compact_string);
+    compact_roundtrip_test(
+      ss::sstring("test_string"),
+      std::optional<ss::sstring>,
+      &request_reader::read_compact_nullable_string);
+    compact_roundtrip_test(
+      static_cast<std::optional<ss::sstring>>(std::nullopt),
+      std::optional<ss::sstring>,
+      &request_reader::read_compact_nullable_string);
+    compact_roundtrip_test(
+      model::topic{"test_topic"},
+      ss::sstring,
+      &request_reader::read_compact_string);
+}
+
+SEASTAR_THREAD_TEST_CASE(write_and_read_unsigned_varint_test) {
+    for (uint32_t v : std::vector<uint32_t>{
+           0, 1, 127, 128, 16383, 16384, std::numeric_limits<uint32_t>::max()}) {
+        auto out = iobuf();
+        kafka::response_writer w(out);
+        auto size = w.write_unsigned_varint(v);
+        BOOST_REQUIRE_EQUAL(size, out.size_bytes());
+        kafka::request_reader r(std::move(out));
+        BOOST_REQUIRE_EQUAL(r.read_unsigned_varint(), v);
+    }
+
+    // a sixth byte is never valid
+    auto out = iobuf();
+    for (int i = 0; i < 6; ++i) {
+        out.append("\xff", 1);
+    }
+    kafka::request_reader r(std::move(out));
+    BOOST_REQUIRE_THROW(r.read_unsigned_varint(), std::out_of_range);
+}
+
+SEASTAR_THREAD_TEST_CASE(skip_unknown_tagged_fields_test) {
+    auto out = iobuf();
+    kafka::response_writer w(out);
+    w.write_unsigned_varint(2);
+    w.write_unsigned_varint(0); // tag
+    w.write_compact(std::string_view("abc"));
+    w.write_unsigned_varint(7); // tag
+    w.write_unsigned_varint(0);
+    w.write(int32_t(42));
+
+    kafka::request_reader r(std::move(out));
+    r.skip_tags();
+    BOOST_REQUIRE_EQUAL(r.read_int32(), 42);
+}
+
+SEASTAR_THREAD_TEST_CASE(compact_array_test) {
+    std::vector<ss::sstring> v{"a", "bb", "ccc"};
+    auto out = iobuf();
+    kafka::response_writer w(out);
+    w.write_compact_array(v, [](ss::sstring& s, response_writer& w) {
+        w.write_compact(s);
+    });
+    std::optional<std::vector<ss::sstring>> null_array;
+    w.write_compact_nullable_array(
+      null_array,
+      [](ss::sstring& s, response_writer& w) { w.write_compact(s); });
+
+    kafka::request_reader r(std::move(out));
+    auto read = r.read_compact_array(
+      [](request_reader& r) { return r.read_compact_string(); });
+    BOOST_REQUIRE(read == v);
+    auto read_null = r.read_compact_nullable_array(
+      [](request_reader& r) { return r.read_compact_string(); });
+    BOOST_REQUIRE(!read_null);
+}
+
+SEASTAR_THREAD_TEST_CASE(generated_flexible_version_test) {
+    auto make = [] {
+        sync_group_request_data d{
+          .group_id = kafka::group_id("group"),
+          .generation_id = kafka::generation_id(3),
+          .member_id = kafka::member_id("member"),
+          .group_instance_id = kafka::group_instance_id("instance"),
+        };
+        d.assignments.push_back(sync_group_request_assignment{
+          .member_id = kafka::member_id("member"),
+          .assignment = bytes(bytes::initialized_later{}, 16),
+        });
+        return d;
+    };
+
+    auto encoded_size = [&make](api_version v) {
+        auto d = make();
+        auto out = iobuf();
+        kafka::response_writer w(out);
+        d.encode(w, v);
+        const auto size = out.size_bytes();
+
+        sync_group_request_data read;
+        kafka::request_reader r(std::move(out));
+        read.decode(r, v);
+        BOOST_REQUIRE_EQUAL(r.bytes_left(), 0);
+        BOOST_REQUIRE_EQUAL(read.group_id, d.group_id);
+        BOOST_REQUIRE_EQUAL(read.generation_id, d.generation_id);
+        BOOST_REQUIRE_EQUAL(read.member_id, d.member_id);
+        BOOST_REQUIRE_EQUAL(*read.group_instance_id, *d.group_instance_id);
+        BOOST_REQUIRE_EQUAL(read.assignments.size(), 1);
+        BOOST_REQUIRE_EQUAL(
+          read.assignments[0].member_id, d.assignments[0].member_id);
+        BOOST_REQUIRE_EQUAL(
+          read.assignments[0].assignment.size(),
+          d.assignments[0].assignment.size());
+        return size;
+    };
+
+    // compact lengths are a byte each here, even with the tagged fields added
+    BOOST_REQUIRE_LT(encoded_size(api_version(4)), encoded_size(api_version(3)));
+}
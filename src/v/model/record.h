@@ -435,12 +435,12 @@ public:
         if (_compressed) {
             _records = std::move(std::get<compressed_records>(records));
         } else {
-            const auto& recs = std::get<uncompressed_records>(records);
+            auto& recs = std::get<uncompressed_records>(records);
             vassert(
               _header.record_count == static_cast<int32_t>(recs.size()),
               "Batch header record count does not match payload");
-            for (const auto& r : recs) {
-                model::append_record_to_buffer(_records, r);
+            for (auto& r : recs) {
+                model::append_record_to_buffer(_records, std::move(r));
             }
         }
         vassert(
@@ -486,6 +486,24 @@ public:
         return record_batch(_header.copy(), _records.copy(), _compressed);
     }
 
+    /**
+     * A batch that references the records of this one instead of copying
+     * them, used to take over batches owned by another core. The returned
+     * batch belongs to the calling core and \p d is released once the last
+     * of its fragments is gone, so \p d must keep this batch alive.
+     */
+    record_batch borrow(ss::deleter d) const {
+        iobuf records;
+        for (auto& f : _records) {
+            records.append_take_ownership(new iobuf::fragment(
+              ss::temporary_buffer<char>(
+                const_cast<char*>(f.get()), f.size(), d.share()),
+              iobuf::fragment::full{}));
+        }
+        // copy sets shard id
+        return record_batch(_header.copy(), std::move(records), _compressed);
+    }
+
     int32_t record_count() const { return _header.record_count; }
     model::offset base_offset() const { return _header.base_offset; }
     model::offset last_offset() const { return _header.last_offset(); }
@@ -19,6 +19,25 @@ using data_t = record_batch_reader::data_t;
 using foreign_data_t = record_batch_reader::foreign_data_t;
 using storage_t = record_batch_reader::storage_t;
 
+data_t record_batch_reader::impl::adopt_foreign_slice(foreign_data_t&& d) {
+    data_t ret;
+    auto& batches = *d.buffer;
+    ret.reserve(batches.size() - d.index);
+    if (d.buffer.get_owner_shard() == ss::this_shard_id()) {
+        for (auto i = d.index; i < batches.size(); ++i) {
+            ret.push_back(std::move(batches[i]));
+        }
+        return ret;
+    }
+    // the borrowed records keep the foreign buffer alive. it is released on
+    // its own core once the last of them is gone
+    auto owner = ss::make_lw_shared(std::move(d.buffer));
+    for (auto i = d.index; i < batches.size(); ++i) {
+        ret.push_back(batches[i].borrow(ss::make_deleter([owner] {})));
+    }
+    return ret;
+}
+
 /// \brief wraps a reader into a foreign_ptr<unique_ptr>
 record_batch_reader make_foreign_record_batch_reader(record_batch_reader&& r) {
     class foreign_reader final : public record_batch_reader::impl {
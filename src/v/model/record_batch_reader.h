@@ -100,19 +100,21 @@ public:
         }
 
     private:
+        /// turns the rest of a foreign slice into batches owned by this core
+        /// without copying their records, see record_batch::borrow
+        static data_t adopt_foreign_slice(foreign_data_t&&);
+
         record_batch pop_batch() {
-            return ss::visit(
-              _slice,
-              [](data_t& d) {
-                  record_batch batch = std::move(d.front());
-                  d.pop_front();
-                  return batch;
-              },
-              [](foreign_data_t& d) {
-                  // cannot have a move-only type from a remote core
-                  // we must make a copy. for iteration use for_each_ref
-                  return (*d.buffer)[d.index++].copy();
-              });
+            if (auto d = std::get_if<foreign_data_t>(&_slice)) {
+                // cannot move batches out of a remote core; instead of
+                // copying them one at a time, adopt the slice wholesale.
+                // for iteration use for_each_ref
+                _slice = adopt_foreign_slice(std::move(*d));
+            }
+            auto& d = std::get<data_t>(_slice);
+            record_batch batch = std::move(d.front());
+            d.pop_front();
+            return batch;
         }
         ss::future<> load_slice(timeout_clock::time_point timeout) {
             return do_load_slice(timeout).then([this](storage_t s) {
@@ -27,4 +27,9 @@ constexpr std::array<record_batch_type, 8> well_known_record_batch_types{
   record_batch_type(6), // controller topic command batch type
   record_batch_type(7), // ghost - used to fill gaps in raft recovery
 };
+
+/// batches carrying client records, same as raft::data_batch_type for
+/// modules that cannot depend on raft
+constexpr record_batch_type data_record_batch_type
+  = well_known_record_batch_types[1];
 } // namespace model
\ No newline at end of file
@@ -221,4 +221,40 @@ void append_record_to_buffer(iobuf& a, const model::record& r) {
     }
 }
 
+void append_record_to_buffer(iobuf& a, model::record&& r) {
+    a.reserve_memory(vint::max_length * 6);
+    append_vint_to_iobuf(a, r.size_bytes());
+
+    const auto attrs = ss::cpu_to_be(r.attributes().value());
+    // NOLINTNEXTLINE
+    a.append(reinterpret_cast<const char*>(&attrs), sizeof(attrs));
+
+    append_vint_to_iobuf(a, r.timestamp_delta());
+    append_vint_to_iobuf(a, r.offset_delta());
+
+    // small fragments are still copied by iobuf::append, large ones are
+    // linked into the buffer as-is
+    append_vint_to_iobuf(a, r.key_size());
+    if (r.key_size() > 0) {
+        a.append(r.release_key());
+    }
+    append_vint_to_iobuf(a, r.value_size());
+    if (r.value_size() > 0) {
+        a.append(r.release_value());
+    }
+
+    auto& hdrs = r.headers();
+    append_vint_to_iobuf(a, hdrs.size());
+    for (auto& h : hdrs) {
+        append_vint_to_iobuf(a, h.key_size());
+        if (h.key_size() > 0) {
+            a.append(h.release_key());
+        }
+        append_vint_to_iobuf(a, h.value_size());
+        if (h.value_size() > 0) {
+            a.append(h.release_value());
+        }
+    }
+}
+
 } // namespace model
@@ -33,5 +33,8 @@ uint32_t internal_header_only_crc(const record_batch_header&);
 model::record parse_one_record_from_buffer(iobuf_parser& parser);
 model::record parse_one_record_copy_from_buffer(iobuf_const_parser& parser);
 void append_record_to_buffer(iobuf& a, const model::record& r);
+/// \brief like the above, but splices the key, value and header payloads of
+/// the record into the buffer instead of copying them
+void append_record_to_buffer(iobuf& a, model::record&& r);
 
 } // namespace model
@@ -11,6 +11,7 @@
 #include "model/record_batch_reader.h"
 #include "storage/tests/utils/random_batch.h"
 
+#include <seastar/core/smp.hh>
 #include <seastar/core/thread.hh>
 #include <seastar/testing/thread_test_case.hh>
 
@@ -174,3 +175,41 @@ SEASTAR_THREAD_TEST_CASE(record_batch_sharing) {
         BOOST_CHECK(v1[i] == v2[i]);
     }
 }
+
+SEASTAR_THREAD_TEST_CASE(test_consume_foreign_batches) {
+    // the binary runs with 2 cores so that the batches really are foreign
+    BOOST_REQUIRE_GT(ss::smp::count, 1);
+    auto expected = make_batches(offset(1), offset(2), offset(3), offset(4));
+    auto shard = (ss::this_shard_id() + 1) % ss::smp::count;
+    // first record fragment of every batch on the owner core
+    std::vector<const char*> foreign_records;
+    ss::circular_buffer<record_batch> batches;
+    {
+        auto reader = ss::smp::submit_to(
+                        shard,
+                        [&expected, &foreign_records] {
+                            record_batch_reader::data_t data;
+                            for (auto& b : expected) {
+                                data.push_back(b.copy());
+                                foreign_records.push_back(
+                                  data.back().data().begin()->get());
+                            }
+                            return make_foreign_memory_record_batch_reader(
+                              std::move(data));
+                        })
+                        .get0();
+        batches = reader.consume(consumer(4), no_timeout).get0();
+    }
+    // the reader is gone, the borrowed records alone keep the foreign
+    // buffer alive
+
+    BOOST_REQUIRE_EQUAL(batches.size(), expected.size());
+    for (auto i = 0; i < batches.size(); ++i) {
+        BOOST_CHECK(batches[i] == expected[i]);
+        BOOST_CHECK(batches[i].header().ctx.owner_shard == ss::this_shard_id());
+        // borrowed, not copied
+        BOOST_CHECK_EQUAL(
+          static_cast<const void*>(batches[i].data().begin()->get()),
+          static_cast<const void*>(foreign_records[i]));
+    }
+}
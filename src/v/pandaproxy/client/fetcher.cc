@@ -40,8 +40,8 @@ kafka::fetch_request make_fetch_request(
       .min_bytes = 0,
       .max_bytes = max_bytes,
       .isolation_level = 0,
-      .session_id = 0,
-      .session_epoch = 0,
+      .session_id = kafka::invalid_fetch_session_id(),
+      .session_epoch = kafka::final_fetch_session_epoch(),
       .topics{std::move(topics)}};
 }
 
@@ -95,6 +95,9 @@ void consensus::setup_metrics() {
 void consensus::do_step_down() {
     _hbeat = clock_type::now();
     _vstate = vote_state::follower;
+    _log.set_tail_buffer_enabled(false);
+    // no flush waiter outlives the term for entries that are gone
+    truncate_flush_waiters();
 }
 
 void consensus::maybe_step_down() {
@@ -372,7 +375,10 @@ consensus::replicate(model::record_batch_reader&& rdr, replicate_options opts) {
     // For relaxed consistency, append data to leader disk without flush
     // asynchronous replication is provided by Raft protocol recovery mechanism.
     return _op_lock
-      .with([this, rdr = std::move(rdr)]() mutable {
+      .with([this,
+             rdr = std::move(rdr),
+             start = std::chrono::steady_clock::now()]() mutable {
+          _probe.op_lock_waited(std::chrono::steady_clock::now() - start);
           if (!is_leader()) {
               return seastar::make_ready_future<result<replicate_result>>(
                 errc::not_leader);
@@ -391,20 +397,6 @@ consensus::replicate(model::record_batch_reader&& rdr, replicate_options opts) {
       .finally([this] { _probe.replicate_done(); });
 }
 
-void consensus::dispatch_flush_with_lock() {
-    if (!_has_pending_flushes) {
-        return;
-    }
-    (void)ss::with_gate(_bg, [this] {
-        return _op_lock.with([this] {
-            if (!_has_pending_flushes) {
-                return ss::make_ready_future<>();
-            }
-            return flush_log();
-        });
-    });
-}
-
 model::offset consensus::last_stable_offset() const {
     // TODO: handle transactions, when we implement them, for now LSO is simply
     // equal to max consumable offset
@@ -418,6 +410,20 @@ consensus::do_make_reader(storage::log_reader_config config) {
     return _log.make_reader(config);
 }
 
+std::optional<storage::raw_read_result>
+consensus::read_tail(storage::log_reader_config config) {
+    // limit to last visible index
+    config.max_offset = std::min(config.max_offset, _last_visible_index);
+    return _log.read_tail(config);
+}
+
+ss::future<storage::raw_read_result> consensus::read_raw(
+  storage::log_reader_config config, storage::use_batch_cache cache) {
+    // limit to last visible index
+    config.max_offset = std::min(config.max_offset, _last_visible_index);
+    return _log.read_raw(config, cache);
+}
+
 ss::future<model::record_batch_reader> consensus::make_reader(
   storage::log_reader_config config,
   std::optional<clock_type::time_point> debounce_timeout) {
@@ -1057,6 +1063,9 @@ consensus::do_append_entries(append_entries_request&& r) {
         return _log
           .truncate(storage::truncate_config(truncate_at, _io_priority))
           .then([this, truncate_at] {
+              // a flush may be in progress, its waiters for the truncated
+              // entries are failed here rather than when it completes
+              truncate_flush_waiters();
               return _configuration_manager.truncate(truncate_at).then([this] {
                   _probe.configuration_update();
                   update_follower_stats(_configuration_manager.get_latest());
@@ -1400,8 +1409,53 @@ consensus::make_append_entries_reply(storage::append_result disk_results) {
 }
 
 ss::future<> consensus::flush_log() {
+    auto offsets = _log.offsets();
+    if (offsets.committed_offset >= offsets.dirty_offset) {
+        return ss::now();
+    }
+    auto f = _flush_waiters.wait(offsets.dirty_offset);
+    // an in-progress flush may not cover this offset. it is flushed by the
+    // next one, dispatched as soon as the current one is done
+    if (!_flush_in_progress) {
+        do_flush_log();
+    }
+    return f;
+}
+
+void consensus::truncate_flush_waiters() {
+    _flush_waiters.truncate(_log.offsets().dirty_offset);
+}
+
+void consensus::do_flush_log() {
+    if (_bg.is_closed()) {
+        _flush_waiters.fail(
+          std::make_exception_ptr(ss::gate_closed_exception()));
+        return;
+    }
+    _flush_in_progress = true;
     _probe.log_flushed();
-    return _log.flush().then([this] { _has_pending_flushes = false; });
+    (void)ss::with_gate(_bg, [this] {
+        return _log.flush().then_wrapped([this](ss::future<> f) {
+            _flush_in_progress = false;
+            if (f.failed()) {
+                _flush_waiters.fail(f.get_exception());
+                return;
+            }
+            // storage advances the committed offset up to the dirty offset
+            // captured when the flush started
+            auto offsets = _log.offsets();
+            _flush_waiters.notify(offsets.committed_offset);
+            // the log may have been truncated while it was flushed. waiters
+            // above the dirty offset would never be satisfied
+            truncate_flush_waiters();
+            // what is left is dirty, so the next flush makes progress
+            if (
+              !_flush_waiters.empty()
+              && offsets.committed_offset < offsets.dirty_offset) {
+                do_flush_log();
+            }
+        });
+    });
 }
 
 ss::future<storage::append_result>
@@ -1420,7 +1474,6 @@ consensus::disk_append(model::record_batch_reader&& reader) {
              cfg.timeout)
       .then([this](std::tuple<ret_t, std::vector<offset_configuration>> t) {
           auto& [ret, configurations] = t;
-          _has_pending_flushes = true;
           // TODO
           // if we rolled a log segment. write current configuration
           // for speedy recovery in the background
@@ -1606,6 +1659,8 @@ void consensus::update_follower_stats(const group_configuration& cfg) {
 
 void consensus::trigger_leadership_notification() {
     _probe.leadership_changed();
+    // only leaders serve fetches, so only they keep the tail of the log
+    _log.set_tail_buffer_enabled(_leader_id == _self);
     _leader_notification(leadership_status{
       .term = model::term_id(_term),
       .group = group_id(_group),
@@ -16,6 +16,7 @@
 #include "raft/configuration_manager.h"
 #include "raft/consensus_client_protocol.h"
 #include "raft/event_manager.h"
+#include "raft/flush_waiters.h"
 #include "raft/follower_stats.h"
 #include "raft/logger.h"
 #include "raft/prevote_stm.h"
@@ -137,6 +138,13 @@ public:
       storage::log_reader_config,
       std::optional<clock_type::time_point> = std::nullopt);
 
+    /// \brief storage::log::read_raw bound by the last visible index
+    ss::future<storage::raw_read_result>
+      read_raw(storage::log_reader_config, storage::use_batch_cache);
+    /// \brief storage::log::read_tail bound by the last visible index
+    std::optional<storage::raw_read_result>
+      read_tail(storage::log_reader_config);
+
     model::offset committed_offset() const { return _commit_index; }
     model::offset last_stable_offset() const;
 
@@ -285,11 +293,14 @@ private:
     void update_follower_stats(const group_configuration&);
     void trigger_leadership_notification();
 
-    /// \brief _does not_ hold the lock.
+    /// \brief _does not_ hold the lock. resolves once the log is flushed
+    /// up to its dirty offset at the time of the call. appends may go on
+    /// while the flush is in progress
     ss::future<> flush_log();
-    /// \brief called by the vote timer, to dispatch a write under
-    /// the ops semaphore
-    void dispatch_flush_with_lock();
+    void do_flush_log();
+    /// \brief fails flush_log() callers waiting for entries that were
+    /// truncated away
+    void truncate_flush_waiters();
 
     void maybe_step_down();
 
@@ -346,7 +357,9 @@ private:
     follower_stats _fstats;
 
     replicate_batcher _batcher;
-    bool _has_pending_flushes{false};
+    bool _flush_in_progress{false};
+    /// flush_log() callers, by the offset they wait to be flushed
+    flush_waiters _flush_waiters;
 
     /// used to wait for background ops before shutting down
     ss::gate _bg;
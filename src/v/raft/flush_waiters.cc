@@ -0,0 +1,44 @@
+// Copyright 2020 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "raft/flush_waiters.h"
+
+namespace raft {
+
+ss::future<> flush_waiters::wait(model::offset o) {
+    return _waiters.emplace(o, ss::promise<>())->second.get_future();
+}
+
+void flush_waiters::notify(model::offset flushed) {
+    while (!_waiters.empty()) {
+        auto it = _waiters.begin();
+        if (flushed < it->first) {
+            return;
+        }
+        it->second.set_value();
+        _waiters.erase(it);
+    }
+}
+
+void flush_waiters::truncate(model::offset dirty) {
+    auto it = _waiters.upper_bound(dirty);
+    for (auto i = it; i != _waiters.end(); ++i) {
+        i->second.set_exception(log_truncated());
+    }
+    _waiters.erase(it, _waiters.end());
+}
+
+void flush_waiters::fail(const std::exception_ptr& e) {
+    for (auto& [_, p] : _waiters) {
+        p.set_exception(e);
+    }
+    _waiters.clear();
+}
+
+} // namespace raft
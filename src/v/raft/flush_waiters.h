@@ -0,0 +1,68 @@
+/*
+ * Copyright 2020 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+#include "model/fundamental.h"
+#include "seastarx.h"
+
+#include <seastar/core/future.hh>
+
+#include <absl/container/btree_map.h>
+
+#include <exception>
+
+namespace raft {
+
+/**
+ * Callers of consensus::flush_log() waiting for the log to be flushed up to
+ * the dirty offset they appended. Waiters are resolved as flushes complete
+ * and failed when the entries they wait for are truncated away.
+ */
+class flush_waiters {
+public:
+    /**
+     * Exception used to indicate that the log was truncated below the offset
+     * of a waiter, its entries will never be flushed.
+     */
+    class log_truncated final : public std::exception {
+    public:
+        const char* what() const noexcept final {
+            return "log truncated before it was flushed";
+        }
+    };
+
+    /**
+     * Wait until the log is flushed up to the given offset.
+     */
+    ss::future<> wait(model::offset);
+
+    /**
+     * Resolves waiters up to the given flushed offset.
+     */
+    void notify(model::offset);
+
+    /**
+     * Fails waiters above the given dirty offset with log_truncated.
+     */
+    void truncate(model::offset);
+
+    /**
+     * Fails all waiters.
+     */
+    void fail(const std::exception_ptr&);
+
+    bool empty() const { return _waiters.empty(); }
+
+private:
+    absl::btree_multimap<model::offset, ss::promise<>> _waiters;
+};
+
+} // namespace raft
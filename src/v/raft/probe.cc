@@ -103,6 +103,23 @@ void probe::setup_metrics(const model::ntp& ntp) {
          "recovery_requests_errors",
          [this] { return _recovery_request_error; },
          sm::description("Number of failed recovery requests"),
+         labels),
+       sm::make_derive(
+         "cross_shard_copied_bytes",
+         [this] { return _cross_shard_bytes_copied; },
+         sm::description("Number of bytes of replicated batches copied "
+                         "because they were owned by another core"),
+         labels),
+       sm::make_derive(
+         "op_lock_waits",
+         [this] { return _op_lock_waits; },
+         sm::description("Number of appends that waited for the raft op lock"),
+         labels),
+       sm::make_derive(
+         "op_lock_wait_us",
+         [this] { return _op_lock_wait_us; },
+         sm::description("Total time in microseconds appends spent waiting "
+                         "for the raft op lock"),
          labels)});
 }
 
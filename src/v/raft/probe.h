@@ -14,6 +14,7 @@
 
 #include <seastar/core/metrics_registration.hh>
 
+#include <chrono>
 #include <cstdint>
 namespace raft {
 class probe {
@@ -32,6 +33,12 @@ public:
     void log_flushed() { ++_log_flushes; }
 
     void replicate_batch_flushed() { ++_replicate_batch_flushed; }
+    void cross_shard_bytes_copied(size_t n) { _cross_shard_bytes_copied += n; }
+    void op_lock_waited(std::chrono::steady_clock::duration d) {
+        ++_op_lock_waits;
+        _op_lock_wait_us
+          += std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    }
     void recovery_append_request() { ++_recovery_requests; }
     void configuration_update() { ++_configuration_updates; }
 
@@ -56,6 +63,9 @@ private:
     uint64_t _replicate_requests_done = 0;
     uint64_t _log_flushes = 0;
     uint64_t _replicate_batch_flushed = 0;
+    uint64_t _cross_shard_bytes_copied = 0;
+    uint64_t _op_lock_waits = 0;
+    uint64_t _op_lock_wait_us = 0;
     uint32_t _log_truncations = 0;
     uint32_t _configuration_updates = 0;
     uint64_t _recovery_requests = 0;
@@ -85,6 +85,7 @@ replicate_batcher::do_cache(model::record_batch_reader&& r) {
               if (b.header().ctx.owner_shard == ss::this_shard_id()) {
                   _data_cache.emplace_back(std::move(b));
               } else {
+                  _ptr->_probe.cross_shard_bytes_copied(b.size_bytes());
                   _data_cache.emplace_back(b.copy());
               }
           }
@@ -109,8 +110,11 @@ ss::future<> replicate_batcher::flush() {
           return _ptr->_op_lock.get_units().then(
             [this,
              data = std::move(data),
-             notifications = std::move(notifications)](
+             notifications = std::move(notifications),
+             start = std::chrono::steady_clock::now()](
               ss::semaphore_units<> u) mutable {
+                _ptr->_probe.op_lock_waited(
+                  std::chrono::steady_clock::now() - start);
                 // we have to check if we are the leader
                 // it is critical as term could have been updated already by
                 // vote request and entries from current node could be accepted
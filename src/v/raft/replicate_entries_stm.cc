@@ -40,14 +40,14 @@ ss::future<append_entries_request> replicate_entries_stm::share_request() {
     });
 }
 ss::future<result<append_entries_reply>> replicate_entries_stm::do_dispatch_one(
-  model::node_id n,
-  append_entries_request req,
-  ss::lw_shared_ptr<std::vector<ss::semaphore_units<>>> units) {
+  model::node_id n, append_entries_request req) {
     using ret_t = result<append_entries_reply>;
 
     if (n == _ptr->_self) {
+        // the op lock is not held while the log is flushed, appends that
+        // follow this one are not held back by the fsync
         auto f = _ptr->flush_log()
-                   .then([this, units]() {
+                   .then([this]() {
                        auto lstats = _ptr->_log.offsets();
                        auto last_idx = lstats.committed_offset;
                        append_entries_reply reply;
@@ -114,7 +114,8 @@ replicate_entries_stm::dispatch_single_retry(
   ss::lw_shared_ptr<std::vector<ss::semaphore_units<>>> units) {
     return share_request()
       .then([this, id, units](append_entries_request r) mutable {
-          return do_dispatch_one(id, std::move(r), units);
+          // units are held until the request is dispatched
+          return do_dispatch_one(id, std::move(r));
       })
       .handle_exception([this](const std::exception_ptr& e) {
           vlog(_ctxlog.warn, "Error while replicating entries {}", e);
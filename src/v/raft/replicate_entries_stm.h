@@ -96,10 +96,8 @@ private:
       model::node_id, ss::lw_shared_ptr<std::vector<ss::semaphore_units<>>>);
     ss::future<result<append_entries_reply>> dispatch_single_retry(
       model::node_id, ss::lw_shared_ptr<std::vector<ss::semaphore_units<>>>);
-    ss::future<result<append_entries_reply>> do_dispatch_one(
-      model::node_id,
-      append_entries_request,
-      ss::lw_shared_ptr<std::vector<ss::semaphore_units<>>>);
+    ss::future<result<append_entries_reply>>
+      do_dispatch_one(model::node_id, append_entries_request);
 
     ss::future<result<append_entries_reply>>
       send_append_entries_request(model::node_id, append_entries_request);
@@ -0,0 +1,65 @@
+// Copyright 2020 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "raft/flush_waiters.h"
+#include "seastarx.h"
+
+#include <seastar/testing/thread_test_case.hh>
+
+SEASTAR_THREAD_TEST_CASE(notify_flushed) {
+    raft::flush_waiters w;
+
+    auto f0 = w.wait(model::offset(10));
+    auto f1 = w.wait(model::offset(20));
+    BOOST_REQUIRE(!f0.available());
+    BOOST_REQUIRE(!f1.available());
+
+    w.notify(model::offset(15));
+    BOOST_REQUIRE(f0.available());
+    BOOST_REQUIRE_NO_THROW(f0.get());
+    BOOST_REQUIRE(!f1.available());
+    BOOST_REQUIRE(!w.empty());
+
+    w.notify(model::offset(20));
+    BOOST_REQUIRE_NO_THROW(f1.get());
+    BOOST_REQUIRE(w.empty());
+}
+
+SEASTAR_THREAD_TEST_CASE(truncate_while_waiting) {
+    raft::flush_waiters w;
+
+    // an ex-leader appended up to 30, a flush up to 10 is in progress when
+    // the new leader truncates its log to 15
+    auto f0 = w.wait(model::offset(10));
+    auto f1 = w.wait(model::offset(20));
+    auto f2 = w.wait(model::offset(30));
+
+    w.truncate(model::offset(15));
+    BOOST_REQUIRE(!f0.available());
+    BOOST_REQUIRE(f1.available());
+    BOOST_REQUIRE(f2.available());
+    BOOST_REQUIRE_THROW(f1.get(), raft::flush_waiters::log_truncated);
+    BOOST_REQUIRE_THROW(f2.get(), raft::flush_waiters::log_truncated);
+
+    // the flush completes, nothing is left to dispatch another one for
+    w.notify(model::offset(10));
+    BOOST_REQUIRE_NO_THROW(f0.get());
+    BOOST_REQUIRE(w.empty());
+}
+
+SEASTAR_THREAD_TEST_CASE(fail_all) {
+    raft::flush_waiters w;
+
+    auto f0 = w.wait(model::offset(10));
+    auto f1 = w.wait(model::offset(10));
+    w.fail(std::make_exception_ptr(std::runtime_error("flush failed")));
+    BOOST_REQUIRE_THROW(f0.get(), std::runtime_error);
+    BOOST_REQUIRE_THROW(f1.get(), std::runtime_error);
+    BOOST_REQUIRE(w.empty());
+}
@@ -24,6 +24,8 @@
 #include "rpc/simple_protocol.h"
 #include "storage/chunk_cache.h"
 #include "storage/directories.h"
+#include "storage/extent_cache.h"
+#include "storage/file_handle_budget.h"
 #include "syschecks/syschecks.h"
 #include "test_utils/logs.h"
 #include "utils/file_io.h"
@@ -268,8 +270,9 @@ static storage::kvstore_config kvstore_config_from_global_config() {
       storage::debug_sanitize_files::no);
 }
 
-static storage::log_config manager_config_from_global_config() {
-    return storage::log_config(
+static storage::log_config
+manager_config_from_global_config(scheduling_groups& sgs) {
+    auto cfg = storage::log_config(
       storage::log_config::storage_type::disk,
       config::shard_local_cfg().data_directory().as_sstring(),
       config::shard_local_cfg().log_segment_size(),
@@ -286,11 +289,19 @@ static storage::log_config manager_config_from_global_config() {
         .min_size = config::shard_local_cfg().reclaim_min_size(),
         .max_size = config::shard_local_cfg().reclaim_max_size(),
       });
+    cfg.recovery_concurrency = std::max<size_t>(
+      1, config::shard_local_cfg().storage_recovery_concurrency());
+    cfg.compaction_sg = sgs.compaction_sg();
+    return cfg;
 }
 
 // add additional services in here
 void application::wire_up_services() {
     ss::smp::invoke_on_all([] {
+        storage::internal::file_handles().set_limit(
+          config::shard_local_cfg().segment_reader_max_open_files());
+        storage::internal::extents().set_enabled(
+          config::shard_local_cfg().enable_segment_extent_cache());
         return storage::internal::chunks().start();
     }).get();
 
@@ -304,7 +315,7 @@ void application::wire_up_services() {
     construct_service(
       storage,
       kvstore_config_from_global_config(),
-      manager_config_from_global_config())
+      manager_config_from_global_config(_scheduling_groups))
       .get();
 
     if (coproc_enabled()) {
@@ -390,6 +401,8 @@ void application::wire_up_services() {
     // metrics and quota management
     syschecks::systemd_message("Adding kafka quota manager");
     construct_service(_quota_mgr).get();
+    syschecks::systemd_message("Creating kafka fetch session cache");
+    construct_service(fetch_session_cache).get();
     // rpc
     rpc::server_configuration rpc_cfg("internal_rpc");
     /**
@@ -437,7 +450,8 @@ void application::wire_up_services() {
     }
 
     rpc::server_configuration kafka_cfg("kafka_rpc");
-    kafka_cfg.max_service_memory_per_core = memory_groups::kafka_total_memory();
+    kafka_cfg.max_service_memory_per_core
+      = memory_groups::kafka_produce_memory();
     auto kafka_addr = config::shard_local_cfg().kafka_api().resolve().get0();
     kafka_cfg.addrs.push_back(kafka_addr);
     syschecks::systemd_message("Building TLS credentials for kafka");
@@ -461,20 +475,36 @@ void application::wire_up_services() {
 }
 
 void application::start() {
+    using clock_type = std::chrono::steady_clock;
+    auto phase_start = clock_type::now();
+    auto end_phase = [this, &phase_start](const char* phase) {
+        auto now = clock_type::now();
+        _startup_phases.emplace_back(
+          phase,
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+            now - phase_start));
+        phase_start = now;
+    };
+
     syschecks::systemd_message("Staring storage services");
     storage.invoke_on_all(&storage::api::start).get();
+    end_phase("storage");
 
     syschecks::systemd_message("Starting the partition manager");
     partition_manager.invoke_on_all(&cluster::partition_manager::start).get();
+    end_phase("partition_manager");
 
     syschecks::systemd_message("Starting Raft group manager");
     raft_group_manager.invoke_on_all(&raft::group_manager::start).get();
+    end_phase("raft_group_manager");
 
     syschecks::systemd_message("Starting Kafka group manager");
     _group_manager.invoke_on_all(&kafka::group_manager::start).get();
+    end_phase("kafka_group_manager");
 
     syschecks::systemd_message("Starting controller");
     controller->start().get0();
+    end_phase("controller");
 
     // FIXME: in first patch explain why this is started after the
     // controller so the broker set will be available. Then next patch fix.
@@ -482,6 +512,7 @@ void application::start() {
     md_dissemination_service
       .invoke_on_all(&cluster::metadata_dissemination_service::start)
       .get();
+    end_phase("metadata_dissemination");
 
     syschecks::systemd_message("Starting RPC");
     _rpc
@@ -509,6 +540,7 @@ void application::start() {
     auto& conf = config::shard_local_cfg();
     _rpc.invoke_on_all(&rpc::server::start).get();
     vlog(_log.info, "Started RPC server listening at {}", conf.rpc_server());
+    end_phase("rpc");
 
     if (coproc_enabled()) {
         syschecks::systemd_message("Starting coproc RPC");
@@ -527,6 +559,7 @@ void application::start() {
           _log.info,
           "Started coproc RPC server listening at {}",
           conf.coproc_script_manager_server());
+        end_phase("coproc_rpc");
     }
 
     _quota_mgr.invoke_on_all(&kafka::quota_manager::start).get();
@@ -542,18 +575,55 @@ void application::start() {
             group_router,
             shard_table,
             partition_manager,
-            coordinator_ntp_mapper);
+            coordinator_ntp_mapper,
+            fetch_session_cache);
           s.set_protocol(std::move(proto));
       })
       .get();
     _kafka_server.invoke_on_all(&rpc::server::start).get();
     vlog(
       _log.info, "Started Kafka API server listening at {}", conf.kafka_api());
+    end_phase("kafka_api");
 
+    report_startup_timings();
     vlog(_log.info, "Successfully started Redpanda!");
     syschecks::systemd_notify_ready();
 }
 
+void application::report_startup_timings() {
+    std::chrono::milliseconds total{0};
+    for (auto& [phase, elapsed] : _startup_phases) {
+        total += elapsed;
+        vlog(_log.info, "Startup phase {} took {}ms", phase, elapsed.count());
+    }
+    vlog(_log.info, "Startup took {}ms", total.count());
+    storage
+      .invoke_on_all([this](storage::api& api) {
+          vlog(
+            _log.info,
+            "Storage recovery on shard {}: {}",
+            ss::this_shard_id(),
+            api.log_mgr().get_recovery_stats());
+      })
+      .get();
+
+    if (config::shard_local_cfg().disable_metrics()) {
+        return;
+    }
+    auto phase_label = ss::metrics::label("phase");
+    std::vector<ss::metrics::metric_definition> defs;
+    defs.reserve(_startup_phases.size());
+    for (auto& [phase, elapsed] : _startup_phases) {
+        defs.emplace_back(ss::metrics::make_gauge(
+          "startup_phase_ms",
+          [ms = elapsed.count()] { return ms; },
+          ss::metrics::description(
+            "Time in milliseconds spent in each startup phase"),
+          {phase_label(phase)}));
+    }
+    _metrics.add_group("application", defs);
+}
+
 void application::admin_register_raft_routes(ss::http_server& server) {
     ss::httpd::raft_json::transfer_leadership.set(
       server._routes, [this](std::unique_ptr<ss::httpd::request> req) {
@@ -18,6 +18,7 @@
 #include "config/configuration.h"
 #include "coproc/router.h"
 #include "coproc/service.h"
+#include "kafka/fetch_session_cache.h"
 #include "kafka/groups/coordinator_ntp_mapper.h"
 #include "kafka/groups/group_manager.h"
 #include "kafka/groups/group_router.h"
@@ -36,6 +37,9 @@
 #include <seastar/http/httpd.hh>
 #include <seastar/util/defer.hh>
 
+#include <chrono>
+#include <vector>
+
 namespace po = boost::program_options; // NOLINT
 using group_router_type = kafka::group_router<kafka::group_manager>;
 
@@ -65,6 +69,7 @@ public:
     ss::sharded<cluster::metadata_dissemination_service>
       md_dissemination_service;
     ss::sharded<kafka::coordinator_ntp_mapper> coordinator_ntp_mapper;
+    ss::sharded<kafka::fetch_session_cache> fetch_session_cache;
     std::unique_ptr<cluster::controller> controller;
 
 private:
@@ -98,6 +103,7 @@ private:
         _deferred.emplace_back([&s] { s->stop().get(); });
     }
     void setup_metrics();
+    void report_startup_timings();
     std::unique_ptr<ss::app_template> _app;
     scheduling_groups _scheduling_groups;
     smp_groups _smp_groups;
@@ -111,6 +117,8 @@ private:
     ss::sharded<kafka::quota_manager> _quota_mgr;
     ss::sharded<rpc::server> _kafka_server;
     ss::metrics::metric_groups _metrics;
+    std::vector<std::pair<ss::sstring, std::chrono::milliseconds>>
+      _startup_phases;
     // run these first on destruction
     deferred_actions _deferred;
 };
@@ -21,6 +21,19 @@ struct memory_groups {
         // 30%
         return ss::memory::stats().total_memory() * .30;
     }
+    /// kafka produce requests, carved out of kafka_total_memory()
+    static size_t kafka_produce_memory() {
+        return kafka_total_memory() * .60; // NOLINT
+    }
+    /// kafka fetch requests and their responses
+    static size_t kafka_fetch_memory() {
+        return kafka_total_memory() * .30; // NOLINT
+    }
+    /// every other kafka request, so that control requests (metadata, group
+    /// membership, offsets...) never queue behind data requests
+    static size_t kafka_control_memory() {
+        return kafka_total_memory() * .10; // NOLINT
+    }
     /// \brief includes raft & all services
     static size_t rpc_total_memory() {
         // 30%
@@ -42,8 +55,25 @@ struct memory_groups {
      * Upper bound on the amount of outstanding memory for inflight write
      * requests. Requests above this limit will wait for an existing chunk to be
      * returned to the cache.
+     *
+     * 30% of memory, less the extent cache's share.
      */
     static size_t chunk_cache_max_memory() {
-        return ss::memory::stats().total_memory() * .30; // NOLINT
+        return ss::memory::stats().total_memory() * .25; // NOLINT
+    }
+
+    /**
+     * Shard-wide pool from which segment appenders reserve their write-behind
+     * window. Sized to the chunk cache target so that the sum of all windows
+     * can be served from cached chunks.
+     */
+    static size_t segment_appender_write_behind_memory() {
+        return chunk_cache_min_memory();
+    }
+
+    /// upper bound for the shard-wide cache of raw segment file extents,
+    /// carved out of chunk_cache_max_memory()
+    static size_t extent_cache_max_memory() {
+        return ss::memory::stats().total_memory() * .05; // NOLINT
     }
 };
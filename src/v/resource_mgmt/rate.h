@@ -46,7 +46,11 @@ public:
         // update the current window
         maybe_advance_current(now);
         _windows[_current].count += v;
+        return measure(now);
+    }
 
+    // return the current rate in units/second without recording anything.
+    double measure(const clock::time_point& now) {
         // process historical samples
         double total = 0.;
         struct window* oldest = nullptr;
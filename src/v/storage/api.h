@@ -27,6 +27,7 @@ public:
         _kvstore = std::make_unique<kvstore>(_kv_conf);
         return _kvstore->start().then([this] {
             _log_mgr = std::make_unique<log_manager>(_log_conf, kvs());
+            _log_mgr->setup_metrics();
         });
     }
 
@@ -14,6 +14,8 @@
 
 #include <boost/iterator/counting_iterator.hpp>
 
+#include <algorithm>
+
 namespace storage::internal {
 
 class chunk_cache {
@@ -32,7 +34,9 @@ public:
 
     chunk_cache() noexcept
       : _size_target(memory_groups::chunk_cache_min_memory())
-      , _size_limit(memory_groups::chunk_cache_max_memory()) {}
+      , _size_limit(memory_groups::chunk_cache_max_memory())
+      , _write_behind_limit(
+          memory_groups::segment_appender_write_behind_memory()) {}
 
     chunk_cache(chunk_cache&&) = delete;
     chunk_cache& operator=(chunk_cache&&) = delete;
@@ -65,6 +69,13 @@ public:
         }
     }
 
+    /// whether get() can be served without waiting for a chunk to be
+    /// returned to the cache
+    bool available() const {
+        return !_sem.waiters()
+               && (!_chunks.empty() || _size_total < _size_limit);
+    }
+
     ss::future<chunk_ptr> get() {
         // don't steal if there are waiters
         if (!_sem.waiters()) {
@@ -74,6 +85,28 @@ public:
           [this](ss::semaphore_units<>) { return do_get(); });
     }
 
+    /**
+     * Reserves up to `bytes` of write-behind memory from the shard-wide pool,
+     * rounded down to whole chunks. At least one chunk is always granted so
+     * that an appender can make progress when the pool is exhausted.
+     */
+    size_t reserve_write_behind(size_t bytes) {
+        const size_t left = _write_behind_limit > _write_behind_reserved
+                              ? _write_behind_limit - _write_behind_reserved
+                              : 0;
+        const size_t granted = std::max(
+          std::min(bytes, left) / chunk::chunk_size * chunk::chunk_size,
+          chunk::chunk_size);
+        _write_behind_reserved += granted;
+        return granted;
+    }
+
+    void release_write_behind(size_t bytes) {
+        _write_behind_reserved -= bytes;
+    }
+
+    size_t write_behind_reserved() const { return _write_behind_reserved; }
+
 private:
     ss::future<chunk_ptr> do_get() {
         if (auto c = pop_or_allocate(); c) {
@@ -109,6 +142,8 @@ private:
     size_t _size_total{0};
     const size_t _size_target;
     const size_t _size_limit;
+    size_t _write_behind_reserved{0};
+    const size_t _write_behind_limit;
 };
 
 inline chunk_cache& chunks() {
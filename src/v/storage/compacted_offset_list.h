@@ -34,6 +34,8 @@ public:
     ~compacted_offset_list() noexcept = default;
 
     bool contains(model::offset) const;
+    /// number of offsets to keep in [first, last]
+    size_t count(model::offset first, model::offset last) const;
     void add(model::offset);
 
 private:
@@ -55,6 +57,13 @@ inline bool compacted_offset_list::contains(model::offset o) const {
     const uint32_t x = (o - _base)();
     return _to_keep.contains(x);
 }
+inline size_t
+compacted_offset_list::count(model::offset first, model::offset last) const {
+    const uint32_t lo = (first - _base)();
+    const uint32_t hi = (last - _base)();
+    const uint64_t below = lo == 0 ? 0 : _to_keep.rank(lo - 1);
+    return _to_keep.rank(hi) - below;
+}
 inline std::ostream&
 operator<<(std::ostream& o, const compacted_offset_list& l) {
     return o << "{base:" << l._base
@@ -25,6 +25,7 @@
 #include <boost/range/irange.hpp>
 
 #include <algorithm>
+#include <chrono>
 #include <exception>
 
 namespace storage::internal {
@@ -226,37 +227,51 @@ ss::future<ss::stop_iteration> copy_data_segment_reducer::do_compaction(
         return ss::make_ready_future<stop_t>(stop_t::no);
     }
     return compress_batch(original, std::move(to_copy.value()))
-      .then([this](model::record_batch&& b) {
-          return ss::do_with(std::move(b), [this](model::record_batch& batch) {
-              auto const start_offset = _appender->file_byte_offset();
-              auto const header_size = batch.header().size_bytes;
-              _acc += header_size;
-              if (_idx.maybe_index(
-                    _acc,
-                    32_KiB,
-                    start_offset,
-                    batch.base_offset(),
-                    batch.last_offset(),
-                    batch.header().first_timestamp,
-                    batch.header().max_timestamp)) {
-                  _acc = 0;
-              }
-              return storage::write(*_appender, batch)
-                .then([this, start_offset, header_size] {
-                    vassert(
-                      _appender->file_byte_offset()
-                        == start_offset + header_size,
-                      "Size must be deterministic. Expected:{} == {}",
-                      _appender->file_byte_offset(),
-                      start_offset + header_size);
-                });
-          });
-      })
+      .then([this](model::record_batch&& b) { return write(std::move(b)); })
       .then([] { return ss::make_ready_future<stop_t>(stop_t::no); });
 }
 
+ss::future<> copy_data_segment_reducer::write(model::record_batch&& b) {
+    return ss::do_with(std::move(b), [this](model::record_batch& batch) {
+        auto const start_offset = _appender->file_byte_offset();
+        auto const header_size = batch.header().size_bytes;
+        _acc += header_size;
+        if (_idx.maybe_index(
+              _acc,
+              32_KiB,
+              start_offset,
+              batch.base_offset(),
+              batch.last_offset(),
+              batch.header().first_timestamp,
+              batch.header().max_timestamp)) {
+            _acc = 0;
+        }
+        return storage::write(*_appender, batch)
+          .then([this, start_offset, header_size] {
+              vassert(
+                _appender->file_byte_offset() == start_offset + header_size,
+                "Size must be deterministic. Expected:{} == {}",
+                _appender->file_byte_offset(),
+                start_offset + header_size);
+          });
+    });
+}
+
 ss::future<ss::stop_iteration>
 copy_data_segment_reducer::operator()(model::record_batch&& b) {
+    using stop_t = ss::stop_iteration;
+    // the offset list comes from the key index, which has an entry for every
+    // record of the segment. when it keeps all or none of the records of a
+    // batch there is no need to open the batch up
+    const auto kept = _list.count(b.base_offset(), b.last_offset());
+    if (kept == 0) {
+        skipped(b);
+        return ss::make_ready_future<stop_t>(stop_t::no);
+    }
+    if (kept >= static_cast<size_t>(b.record_count())) {
+        skipped(b);
+        return write(std::move(b)).then([] { return stop_t::no; });
+    }
     const auto comp = b.header().attrs.compression();
     if (!b.compressed()) {
         return do_compaction(comp, std::move(b));
@@ -267,6 +282,66 @@ copy_data_segment_reducer::operator()(model::record_batch&& b) {
       });
 }
 
+ss::future<model::record_batch>
+recompress_segment_reducer::recompress(model::record_batch&& b) {
+    const auto size_before = b.size_bytes();
+    const auto start = std::chrono::steady_clock::now();
+    auto f = b.compressed()
+               ? decompress_batch(std::move(b))
+               : ss::make_ready_future<model::record_batch>(std::move(b));
+    return f
+      .then([this](model::record_batch&& b) {
+          return compress_batch(_codec, std::move(b));
+      })
+      .then([this, size_before, start](model::record_batch&& b) {
+          ++_recompressed;
+          _probe->batch_recompressed(
+            size_before,
+            b.size_bytes(),
+            std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - start));
+          return std::move(b);
+      });
+}
+
+ss::future<> recompress_segment_reducer::write(model::record_batch&& b) {
+    return ss::do_with(std::move(b), [this](model::record_batch& batch) {
+        auto const start_offset = _appender->file_byte_offset();
+        auto const header_size = batch.header().size_bytes;
+        _acc += header_size;
+        if (_idx.maybe_index(
+              _acc,
+              32_KiB,
+              start_offset,
+              batch.base_offset(),
+              batch.last_offset(),
+              batch.header().first_timestamp,
+              batch.header().max_timestamp)) {
+            _acc = 0;
+        }
+        return storage::write(*_appender, batch)
+          .then([this, start_offset, header_size] {
+              vassert(
+                _appender->file_byte_offset() == start_offset + header_size,
+                "Size must be deterministic. Expected:{} == {}",
+                _appender->file_byte_offset(),
+                start_offset + header_size);
+          });
+    });
+}
+
+ss::future<ss::stop_iteration>
+recompress_segment_reducer::operator()(model::record_batch&& b) {
+    // raft configurations and other internal batches stay as written
+    const bool keep = b.header().type != model::data_record_batch_type
+                      || b.header().attrs.compression() == _codec;
+    auto f = keep ? ss::make_ready_future<model::record_batch>(std::move(b))
+                  : recompress(std::move(b));
+    return f
+      .then([this](model::record_batch&& b) { return write(std::move(b)); })
+      .then([] { return ss::stop_iteration::no; });
+}
+
 ss::future<ss::stop_iteration>
 index_rebuilder_reducer::operator()(model::record_batch&& b) {
     using stop_t = ss::stop_iteration;
@@ -17,6 +17,7 @@
 #include "storage/compacted_offset_list.h"
 #include "storage/index_state.h"
 #include "storage/logger.h"
+#include "storage/probe.h"
 #include "storage/segment_appender.h"
 #include "units.h"
 
@@ -92,9 +93,11 @@ private:
 
 class copy_data_segment_reducer : public compaction_reducer {
 public:
-    copy_data_segment_reducer(compacted_offset_list l, segment_appender* a)
+    copy_data_segment_reducer(
+      compacted_offset_list l, segment_appender* a, storage::probe& pb)
       : _list(std::move(l))
-      , _appender(a) {}
+      , _appender(a)
+      , _probe(&pb) {}
 
     ss::future<ss::stop_iteration> operator()(model::record_batch&&);
     storage::index_state end_of_stream() { return std::move(_idx); }
@@ -102,6 +105,12 @@ public:
 private:
     ss::future<ss::stop_iteration>
     do_compaction(model::compression, model::record_batch&&);
+    ss::future<> write(model::record_batch&&);
+    void skipped(const model::record_batch& b) {
+        if (b.compressed()) {
+            _probe->compressed_batch_not_decompressed();
+        }
+    }
 
     bool should_keep(model::offset base, int32_t delta) const {
         const auto o = base + model::offset(delta);
@@ -111,8 +120,42 @@ private:
 
     compacted_offset_list _list;
     segment_appender* _appender;
+    storage::probe* _probe;
+    index_state _idx;
+    size_t _acc{0};
+};
+
+/// rewrites the data batches of a segment in the given codec, e.g. the codec
+/// configured for their topic. other batches are copied as they are
+class recompress_segment_reducer : public compaction_reducer {
+public:
+    struct result {
+        storage::index_state idx;
+        // number of batches that changed codec
+        size_t recompressed{0};
+    };
+
+    recompress_segment_reducer(
+      model::compression c, segment_appender* a, storage::probe& pb) noexcept
+      : _codec(c)
+      , _appender(a)
+      , _probe(&pb) {}
+
+    ss::future<ss::stop_iteration> operator()(model::record_batch&&);
+    result end_of_stream() {
+        return result{.idx = std::move(_idx), .recompressed = _recompressed};
+    }
+
+private:
+    ss::future<model::record_batch> recompress(model::record_batch&&);
+    ss::future<> write(model::record_batch&&);
+
+    model::compression _codec;
+    segment_appender* _appender;
+    storage::probe* _probe;
     index_state _idx;
     size_t _acc{0};
+    size_t _recompressed{0};
 };
 
 class index_rebuilder_reducer : public compaction_reducer {
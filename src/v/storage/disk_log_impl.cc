@@ -9,6 +9,7 @@
 
 #include "storage/disk_log_impl.h"
 
+#include "config/configuration.h"
 #include "model/adl_serde.h"
 #include "model/fundamental.h"
 #include "model/timeout_clock.h"
@@ -47,7 +48,9 @@ disk_log_impl::disk_log_impl(
   , _kvstore(kvstore)
   , _start_offset(read_start_offset())
   , _lock_mngr(_segs)
-  , _max_segment_size(internal::jitter_segment_size(max_segment_size())) {
+  , _max_segment_size(internal::jitter_segment_size(max_segment_size()))
+  , _tail(std::make_unique<tail_buffer>(
+      config::shard_local_cfg().log_tail_buffer_max_bytes())) {
     const bool is_compacted = config().is_compacted();
     for (auto& s : _segs) {
         _probe.add_initial_segment(*s);
@@ -64,6 +67,7 @@ disk_log_impl::~disk_log_impl() {
 ss::future<> disk_log_impl::remove() {
     vassert(!_closed, "Invalid double closing of log - {}", *this);
     _closed = true;
+    _tail->set_enabled(false);
     // gets all the futures started in the background
     std::vector<ss::future<>> permanent_delete;
     permanent_delete.reserve(_segs.size());
@@ -82,20 +86,40 @@ ss::future<> disk_log_impl::remove() {
       .then([this] {
           return _kvstore.remove(
             kvstore::key_space::storage, start_offset_key());
+      })
+      .then([this] {
+          return remove_clean_segment_marker(_kvstore, config().ntp());
       });
 }
 ss::future<> disk_log_impl::close() {
     vassert(!_closed, "Invalid double closing of log - {}", *this);
     _closed = true;
+    _tail->set_enabled(false);
     if (
       _eviction_monitor
       && !_eviction_monitor->promise.get_future().available()) {
         _eviction_monitor->promise.set_exception(segment_closed_exception());
     }
-    return ss::parallel_for_each(_segs, [](ss::lw_shared_ptr<segment>& h) {
-        return h->close().handle_exception([h](std::exception_ptr e) {
-            vlog(stlog.error, "Error closing segment:{} - {}", e, h);
-        });
+    return ss::do_with(true, [this](bool& clean) {
+        return ss::parallel_for_each(
+                 _segs,
+                 [&clean](ss::lw_shared_ptr<segment>& h) {
+                     return h->close().handle_exception(
+                       [h, &clean](std::exception_ptr e) {
+                           clean = false;
+                           vlog(
+                             stlog.error,
+                             "Error closing segment:{} - {}",
+                             e,
+                             h);
+                       });
+                 })
+          .then([this, &clean] {
+              if (!clean) {
+                  return ss::now();
+              }
+              return write_clean_segment_marker();
+          });
     });
 }
 
@@ -275,9 +299,29 @@ ss::future<> disk_log_impl::compact(compaction_config cfg) {
     if (config().is_compacted() && !_segs.empty()) {
         f = f.then([this, cfg] { return do_compact(cfg); });
     }
+    if (config().has_overrides() && config().get_overrides().compression) {
+        f = f.then([this, cfg] {
+            return do_recompress(*config().get_overrides().compression, cfg);
+        });
+    }
     return f;
 }
 
+ss::future<>
+disk_log_impl::do_recompress(model::compression codec, compaction_config cfg) {
+    // one segment per round, like self compaction
+    auto segit = std::find_if(
+      _segs.begin(), _segs.end(), [](ss::lw_shared_ptr<segment>& s) {
+          return !s->has_appender() && !s->finished_recompression();
+      });
+    if (segit == _segs.end()) {
+        return ss::now();
+    }
+    auto seg = *segit;
+    return storage::internal::recompress_segment(seg, codec, cfg, _probe)
+      .finally([seg] { seg->mark_as_finished_recompression(); });
+}
+
 ss::future<> disk_log_impl::gc(compaction_config cfg) {
     vassert(!_closed, "gc on closed log - {}", *this);
 
@@ -382,7 +426,17 @@ ss::future<> disk_log_impl::new_segment(
   model::offset o, model::term_id t, ss::io_priority_class pc) {
     vassert(
       o() >= 0 && t() >= 0, "offset:{} and term:{} must be initialized", o, t);
-    return _manager.make_log_segment(config(), o, t, pc)
+    // size the new segment's appender for the rate this log sees
+    const auto rate = static_cast<size_t>(_probe.sample_append_rate());
+    return _manager
+      .make_log_segment(
+        config(),
+        o,
+        t,
+        pc,
+        record_version_type::v1,
+        default_segment_readahead_size,
+        rate)
       .then([this](ss::lw_shared_ptr<segment> handles) mutable {
           return remove_empty_segments().then(
             [this, h = std::move(handles)]() mutable {
@@ -429,7 +483,20 @@ ss::future<> disk_log_impl::flush() {
     if (_segs.empty()) {
         return ss::make_ready_future<>();
     }
-    return _segs.back()->flush();
+    return _segs.back()->flush().then([this] {
+        account_dma_writes(*_segs.back());
+        auto committed = offsets().committed_offset;
+        if (committed != _last_notified_offset) {
+            _last_notified_offset = committed;
+            _manager.notify_flushed(config().ntp(), committed);
+        }
+    });
+}
+
+void disk_log_impl::account_dma_writes(segment& s) {
+    if (s.has_appender()) {
+        _probe.add_dma_bytes_written(s.appender().take_dma_bytes_written());
+    }
 }
 
 size_t disk_log_impl::max_segment_size() const {
@@ -475,6 +542,7 @@ ss::future<> disk_log_impl::maybe_roll(
         size_should_roll = true;
     }
     if (t != term() || size_should_roll) {
+        account_dma_writes(*ptr);
         return ptr->release_appender().then([this, next_offset, t, iopc] {
             return new_segment(next_offset, t, iopc);
         });
@@ -505,6 +573,64 @@ disk_log_impl::make_reader(log_reader_config config) {
     return make_unchecked_reader(config);
 }
 
+ss::future<raw_read_result>
+disk_log_impl::read_raw(log_reader_config config, use_batch_cache cache) {
+    vassert(!_closed, "read_raw on closed log - {}", *this);
+    if (config.start_offset < _start_offset) {
+        return ss::make_exception_future<raw_read_result>(
+          std::runtime_error(fmt::format(
+            "Reader cannot read before start of the log {} < {}",
+            config.start_offset,
+            _start_offset)));
+    }
+    return _lock_mngr.range_lock(config).then(
+      [this, config, cache](std::unique_ptr<lock_manager::lease> lease) {
+          struct state {
+              std::unique_ptr<lock_manager::lease> lease;
+              log_reader_config config;
+              raw_read_result result;
+          };
+          return ss::do_with(
+            state{.lease = std::move(lease), .config = config},
+            [this, cache](state& st) {
+                return ss::do_for_each(
+                         st.lease->range,
+                         [this, cache, &st](ss::lw_shared_ptr<segment>& seg) {
+                             auto& cfg = st.config;
+                             if (
+                               cfg.start_offset > cfg.max_offset
+                               || cfg.bytes_consumed >= cfg.max_bytes
+                               || cfg.over_budget
+                               || cfg.start_offset
+                                    > seg->offsets().dirty_offset) {
+                                 return ss::now();
+                             }
+                             auto rdr = std::make_unique<raw_segment_reader>(
+                               *seg, cfg, st.result, _probe, cache);
+                             auto f = rdr->read();
+                             return f.finally([rdr = std::move(rdr)] {});
+                         })
+                  .then([this, &st] {
+                      _probe.add_batches_read(st.result.batches.size());
+                      return std::move(st.result);
+                  });
+            });
+      });
+}
+
+std::optional<raw_read_result>
+disk_log_impl::read_tail(log_reader_config config) {
+    vassert(!_closed, "read_tail on closed log - {}", *this);
+    if (config.start_offset < _start_offset) {
+        return std::nullopt;
+    }
+    auto ret = _tail->read(config);
+    if (ret) {
+        _probe.add_batches_read(ret->batches.size());
+    }
+    return ret;
+}
+
 ss::future<model::record_batch_reader>
 disk_log_impl::make_reader(timequery_config config) {
     vassert(!_closed, "make_reader on closed log - {}", *this);
@@ -512,9 +638,13 @@ disk_log_impl::make_reader(timequery_config config) {
       [this, cfg = config](std::unique_ptr<lock_manager::lease> lease) {
           auto start_offset = _start_offset;
           if (!lease->range.empty()) {
+              auto& seg = *lease->range.begin();
               // adjust for partial visibility of segment prefix
-              start_offset = std::max(
-                start_offset, (*lease->range.begin())->offsets().base_offset);
+              start_offset = std::max(start_offset, seg->offsets().base_offset);
+              // skip the part of the segment older than the query
+              if (auto e = seg->index().find_nearest(cfg.time); e) {
+                  start_offset = std::max(start_offset, e->offset);
+              }
           }
           log_reader_config config(
             start_offset,
@@ -623,6 +753,7 @@ ss::future<> disk_log_impl::do_truncate_prefix(truncate_prefix_config cfg) {
     if (cfg.start_offset <= _start_offset) {
         return ss::make_ready_future<>();
     }
+    _tail->prefix_truncate(cfg.start_offset);
 
     /*
      * Persist the desired starting offset
@@ -697,6 +828,8 @@ ss::future<> disk_log_impl::do_truncate(truncate_config cfg) {
     if (cfg.base_offset > stats.dirty_offset) {
         return ss::make_ready_future<>();
     }
+    // stop serving the truncated suffix right away
+    _tail->truncate(cfg.base_offset);
     if (_segs.empty()) {
         return ss::make_ready_future<>();
     }
@@ -788,6 +921,54 @@ model::offset disk_log_impl::read_start_offset() const {
     return model::offset{};
 }
 
+bytes disk_log_impl::clean_segment_key(const model::ntp& ntp) {
+    iobuf buf;
+    reflection::serialize(buf, kvstore_key_type::clean_segment, ntp);
+    return iobuf_to_bytes(buf);
+}
+
+ss::future<> disk_log_impl::write_clean_segment_marker() {
+    if (_segs.empty()) {
+        return ss::now();
+    }
+    auto& last = *_segs.back();
+    clean_segment_marker marker{
+      .base_offset = last.offsets().base_offset,
+      .dirty_offset = last.offsets().dirty_offset,
+      .size_bytes = last.size_bytes(),
+    };
+    return write_clean_segment_marker(_kvstore, config().ntp(), marker)
+      .handle_exception([this](std::exception_ptr e) {
+          vlog(
+            stlog.warn,
+            "Unable to persist clean close marker for {} - {}",
+            config().ntp(),
+            e);
+      });
+}
+
+std::optional<clean_segment_marker> disk_log_impl::read_clean_segment_marker(
+  kvstore& kvs, const model::ntp& ntp) {
+    auto value = kvs.get(kvstore::key_space::storage, clean_segment_key(ntp));
+    if (!value) {
+        return std::nullopt;
+    }
+    return reflection::adl<clean_segment_marker>{}.from(std::move(*value));
+}
+
+ss::future<> disk_log_impl::write_clean_segment_marker(
+  kvstore& kvs, const model::ntp& ntp, clean_segment_marker marker) {
+    return kvs.put(
+      kvstore::key_space::storage,
+      clean_segment_key(ntp),
+      reflection::to_iobuf(marker));
+}
+
+ss::future<> disk_log_impl::remove_clean_segment_marker(
+  kvstore& kvs, const model::ntp& ntp) {
+    return kvs.remove(kvstore::key_space::storage, clean_segment_key(ntp));
+}
+
 std::ostream& disk_log_impl::print(std::ostream& o) const {
     return o << "{offsets:" << offsets()
              << ", max_collectible_offset: " << _max_collectible_offset
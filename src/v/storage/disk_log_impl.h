@@ -20,7 +20,9 @@
 #include "storage/log_reader.h"
 #include "storage/probe.h"
 #include "storage/segment_appender.h"
+#include "storage/tail_buffer.h"
 #include "storage/segment_reader.h"
+#include "storage/segment_set.h"
 #include "storage/types.h"
 
 #include <seastar/core/abort_source.hh>
@@ -54,6 +56,12 @@ public:
 
     ss::future<model::record_batch_reader> make_reader(log_reader_config) final;
     ss::future<model::record_batch_reader> make_reader(timequery_config);
+    ss::future<raw_read_result>
+      read_raw(log_reader_config, use_batch_cache) final;
+    std::optional<raw_read_result> read_tail(log_reader_config) final;
+    void set_tail_buffer_enabled(bool enabled) final {
+        _tail->set_enabled(enabled);
+    }
     // External synchronization: only one append can be performed at a time.
     log_appender make_appender(log_append_config cfg) final;
     /// timequery
@@ -73,6 +81,17 @@ public:
     const segment_set& segments() const { return _segs; }
     size_t bytes_left_before_roll() const;
 
+    /// clean-close marker left by the previous close() of the log, if any
+    static std::optional<clean_segment_marker>
+    read_clean_segment_marker(kvstore&, const model::ntp&);
+    /// persisted by close() once every segment closed without error
+    static ss::future<> write_clean_segment_marker(
+      kvstore&, const model::ntp&, clean_segment_marker);
+    /// must be removed before the log accepts writes again so that a crash
+    /// forces the last segment to be replayed
+    static ss::future<>
+    remove_clean_segment_marker(kvstore&, const model::ntp&);
+
 private:
     friend class disk_log_appender; // for multi-term appends
     friend class disk_log_builder;  // for tests
@@ -81,6 +100,7 @@ private:
     // key types used to store data in key-value store
     enum class kvstore_key_type : int8_t {
         start_offset = 0,
+        clean_segment = 1,
     };
 
     ss::future<model::record_batch_reader>
@@ -88,8 +108,11 @@ private:
 
     bytes start_offset_key() const;
     model::offset read_start_offset() const;
+    static bytes clean_segment_key(const model::ntp&);
+    ss::future<> write_clean_segment_marker();
 
     ss::future<> do_compact(compaction_config);
+    ss::future<> do_recompress(model::compression, compaction_config);
     ss::future<> gc(compaction_config);
 
     ss::future<> remove_empty_segments();
@@ -122,6 +145,8 @@ private:
 
 private:
     size_t max_segment_size() const;
+    /// moves the bytes the active appender submitted to disk into the probe
+    void account_dma_writes(segment&);
     struct eviction_monitor {
         ss::promise<model::offset> promise;
         ss::abort_source::subscription subscription;
@@ -136,7 +161,11 @@ private:
     failure_probes _failure_probes;
     std::optional<eviction_monitor> _eviction_monitor;
     model::offset _max_collectible_offset;
+    // last committed offset published through log_manager::notify_flushed
+    model::offset _last_notified_offset;
     size_t _max_segment_size;
+    // heap allocated so that its address is stable for the registry
+    std::unique_ptr<tail_buffer> _tail;
 };
 
 } // namespace storage
@@ -0,0 +1,83 @@
+// Copyright 2020 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "storage/extent_cache.h"
+
+#include <algorithm>
+
+namespace storage::internal {
+
+extent_cache::extent_cache() noexcept
+  : _max_size(memory_groups::extent_cache_max_memory())
+  , _reclaimer(
+      [this](reclaimer::request r) { return reclaim(r); },
+      ss::memory::reclaimer_scope::async) {}
+
+std::optional<ss::temporary_buffer<char>>
+extent_cache::get(uint64_t file, uint64_t idx) {
+    auto it = _extents.find(key(file, idx));
+    if (it == _extents.end()) {
+        ++_misses;
+        return std::nullopt;
+    }
+    ++_hits;
+    auto& e = *it->second;
+    // most recently used goes to the back
+    e.hook.unlink();
+    _lru.push_back(e);
+    return e.buf.share();
+}
+
+void extent_cache::put(uint64_t file, uint64_t idx, const char* data) {
+    if (!_enabled || _max_size < extent_size || !_files.contains(file)) {
+        return;
+    }
+    if (_size_bytes + extent_size > _max_size) {
+        evict(_size_bytes + extent_size - _max_size);
+    }
+    auto k = key(file, idx);
+    auto [it, inserted] = _extents.emplace(k, nullptr);
+    if (!inserted) {
+        // a concurrent reader cached it first
+        return;
+    }
+    it->second = std::make_unique<entry>(
+      k, ss::temporary_buffer<char>(data, extent_size));
+    _lru.push_back(*it->second);
+    _size_bytes += extent_size;
+}
+
+void extent_cache::invalidate(uint64_t file, uint64_t from) {
+    auto it = _extents.lower_bound(key(file, from));
+    auto end = _extents.lower_bound(key(file + 1, 0));
+    _size_bytes -= std::distance(it, end) * extent_size;
+    _extents.erase(it, end);
+}
+
+void extent_cache::evict(size_t bytes) {
+    size_t evicted = 0;
+    while (evicted < bytes && !_lru.empty()) {
+        const auto k = _lru.front().k;
+        _lru.pop_front();
+        _extents.erase(k);
+        evicted += extent_size;
+        ++_evictions;
+    }
+    _size_bytes -= evicted;
+}
+
+extent_cache::reclaim_result extent_cache::reclaim(reclaimer::request r) {
+    if (_lru.empty()) {
+        return reclaim_result::reclaimed_nothing;
+    }
+    evict(std::max(r.bytes_to_reclaim, min_reclaim_size));
+    return reclaim_result::reclaimed_something;
+}
+
+} // namespace storage::internal
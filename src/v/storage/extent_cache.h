@@ -0,0 +1,126 @@
+/*
+ * Copyright 2020 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+#include "resource_mgmt/memory_groups.h"
+#include "seastarx.h"
+#include "units.h"
+#include "utils/intrusive_list_helpers.h"
+
+#include <seastar/core/memory.hh>
+#include <seastar/core/temporary_buffer.hh>
+
+#include <absl/container/btree_map.h>
+#include <absl/container/btree_set.h>
+
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace storage::internal {
+
+/**
+ * Shard-wide cache of raw segment file extents, sitting underneath the batch
+ * parser. Where the batch cache holds recently written or read batches per
+ * segment, this cache holds the aligned file extents themselves so that many
+ * consumers replaying the same historical data share one copy of it and one
+ * disk read.
+ *
+ * Entries are keyed by (file id, extent index). Each entry owns its own copy
+ * of the extent, never a slice of a larger read, so that the bytes it pins
+ * are the bytes it accounts for. Cached buffers are shared with readers, so
+ * evicting an entry only drops the cache's reference and is safe at any time.
+ * Memory is bounded by its own memory group and is given back to seastar
+ * through an asynchronous reclaimer.
+ */
+class extent_cache {
+    using reclaimer = ss::memory::reclaimer;
+    using reclaim_result = ss::memory::reclaiming_result;
+
+public:
+    static constexpr size_t extent_size = 64_KiB;
+    /// minimum size reclaimed in low-memory situations
+    static constexpr size_t min_reclaim_size = 1_MiB;
+
+    extent_cache() noexcept;
+    extent_cache(extent_cache&&) = delete;
+    extent_cache& operator=(extent_cache&&) = delete;
+    extent_cache(const extent_cache&) = delete;
+    extent_cache& operator=(const extent_cache&) = delete;
+    ~extent_cache() noexcept = default;
+
+    void set_enabled(bool enabled) {
+        _enabled = enabled;
+        if (!_enabled) {
+            evict(_size_bytes);
+        }
+    }
+    bool enabled() const { return _enabled; }
+
+    /// a new id for a file whose extents are cached
+    uint64_t register_file() {
+        _files.insert(++_next_file_id);
+        return _next_file_id;
+    }
+    /// drops every extent of the file; reads of it still in flight will not
+    /// cache anything
+    void unregister_file(uint64_t file) {
+        _files.erase(file);
+        invalidate(file);
+    }
+
+    /// the cached extent, if any
+    std::optional<ss::temporary_buffer<char>> get(uint64_t file, uint64_t idx);
+    /// caches a copy of a full extent of a registered file
+    void put(uint64_t file, uint64_t idx, const char* data);
+    /// drops every extent of the file starting at extent `from`
+    void invalidate(uint64_t file, uint64_t from = 0);
+
+    size_t size_bytes() const { return _size_bytes; }
+    uint64_t hits() const { return _hits; }
+    uint64_t misses() const { return _misses; }
+    uint64_t evictions() const { return _evictions; }
+
+private:
+    using key = std::pair<uint64_t, uint64_t>;
+
+    struct entry {
+        entry(key k, ss::temporary_buffer<char> b) noexcept
+          : k(k)
+          , buf(std::move(b)) {}
+
+        key k;
+        ss::temporary_buffer<char> buf;
+        intrusive_list_hook hook;
+    };
+
+    void evict(size_t bytes);
+    reclaim_result reclaim(reclaimer::request);
+
+    absl::btree_map<key, std::unique_ptr<entry>> _extents;
+    intrusive_list<entry, &entry::hook> _lru;
+    absl::btree_set<uint64_t> _files;
+    size_t _size_bytes{0};
+    const size_t _max_size;
+    uint64_t _next_file_id{0};
+    bool _enabled{true};
+    uint64_t _hits{0};
+    uint64_t _misses{0};
+    uint64_t _evictions{0};
+    reclaimer _reclaimer;
+};
+
+inline extent_cache& extents() {
+    static thread_local extent_cache cache;
+    return cache;
+}
+
+} // namespace storage::internal
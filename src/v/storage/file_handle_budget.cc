@@ -0,0 +1,113 @@
+// Copyright 2020 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "storage/file_handle_budget.h"
+
+#include "storage/logger.h"
+#include "storage/segment.h"
+#include "storage/segment_utils.h"
+#include "vassert.h"
+#include "vlog.h"
+
+namespace storage::internal {
+
+lazy_file_handle::lazy_file_handle(
+  ss::sstring path, debug_sanitize_files sanitize) noexcept
+  : _path(std::move(path))
+  , _sanitize(sanitize) {}
+
+lazy_file_handle::lazy_file_handle(ss::sstring path, ss::file f) noexcept
+  : _path(std::move(path))
+  , _file(std::move(f)) {
+    file_handles().opened();
+    file_handles().idle(*this);
+}
+
+lazy_file_handle::~lazy_file_handle() noexcept {
+    if (_file) {
+        file_handles().closed();
+    }
+}
+
+ss::future<ss::file> lazy_file_handle::get() {
+    if (_closed) {
+        return ss::make_exception_future<ss::file>(segment_closed_exception());
+    }
+    ++_users;
+    _hook.unlink();
+    return _open_mutex.with([this] { return do_open(); })
+      .then_wrapped([self = shared_from_this()](ss::future<> f) {
+          if (f.failed()) {
+              self->put();
+              return ss::make_exception_future<ss::file>(f.get_exception());
+          }
+          return ss::make_ready_future<ss::file>(*self->_file);
+      });
+}
+
+void lazy_file_handle::put() {
+    vassert(_users > 0, "Unbalanced release of file handle {}", _path);
+    if (--_users == 0 && _file && !_closed) {
+        file_handles().idle(*this);
+    }
+}
+
+ss::future<> lazy_file_handle::do_open() {
+    if (_file) {
+        return ss::now();
+    }
+    return make_reader_handle(std::filesystem::path(_path), _sanitize)
+      .then([this](ss::file f) {
+          _file = std::move(f);
+          file_handles().opened();
+      });
+}
+
+void lazy_file_handle::evict() {
+    vassert(_users == 0, "Cannot evict file handle in use {}", _path);
+    auto f = std::move(*_file);
+    _file.reset();
+    file_handles().closed();
+    _pending_close = _pending_close
+                       .then([f]() mutable {
+                           return f.close().finally([f] {});
+                       })
+                       .handle_exception([path = _path](std::exception_ptr e) {
+                           vlog(
+                             stlog.warn,
+                             "Error closing evicted file handle {} - {}",
+                             path,
+                             e);
+                       });
+}
+
+ss::future<> lazy_file_handle::close() {
+    _closed = true;
+    _hook.unlink();
+    auto pending = std::exchange(_pending_close, ss::now());
+    if (!_file) {
+        return pending;
+    }
+    auto f = std::move(*_file);
+    _file.reset();
+    file_handles().closed();
+    return pending.then(
+      [f]() mutable { return f.close().finally([f] {}); });
+}
+
+void file_handle_budget::maybe_evict() {
+    while (_open_files > _limit && !_idle.empty()) {
+        auto& h = _idle.front();
+        _idle.pop_front();
+        ++_evictions;
+        h.evict();
+    }
+}
+
+} // namespace storage::internal
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2020 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+#include "seastarx.h"
+#include "storage/types.h"
+#include "utils/intrusive_list_helpers.h"
+#include "utils/mutex.h"
+
+#include <seastar/core/file.hh>
+#include <seastar/core/future.hh>
+#include <seastar/core/shared_ptr.hh>
+#include <seastar/core/sstring.hh>
+
+#include <optional>
+
+namespace storage::internal {
+
+/**
+ * A read-only segment file handle that is opened on first use. While no
+ * stream holds the handle it sits in the per-shard idle list of the
+ * file_handle_budget, which closes the least recently used idle handles
+ * whenever the shard goes over its open file budget. A closed handle is
+ * transparently re-opened by the next get().
+ */
+class lazy_file_handle
+  : public ss::enable_lw_shared_from_this<lazy_file_handle> {
+public:
+    lazy_file_handle(ss::sstring path, debug_sanitize_files) noexcept;
+    /// adopts an already open handle
+    lazy_file_handle(ss::sstring path, ss::file) noexcept;
+    ~lazy_file_handle() noexcept;
+    lazy_file_handle(lazy_file_handle&&) = delete;
+    lazy_file_handle& operator=(lazy_file_handle&&) = delete;
+    lazy_file_handle(const lazy_file_handle&) = delete;
+    lazy_file_handle& operator=(const lazy_file_handle&) = delete;
+
+    /// pins the handle, opening it if needed. every successful get() must
+    /// be paired with a put()
+    ss::future<ss::file> get();
+    void put();
+
+    /// closes the handle for good
+    ss::future<> close();
+
+    bool is_open() const { return _file.has_value(); }
+    const ss::sstring& path() const { return _path; }
+
+private:
+    friend class file_handle_budget;
+
+    ss::future<> do_open();
+    /// closes the handle in the background if it is idle
+    void evict();
+
+    ss::sstring _path;
+    debug_sanitize_files _sanitize{debug_sanitize_files::no};
+    std::optional<ss::file> _file;
+    size_t _users{0};
+    bool _closed{false};
+    mutex _open_mutex;
+    ss::future<> _pending_close = ss::now();
+    intrusive_list_hook _hook;
+};
+
+/**
+ * Per-shard budget of open segment reader files. Only idle handles are
+ * ever closed, so the budget can be exceeded temporarily while more
+ * streams than the limit are reading concurrently.
+ */
+class file_handle_budget {
+public:
+    static constexpr size_t default_max_open_files = 4096;
+
+    void set_limit(size_t limit) {
+        _limit = limit;
+        maybe_evict();
+    }
+
+    size_t open_files() const { return _open_files; }
+    size_t opens() const { return _opens; }
+    size_t evictions() const { return _evictions; }
+
+private:
+    friend class lazy_file_handle;
+
+    void opened() {
+        ++_open_files;
+        ++_opens;
+        maybe_evict();
+    }
+    void closed() { --_open_files; }
+    void idle(lazy_file_handle& h) {
+        _idle.push_back(h);
+        maybe_evict();
+    }
+    void maybe_evict();
+
+    size_t _limit{default_max_open_files};
+    size_t _open_files{0};
+    size_t _opens{0};
+    size_t _evictions{0};
+    intrusive_list<lazy_file_handle, &lazy_file_handle::_hook> _idle;
+};
+
+inline file_handle_budget& file_handles() {
+    static thread_local file_handle_budget budget;
+    return budget;
+}
+
+} // namespace storage::internal
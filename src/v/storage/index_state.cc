@@ -74,10 +74,11 @@ bool index_state::maybe_index(
     max_timestamp = std::max(max_timestamp, last_timestamp);
     // always saving the first batch simplifies a lot of book keeping
     if (accumulator >= step || retval) {
-        // We know that a segment cannot be > 4GB
+        // We know that a segment cannot be > 4GB. Time entries hold the
+        // running max so that they stay sorted whatever the producer sends
         add_entry(
           batch_base_offset() - base_offset(),
-          last_timestamp() - base_timestamp(),
+          max_timestamp() - base_timestamp(),
           starting_position_in_file);
 
         retval = true;
@@ -102,9 +103,10 @@ std::optional<index_state> index_state::hydrate_from_buffer(iobuf b) {
     iobuf_parser parser(std::move(b));
     index_state retval;
     retval.version = reflection::adl<int8_t>{}.from(parser);
-    if (retval.version != 1) {
-        // we screwed up version 0; and we only have version 1, so
-        // we force the users to rebuild the all indices here
+    if (retval.version != 2) {
+        // we screwed up version 0, and version 1 time entries were not a
+        // running max so they cannot be binary searched. force the users to
+        // rebuild the indices here
         return std::nullopt;
     }
     retval.size = reflection::adl<uint32_t>{}.from(parser);
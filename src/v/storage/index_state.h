@@ -30,7 +30,8 @@ namespace storage {
    8 bytes - max_time
    4 bytes - index.size()
    [] relative_offset_index
-   [] relative_time_index
+   [] relative_time_index - running max timestamp up to and including the
+                            indexed batch (version 2 and later)
    [] position_index
  */
 struct index_state {
@@ -41,7 +42,7 @@ struct index_state {
     index_state& operator=(const index_state&) = delete;
     ~index_state() noexcept = default;
 
-    int8_t version{1};
+    int8_t version{2};
     /// \brief sizeof the index in bytes
     uint32_t size{0};
     /// \brief currently xxhash64
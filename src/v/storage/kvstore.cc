@@ -370,13 +370,18 @@ ss::future<> kvstore::recover() {
         load_snapshot_in_thread();
 
         auto dir = std::filesystem::path(_ntpc.work_directory());
+        ss::semaphore io_units(default_recovery_concurrency);
+        recovery_stats stats;
         auto segments = recover_segments(
                           std::move(dir),
                           debug_sanitize_files::yes,
                           _ntpc.is_compacted(),
                           [] { return std::nullopt; },
-                          _as)
+                          _as,
+                          io_units,
+                          stats)
                           .get0();
+        vlog(lg.debug, "Recovered kvstore segments: {}", stats);
 
         replay_segments_in_thread(std::move(segments));
     });
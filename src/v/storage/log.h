@@ -52,6 +52,11 @@ public:
 
         virtual ss::future<model::record_batch_reader>
           make_reader(log_reader_config) = 0;
+        virtual ss::future<raw_read_result>
+          read_raw(log_reader_config, use_batch_cache) = 0;
+        virtual std::optional<raw_read_result> read_tail(log_reader_config)
+          = 0;
+        virtual void set_tail_buffer_enabled(bool) = 0;
         virtual log_appender make_appender(log_append_config) = 0;
 
         // final operation. Invalid filesystem state after
@@ -118,6 +123,35 @@ public:
         return _impl->make_reader(cfg);
     }
 
+    /**
+     * \brief Reads batches without materializing them
+     *
+     * Same range, filters and budget as make_reader, but the batches are
+     * handed out as their validated headers and the raw payload bytes, which
+     * is all a consumer that forwards them as they are, like a kafka fetch,
+     * needs. With use_batch_cache::yes cached batches are served from the
+     * cache's own buffers.
+     */
+    ss::future<raw_read_result>
+    read_raw(log_reader_config cfg, use_batch_cache cache) {
+        return _impl->read_raw(cfg, cache);
+    }
+
+    /**
+     * \brief Serves a read from the batches most recently appended
+     *
+     * Returns nothing unless the log's tail buffer holds the start offset of
+     * the read, in which case no segment is touched at all. The tail buffer
+     * is only kept while enabled, see set_tail_buffer_enabled().
+     */
+    std::optional<raw_read_result> read_tail(log_reader_config cfg) {
+        return _impl->read_tail(cfg);
+    }
+
+    void set_tail_buffer_enabled(bool enabled) {
+        _impl->set_tail_buffer_enabled(enabled);
+    }
+
     log_appender make_appender(log_append_config cfg) {
         return _impl->make_appender(cfg);
     }
@@ -174,6 +208,9 @@ class log_manager;
 class segment_set;
 class kvstore;
 log make_memory_backed_log(ntp_config);
+/// like make_memory_backed_log(ntp_config), publishing flushed offsets to the
+/// manager's flush notifications
+log make_memory_backed_log(ntp_config, log_manager&);
 log make_disk_backed_log(ntp_config, log_manager&, segment_set, kvstore&);
 
 } // namespace storage
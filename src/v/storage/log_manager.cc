@@ -13,8 +13,13 @@
 #include "likely.h"
 #include "model/fundamental.h"
 #include "model/timestamp.h"
+#include "prometheus/prometheus_sanitize.h"
 #include "storage/batch_cache.h"
+#include "storage/chunk_cache.h"
 #include "storage/compacted_index_writer.h"
+#include "storage/disk_log_impl.h"
+#include "storage/extent_cache.h"
+#include "storage/file_handle_budget.h"
 #include "storage/fs_utils.h"
 #include "storage/log.h"
 #include "storage/logger.h"
@@ -24,6 +29,7 @@
 #include "storage/segment_reader.h"
 #include "storage/segment_set.h"
 #include "storage/segment_utils.h"
+#include "storage/tail_buffer.h"
 #include "utils/directory_walker.h"
 #include "utils/file_sanitizer.h"
 #include "vlog.h"
@@ -33,6 +39,7 @@
 #include <seastar/core/future-util.hh>
 #include <seastar/core/future.hh>
 #include <seastar/core/gate.hh>
+#include <seastar/core/metrics.hh>
 #include <seastar/core/print.hh>
 #include <seastar/core/seastar.hh>
 #include <seastar/core/shared_ptr.hh>
@@ -52,26 +59,119 @@ log_manager::log_manager(log_config config, kvstore& kvstore) noexcept
   : _config(std::move(config))
   , _kvstore(kvstore)
   , _jitter(_config.compaction_interval)
-  , _batch_cache(config.reclaim_opts) {
+  , _batch_cache(config.reclaim_opts)
+  , _recovery_units(_config.recovery_concurrency) {
     _compaction_timer.set_callback([this] { trigger_housekeeping(); });
     _compaction_timer.rearm(_jitter());
 }
 void log_manager::trigger_housekeeping() {
     (void)ss::with_gate(_open_gate, [this] {
         auto next_housekeeping = _jitter();
-        return housekeeping().finally([this, next_housekeeping] {
-            // all of these *MUST* be in the finally
-            if (_open_gate.is_closed()) {
-                return;
-            }
+        return ss::with_scheduling_group(
+                 _config.compaction_sg, [this] { return housekeeping(); })
+          .finally([this, next_housekeeping] {
+              // all of these *MUST* be in the finally
+              if (_open_gate.is_closed()) {
+                  return;
+              }
 
-            _compaction_timer.rearm(next_housekeeping);
-        });
+              _compaction_timer.rearm(next_housekeeping);
+          });
     }).handle_exception([](std::exception_ptr e) {
         vlog(stlog.info, "Error processing housekeeping(): {}", e);
     });
 }
 
+void log_manager::setup_metrics() {
+    if (config::shard_local_cfg().disable_metrics()) {
+        return;
+    }
+    namespace sm = ss::metrics;
+    auto to_ms = [](recovery_stats::duration d) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(d)
+          .count();
+    };
+    _metrics.add_group(
+      prometheus_sanitize::metrics_name("storage:manager"),
+      {
+        sm::make_gauge(
+          "recovered_segments",
+          [this] { return _recovery_stats.segments_opened; },
+          sm::description("Number of segments opened during log recovery")),
+        sm::make_gauge(
+          "replayed_segments",
+          [this] { return _recovery_stats.segments_replayed; },
+          sm::description("Number of segments replayed during log recovery")),
+        sm::make_gauge(
+          "recovery_open_ms",
+          [this, to_ms] { return to_ms(_recovery_stats.open_time); },
+          sm::description("Time spent opening segments during recovery")),
+        sm::make_gauge(
+          "recovery_hydrate_ms",
+          [this, to_ms] { return to_ms(_recovery_stats.hydrate_time); },
+          sm::description(
+            "Time spent hydrating segment indices during recovery")),
+        sm::make_gauge(
+          "recovery_replay_ms",
+          [this, to_ms] { return to_ms(_recovery_stats.replay_time); },
+          sm::description("Time spent replaying segments during recovery")),
+        sm::make_gauge(
+          "open_reader_files",
+          [] { return internal::file_handles().open_files(); },
+          sm::description("Number of segment files open for reading")),
+        sm::make_derive(
+          "reader_file_opens",
+          [] { return internal::file_handles().opens(); },
+          sm::description("Number of times a segment file was opened")),
+        sm::make_derive(
+          "reader_file_evictions",
+          [] { return internal::file_handles().evictions(); },
+          sm::description(
+            "Number of idle segment files closed to stay within budget")),
+        sm::make_gauge(
+          "write_behind_reserved_bytes",
+          [] { return internal::chunks().write_behind_reserved(); },
+          sm::description(
+            "Write-behind memory reserved by open segment appenders")),
+        sm::make_gauge(
+          "extent_cache_bytes",
+          [] { return internal::extents().size_bytes(); },
+          sm::description("Memory held by cached segment file extents")),
+        sm::make_derive(
+          "extent_cache_hits",
+          [] { return internal::extents().hits(); },
+          sm::description("Segment reads served from the extent cache")),
+        sm::make_derive(
+          "extent_cache_misses",
+          [] { return internal::extents().misses(); },
+          sm::description("Segment reads that went to disk")),
+        sm::make_derive(
+          "extent_cache_evictions",
+          [] { return internal::extents().evictions(); },
+          sm::description("Extents evicted for space or reclaimed")),
+        sm::make_gauge(
+          "tail_buffer_bytes",
+          [] { return internal::tail_buffers().size_bytes(); },
+          sm::description("Memory held by the tail buffers of leader logs")),
+        sm::make_derive(
+          "tail_buffer_hits",
+          [] { return internal::tail_buffers().hits(); },
+          sm::description("Tail reads served from the tail buffer")),
+        sm::make_derive(
+          "tail_buffer_misses",
+          [] { return internal::tail_buffers().misses(); },
+          sm::description("Tail reads that fell back to the log reader")),
+        sm::make_gauge(
+          "tail_buffer_hit_ratio",
+          [] {
+              const auto& t = internal::tail_buffers();
+              const auto total = t.hits() + t.misses();
+              return total ? double(t.hits()) / total : 0.0;
+          },
+          sm::description("Fraction of tail reads served from the buffer")),
+      });
+}
+
 ss::future<> log_manager::stop() {
     _compaction_timer.cancel();
     _abort_source.request_abort();
@@ -142,9 +242,11 @@ ss::future<ss::lw_shared_ptr<segment>> log_manager::make_log_segment(
   model::term_id term,
   ss::io_priority_class pc,
   record_version_type version,
-  size_t buf_size) {
+  size_t buf_size,
+  size_t append_rate) {
     return ss::with_gate(
-      _open_gate, [this, &ntp, base_offset, term, pc, version, buf_size] {
+      _open_gate,
+      [this, &ntp, base_offset, term, pc, version, buf_size, append_rate] {
           return make_segment(
             ntp,
             base_offset,
@@ -153,7 +255,8 @@ ss::future<ss::lw_shared_ptr<segment>> log_manager::make_log_segment(
             version,
             buf_size,
             _config.sanitize_fileops,
-            create_cache());
+            create_cache(),
+            append_rate);
       });
 }
 
@@ -180,17 +283,34 @@ ss::future<log> log_manager::do_manage(ntp_config cfg) {
     vassert(
       _logs.find(cfg.ntp()) == _logs.end(), "cannot double register same ntp");
     if (_config.stype == log_config::storage_type::memory) {
-        auto l = storage::make_memory_backed_log(std::move(cfg));
+        auto l = storage::make_memory_backed_log(std::move(cfg), *this);
         _logs.emplace(l.config().ntp(), l);
         // in-memory needs to write vote_for configuration
         return ss::recursive_touch_directory(path).then([l] { return l; });
     }
+    // a marker left by a clean close lets recovery skip the last segment
+    auto clean_marker = disk_log_impl::read_clean_segment_marker(
+      _kvstore, cfg.ntp());
     return recover_segments(
              std::filesystem::path(path),
              _config.sanitize_fileops,
              cfg.is_compacted(),
              [this] { return create_cache(); },
-             _abort_source)
+             _abort_source,
+             _recovery_units,
+             _recovery_stats,
+             clean_marker)
+      .then([this, ntp = cfg.ntp(), has_marker = clean_marker.has_value()](
+              segment_set segments) {
+          if (!has_marker) {
+              return ss::make_ready_future<segment_set>(std::move(segments));
+          }
+          // the marker is only valid until the log is written to again
+          return disk_log_impl::remove_clean_segment_marker(_kvstore, ntp)
+            .then([segments = std::move(segments)]() mutable {
+                return std::move(segments);
+            });
+      })
       .then([this, cfg = std::move(cfg)](segment_set segments) mutable {
           auto l = storage::make_disk_backed_log(
             std::move(cfg), *this, std::move(segments), _kvstore);
@@ -259,6 +379,29 @@ log_manager::get(const model::topic_namespace& tn) {
     return r;
 }
 
+log_manager::flush_notification_id
+log_manager::register_flush_notification(flush_notification cb) {
+    auto id = _flush_notification_id++;
+    _flush_notifications.emplace_back(id, std::move(cb));
+    return id;
+}
+
+void log_manager::unregister_flush_notification(flush_notification_id id) {
+    auto it = std::find_if(
+      _flush_notifications.begin(),
+      _flush_notifications.end(),
+      [id](const auto& n) { return n.first == id; });
+    if (it != _flush_notifications.end()) {
+        _flush_notifications.erase(it);
+    }
+}
+
+void log_manager::notify_flushed(const model::ntp& ntp, model::offset o) {
+    for (auto& [_, cb] : _flush_notifications) {
+        cb(ntp, o);
+    }
+}
+
 std::ostream& operator<<(std::ostream& o, log_config::storage_type t) {
     switch (t) {
     case log_config::storage_type::memory:
@@ -19,17 +19,23 @@
 #include "storage/log.h"
 #include "storage/log_housekeeping_meta.h"
 #include "storage/segment.h"
+#include "storage/segment_set.h"
 #include "storage/types.h"
 #include "storage/version.h"
 #include "units.h"
 #include "utils/mutex.h"
+#include "utils/named_type.h"
 
 #include <seastar/core/abort_source.hh>
 #include <seastar/core/circular_buffer.hh>
 #include <seastar/core/future.hh>
 #include <seastar/core/gate.hh>
 #include <seastar/core/lowres_clock.hh>
+#include <seastar/core/metrics_registration.hh>
+#include <seastar/core/scheduling.hh>
+#include <seastar/core/semaphore.hh>
 #include <seastar/core/sstring.hh>
+#include <seastar/util/noncopyable_function.hh>
 
 #include <absl/container/flat_hash_map.h>
 
@@ -106,6 +112,10 @@ struct log_config {
     // same as delete.retention.ms in kafka - default 1 week
     std::chrono::milliseconds delete_retention = std::chrono::minutes(10080);
     with_cache cache = log_config::with_cache::yes;
+    // concurrent segment opens and index hydrations per shard during recovery
+    size_t recovery_concurrency = default_recovery_concurrency;
+    // housekeeping (retention, compaction, recompression) runs in this group
+    ss::scheduling_group compaction_sg = ss::default_scheduling_group();
     batch_cache::reclaim_options reclaim_opts{
       .growth_window = std::chrono::seconds(3),
       .stable_window = std::chrono::seconds(10),
@@ -174,7 +184,8 @@ public:
       model::term_id,
       ss::io_priority_class pc,
       record_version_type = record_version_type::v1,
-      size_t buffer_size = default_segment_readahead_size);
+      size_t buffer_size = default_segment_readahead_size,
+      size_t append_rate = 0);
 
     const log_config& config() const { return _config; }
 
@@ -192,6 +203,29 @@ public:
     /// Returns the logs that match a model::topic_namespace
     absl::flat_hash_map<model::ntp, log> get(const model::topic_namespace&);
 
+    using flush_notification_id
+      = named_type<int32_t, struct log_flush_notification_id>;
+    using flush_notification
+      = ss::noncopyable_function<void(const model::ntp&, model::offset)>;
+
+    /**
+     * Register a callback invoked every time the committed offset of any log
+     * managed on this core advances after a flush. The callback receives the
+     * ntp and the new committed offset and must not block.
+     */
+    flush_notification_id register_flush_notification(flush_notification);
+    void unregister_flush_notification(flush_notification_id);
+
+    /// Invoked by logs when their committed offset advances
+    void notify_flushed(const model::ntp&, model::offset);
+
+    /// Time spent recovering segments of the logs managed on this core
+    const recovery_stats& get_recovery_stats() const {
+        return _recovery_stats;
+    }
+
+    void setup_metrics();
+
 private:
     using logs_type = absl::flat_hash_map<model::ntp, log_housekeeping_meta>;
 
@@ -214,7 +248,13 @@ private:
     simple_time_jitter<ss::lowres_clock> _jitter;
     ss::timer<ss::lowres_clock> _compaction_timer;
     logs_type _logs;
+    flush_notification_id _flush_notification_id{0};
+    std::vector<std::pair<flush_notification_id, flush_notification>>
+      _flush_notifications;
     batch_cache _batch_cache;
+    ss::semaphore _recovery_units;
+    recovery_stats _recovery_stats;
+    ss::metrics::metric_groups _metrics;
     ss::gate _open_gate;
     ss::abort_source _abort_source;
 
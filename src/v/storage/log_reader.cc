@@ -195,6 +195,144 @@ log_segment_batch_reader::read_some(model::timeout_clock::time_point timeout) {
       });
 }
 
+raw_segment_reader::raw_segment_reader(
+  segment& seg,
+  log_reader_config& config,
+  raw_read_result& result,
+  probe& p,
+  use_batch_cache use_cache) noexcept
+  : _seg(seg)
+  , _config(config)
+  , _result(result)
+  , _probe(p)
+  , _use_cache(use_cache) {}
+
+bool raw_segment_reader::is_done() const {
+    return _config.start_offset > _config.max_offset
+           || _config.start_offset > _seg.offsets().dirty_offset
+           || _config.bytes_consumed >= _config.max_bytes
+           || _config.over_budget;
+}
+
+bool raw_segment_reader::over_budget(
+  const model::record_batch_header& header) const {
+    return (_config.strict_max_bytes || _config.bytes_consumed)
+           && (_config.bytes_consumed + header.size_bytes) > _config.max_bytes;
+}
+
+void raw_segment_reader::add_one(
+  model::record_batch_header header, iobuf payload) {
+    _config.start_offset = header.last_offset() + model::offset(1);
+    _config.bytes_consumed += header.size_bytes;
+    _probe.add_bytes_read(header.size_bytes);
+    _result.batches.push_back(raw_read_result::batch{
+      .header = header, .payload = std::move(payload)});
+}
+
+void raw_segment_reader::read_cached() {
+    while (!is_done()) {
+        auto cache_read = _seg.cache_get(
+          _config.start_offset,
+          _config.max_offset,
+          _config.type_filter,
+          _config.first_timestamp,
+          log_segment_batch_reader::max_buffer_size,
+          _config.skip_batch_cache);
+        _config.start_offset = cache_read.next_batch;
+        if (cache_read.batches.empty()) {
+            return;
+        }
+        for (auto& b : cache_read.batches) {
+            if (over_budget(b.header())) {
+                // resume from this batch on the next read
+                _config.start_offset = b.base_offset();
+                _config.over_budget = true;
+                return;
+            }
+            _probe.add_cached_bytes_read(b.header().size_bytes);
+            add_one(b.header(), std::move(b).release_data());
+        }
+        _probe.add_cached_batches_read(cache_read.batches.size());
+    }
+}
+
+ss::future<> raw_segment_reader::read() {
+    if (_use_cache) {
+        read_cached();
+    }
+    /*
+     * on disk reads are bound by the stable offset. see
+     * log_segment_batch_reader::read_some
+     */
+    if (is_done() || _config.start_offset > _seg.offsets().stable_offset) {
+        return ss::now();
+    }
+    return ss::do_with(
+      batch_header_scanner(
+        *this, _seg.offset_data_stream(_config.start_offset, _config.prio)),
+      [this](batch_header_scanner& scanner) {
+          return scanner.consume()
+            .then([this](result<size_t> r) {
+                if (!r) {
+                    vlog(
+                      stlog.info,
+                      "stopped raw read of {}: {}",
+                      _seg,
+                      r.error().message());
+                }
+            })
+            .finally([&scanner] { return scanner.close(); });
+      });
+}
+
+batch_consumer::consume_result raw_segment_reader::consume_batch_start(
+  const model::record_batch_header& header, size_t /*physical_base_offset*/) {
+    if (header.last_offset() < _config.start_offset) {
+        return skip_batch::yes;
+    }
+    if (header.base_offset() > _config.max_offset) {
+        return stop_parser::yes;
+    }
+    if (_config.type_filter && _config.type_filter != header.type) {
+        _config.start_offset = header.last_offset() + model::offset(1);
+        return skip_batch::yes;
+    }
+    if (_config.first_timestamp > header.first_timestamp) {
+        _config.start_offset = header.last_offset() + model::offset(1);
+        return skip_batch::yes;
+    }
+    if (over_budget(header)) {
+        _config.over_budget = true;
+        return stop_parser::yes;
+    }
+    _header = header;
+    _header.ctx.term = _seg.offsets().term;
+    return skip_batch::no;
+}
+
+void raw_segment_reader::consume_payload(ss::temporary_buffer<char> buf) {
+    _payload.append(std::move(buf));
+}
+
+batch_consumer::stop_parser raw_segment_reader::consume_batch_end() {
+    auto payload = std::exchange(_payload, iobuf{});
+    if (!_config.skip_batch_cache) {
+        _seg.cache_put(model::record_batch(
+          _header,
+          payload.share(0, payload.size_bytes()),
+          model::record_batch::tag_ctor_ng{}));
+    }
+    add_one(_header, std::move(payload));
+    if (_header.last_offset() >= _seg.offsets().stable_offset) {
+        return stop_parser::yes;
+    }
+    return stop_parser(is_done());
+}
+
+void raw_segment_reader::print(std::ostream& os) const {
+    fmt::print(os, "storage::raw_segment_reader segment {}", _seg);
+}
+
 log_reader::log_reader(
   std::unique_ptr<lock_manager::lease> l,
   log_reader_config config,
@@ -121,6 +121,46 @@ private:
     friend class skipping_consumer;
 };
 
+/**
+ * Reads one segment for log::read_raw. Batches that are cached are served
+ * from the batch cache, the rest are scanned straight from the segment
+ * stream. Headers are filtered with the same rules as the skipping_consumer
+ * and payloads are appended to the result as shares of the stream buffers.
+ */
+class raw_segment_reader final : public batch_scan_consumer {
+public:
+    raw_segment_reader(
+      segment&,
+      log_reader_config&,
+      raw_read_result&,
+      probe&,
+      use_batch_cache) noexcept;
+
+    /// reads until the end of the segment, of the offset range, or until the
+    /// budget is used up
+    ss::future<> read();
+
+    consume_result consume_batch_start(
+      const model::record_batch_header&, size_t physical_base_offset) override;
+    void consume_payload(ss::temporary_buffer<char>) override;
+    stop_parser consume_batch_end() override;
+    void print(std::ostream&) const override;
+
+private:
+    bool is_done() const;
+    bool over_budget(const model::record_batch_header&) const;
+    void add_one(model::record_batch_header, iobuf);
+    void read_cached();
+
+    segment& _seg;
+    log_reader_config& _config;
+    raw_read_result& _result;
+    probe& _probe;
+    use_batch_cache _use_cache;
+    model::record_batch_header _header;
+    iobuf _payload;
+};
+
 class log_reader final : public model::record_batch_reader::impl {
 public:
     using data_t = model::record_batch_reader::data_t;
@@ -9,7 +9,6 @@
 
 #include "storage/log_replayer.h"
 
-#include "bytes/utils.h"
 #include "hashing/crc32c.h"
 #include "likely.h"
 #include "model/record.h"
@@ -23,7 +22,7 @@
 #include <type_traits>
 
 namespace storage {
-class checksumming_consumer final : public batch_consumer {
+class checksumming_consumer final : public batch_scan_consumer {
 public:
     static constexpr size_t max_segment_size = static_cast<size_t>(
       std::numeric_limits<uint32_t>::max());
@@ -40,18 +39,17 @@ public:
     ~checksumming_consumer() noexcept override = default;
 
     consume_result consume_batch_start(
-      model::record_batch_header header,
-      size_t physical_base_offset,
-      size_t size_on_disk) override {
+      const model::record_batch_header& header,
+      size_t physical_base_offset) override {
         _header = header;
-        _file_pos_to_end_of_batch = size_on_disk + physical_base_offset;
+        _file_pos_to_end_of_batch = header.size_bytes + physical_base_offset;
         _crc = crc32();
         model::crc_record_batch_header(_crc, header);
         return skip_batch::no;
     }
 
-    void consume_records(iobuf&& records) override {
-        crc_extend_iobuf(_crc, records);
+    void consume_payload(ss::temporary_buffer<char> records) override {
+        _crc.extend(records.get(), records.size());
     }
 
     stop_parser consume_batch_end() override {
@@ -91,12 +89,13 @@ log_replayer::recover_in_thread(const ss::io_priority_class& prio) {
     vlog(stlog.debug, "Recovering segment {}", *_seg);
     // explicitly not using the index to recover the full file
     auto data_stream = _seg->reader().data_stream(0, prio);
-    auto consumer = std::make_unique<checksumming_consumer>(_seg, _ckpt);
-    auto parser = continuous_batch_parser(
-      std::move(consumer), std::move(data_stream));
+    auto consumer = checksumming_consumer(_seg, _ckpt);
+    // recovery only needs the crc of the payload, not the records, so scan the
+    // raw stream buffers instead of materializing every batch
+    auto scanner = batch_header_scanner(consumer, std::move(data_stream));
     try {
-        parser.consume().get();
-        parser.close().get();
+        scanner.consume().get();
+        scanner.close().get();
     } catch (...) {
         vlog(
           stlog.warn,
@@ -15,6 +15,7 @@
 #include "model/timestamp.h"
 #include "seastarx.h"
 #include "storage/log.h"
+#include "storage/log_manager.h"
 #include "storage/logger.h"
 #include "storage/types.h"
 #include "vlog.h"
@@ -145,6 +146,9 @@ struct mem_log_impl final : log::impl {
     // forward ctor
     explicit mem_log_impl(ntp_config cfg)
       : log::impl(std::move(cfg)) {}
+    mem_log_impl(ntp_config cfg, log_manager& manager)
+      : log::impl(std::move(cfg))
+      , _manager(&manager) {}
     ~mem_log_impl() override = default;
     mem_log_impl(const mem_log_impl&) = delete;
     mem_log_impl& operator=(const mem_log_impl&) = delete;
@@ -158,7 +162,16 @@ struct mem_log_impl final : log::impl {
         return ss::make_ready_future<>();
     }
     ss::future<> remove() final { return ss::make_ready_future<>(); }
-    ss::future<> flush() final { return ss::make_ready_future<>(); }
+    ss::future<> flush() final {
+        // appends are committed right away, publish them like a disk log
+        // does after its flush
+        auto committed = offsets().committed_offset;
+        if (_manager && committed != _last_notified_offset) {
+            _last_notified_offset = committed;
+            _manager->notify_flushed(config().ntp(), committed);
+        }
+        return ss::make_ready_future<>();
+    }
     ss::future<> compact(compaction_config cfg) final {
         return gc(cfg.eviction_time, cfg.max_bytes);
     }
@@ -322,6 +335,41 @@ struct mem_log_impl final : log::impl {
           std::move(reader));
     }
 
+    ss::future<raw_read_result>
+    read_raw(log_reader_config cfg, use_batch_cache) final {
+        // batches are already in memory; share their buffers
+        raw_read_result ret;
+        auto it = std::lower_bound(
+          std::begin(_data),
+          std::end(_data),
+          cfg.start_offset,
+          entries_ordering{});
+        for (; it != _data.end() && it->base_offset() <= cfg.max_offset;
+             ++it) {
+            const auto& h = it->header();
+            if (cfg.type_filter && cfg.type_filter != h.type) {
+                continue;
+            }
+            if (
+              (cfg.strict_max_bytes || cfg.bytes_consumed)
+              && cfg.bytes_consumed + h.size_bytes > cfg.max_bytes) {
+                break;
+            }
+            cfg.bytes_consumed += h.size_bytes;
+            ret.batches.push_back(raw_read_result::batch{
+              .header = h,
+              .payload = it->data().share(0, it->data().size_bytes())});
+        }
+        return ss::make_ready_future<raw_read_result>(std::move(ret));
+    }
+
+    std::optional<raw_read_result> read_tail(log_reader_config) final {
+        // everything is in memory already
+        return std::nullopt;
+    }
+
+    void set_tail_buffer_enabled(bool) final {}
+
     log_appender make_appender(log_append_config) final {
         auto o = offsets().dirty_offset;
         if (o() < 0) {
@@ -375,6 +423,9 @@ struct mem_log_impl final : log::impl {
     ss::rwlock _eviction_lock;
     mem_probe _probe;
     model::offset _max_collectible_offset;
+    // set when managed by a log_manager, to publish flushed offsets
+    log_manager* _manager{nullptr};
+    model::offset _last_notified_offset;
 };
 
 ss::future<ss::stop_iteration>
@@ -409,4 +460,9 @@ log make_memory_backed_log(ntp_config cfg) {
     auto ptr = ss::make_shared<mem_log_impl>(std::move(cfg));
     return storage::log(ptr);
 }
+
+log make_memory_backed_log(ntp_config cfg, log_manager& manager) {
+    auto ptr = ss::make_shared<mem_log_impl>(std::move(cfg), manager);
+    return storage::log(ptr);
+}
 } // namespace storage
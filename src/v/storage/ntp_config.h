@@ -10,6 +10,7 @@
  */
 
 #pragma once
+#include "model/compression.h"
 #include "model/fundamental.h"
 #include "tristate.h"
 
@@ -28,11 +29,16 @@ public:
         std::optional<model::compaction_strategy> compaction_strategy;
         // if not set, use the log_manager's configuration
         std::optional<size_t> segment_size;
+        // if not set, use the segment_appender_max_write_size configuration
+        std::optional<size_t> max_write_size;
 
         // partition retention settings. If tristate is disabled the feature
         // will be disabled if there is no value set the default will be used
         tristate<size_t> retention_bytes{std::nullopt};
         tristate<std::chrono::milliseconds> retention_time{std::nullopt};
+        // if set, closed segments are rewritten with their data batches in
+        // this codec, whatever the codec they were produced in
+        std::optional<model::compression> compression;
         friend std::ostream&
         operator<<(std::ostream&, const default_overrides&);
     };
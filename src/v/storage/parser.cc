@@ -32,46 +32,28 @@ namespace storage {
 using stop_parser = batch_consumer::stop_parser;
 using skip_batch = batch_consumer::skip_batch;
 
-model::record_batch_header header_from_iobuf(iobuf b) {
-    iobuf_parser parser(std::move(b));
-    auto header_crc = reflection::adl<uint32_t>{}.from(parser);
-    auto sz = reflection::adl<int32_t>{}.from(parser);
-    using offset_t = model::offset::type;
-    auto off = model::offset(reflection::adl<offset_t>{}.from(parser));
-    auto type = reflection::adl<model::record_batch_type>{}.from(parser);
-    auto crc = reflection::adl<int32_t>{}.from(parser);
-    using attr_t = model::record_batch_attributes::type;
-    auto attrs = model::record_batch_attributes(
-      reflection::adl<attr_t>{}.from(parser));
-    auto delta = reflection::adl<int32_t>{}.from(parser);
-    using tmstmp_t = model::timestamp::type;
-    auto first = model::timestamp(reflection::adl<tmstmp_t>{}.from(parser));
-    auto max = model::timestamp(reflection::adl<tmstmp_t>{}.from(parser));
-    auto producer_id = reflection::adl<int64_t>{}.from(parser);
-    auto producer_epoch = reflection::adl<int16_t>{}.from(parser);
-    auto base_sequence = reflection::adl<int32_t>{}.from(parser);
-    auto record_count = reflection::adl<int32_t>{}.from(parser);
+using packed_header_buf
+  = std::array<char, model::packed_record_batch_header_size>;
+
+/// \brief the packed header as contiguous memory, copying it into \p buf only
+/// if it straddles iobuf fragments
+static const char* contiguous_header(const iobuf& b, packed_header_buf& buf) {
     vassert(
-      parser.bytes_consumed() == model::packed_record_batch_header_size,
-      "Error in header parsing. Must consume:{} bytes, but consumed:{}",
+      b.size_bytes() == model::packed_record_batch_header_size,
+      "Error in header parsing. Must consume:{} bytes, but got:{}",
       model::packed_record_batch_header_size,
-      parser.bytes_consumed());
-    auto hdr = model::record_batch_header{
-      .header_crc = header_crc,
-      .size_bytes = sz,
-      .base_offset = off,
-      .type = type,
-      .crc = crc,
-      .attrs = attrs,
-      .last_offset_delta = delta,
-      .first_timestamp = first,
-      .max_timestamp = max,
-      .producer_id = producer_id,
-      .producer_epoch = producer_epoch,
-      .base_sequence = base_sequence,
-      .record_count = record_count};
-    hdr.ctx.owner_shard = ss::this_shard_id();
-    return hdr;
+      b.size_bytes());
+    if (b.begin()->size() >= model::packed_record_batch_header_size) {
+        return b.begin()->get();
+    }
+    iobuf::iterator_consumer it(b.cbegin(), b.cend());
+    it.consume_to(buf.size(), buf.data());
+    return buf.data();
+}
+
+model::record_batch_header header_from_iobuf(iobuf b) {
+    packed_header_buf buf;
+    return internal::header_from_bytes(contiguous_header(b, buf));
 }
 
 static ss::future<result<iobuf>> verify_read_iobuf(
@@ -109,35 +91,34 @@ ss::future<result<stop_parser>> continuous_batch_parser::consume_header() {
           }
           return b;
       })
-      .then([](result<iobuf> b) {
+      .then([this](result<iobuf> b) -> result<model::record_batch_header> {
           if (!b) {
-              return ss::make_ready_future<result<model::record_batch_header>>(
-                b.error());
-          }
-          return ss::make_ready_future<result<model::record_batch_header>>(
-            header_from_iobuf(std::move(b.value())));
-      })
-      .then([this](result<model::record_batch_header> o) {
-          if (!o) {
-              return ss::make_ready_future<result<stop_parser>>(o.error());
+              return b.error();
           }
-          if (o.value().header_crc == 0) {
+          packed_header_buf buf;
+          const char* packed = contiguous_header(b.value(), buf);
+          auto hdr = internal::header_from_bytes(packed);
+          if (hdr.header_crc == 0) {
               // happens when we fallocate the file
-              return ss::make_ready_future<result<stop_parser>>(
-                parser_errc::end_of_stream);
+              return parser_errc::end_of_stream;
           }
-          if (auto computed_crc = model::internal_header_only_crc(o.value());
-              unlikely(o.value().header_crc != computed_crc)) {
+          if (auto computed_crc = internal::packed_header_crc(packed);
+              unlikely(hdr.header_crc != computed_crc)) {
               vlog(
                 stlog.error,
                 "detected header corruption. stopping parser. Expected CRC of "
                 "{}, but got header CRC: {} - {}. consumer:{}",
                 computed_crc,
-                o.value().header_crc,
-                o.value(),
+                hdr.header_crc,
+                hdr,
                 *_consumer);
-              return ss::make_ready_future<result<stop_parser>>(
-                parser_errc::header_only_crc_missmatch);
+              return parser_errc::header_only_crc_missmatch;
+          }
+          return hdr;
+      })
+      .then([this](result<model::record_batch_header> o) {
+          if (!o) {
+              return ss::make_ready_future<result<stop_parser>>(o.error());
           }
           if (unlikely(o.value().header_crc == 0)) {
               return ss::make_ready_future<result<stop_parser>>(
@@ -247,4 +228,146 @@ ss::future<result<size_t>> continuous_batch_parser::consume() {
           return result<size_t>(_err);
       });
 }
+
+ss::stop_iteration batch_header_scanner::consume_header(const char* packed) {
+    const auto header_crc = ss::read_le<uint32_t>(packed);
+    if (header_crc == 0) {
+        // happens when we fallocate the file
+        _err = parser_errc::end_of_stream;
+        return ss::stop_iteration::yes;
+    }
+    if (auto computed_crc = internal::packed_header_crc(packed);
+        unlikely(header_crc != computed_crc)) {
+        vlog(
+          stlog.error,
+          "detected header corruption. stopping scan. Expected CRC of {}, but "
+          "got header CRC: {} - {}. consumer:{}",
+          computed_crc,
+          header_crc,
+          internal::header_from_bytes(packed),
+          *_consumer);
+        _err = parser_errc::header_only_crc_missmatch;
+        return ss::stop_iteration::yes;
+    }
+    const auto hdr = internal::header_from_bytes(packed);
+    if (unlikely(
+          hdr.size_bytes
+          < static_cast<int32_t>(model::packed_record_batch_header_size))) {
+        vlog(
+          stlog.error,
+          "batch smaller than its header. stopping scan. {} - consumer:{}",
+          hdr,
+          *_consumer);
+        _err = parser_errc::input_stream_not_enough_bytes;
+        return ss::stop_iteration::yes;
+    }
+    auto ret = _consumer->consume_batch_start(hdr, _physical_base_offset);
+    _batch_size = hdr.size_bytes;
+    _physical_base_offset += _batch_size;
+    if (std::holds_alternative<stop_parser>(ret)) {
+        if (std::get<stop_parser>(ret)) {
+            return ss::stop_iteration::yes;
+        }
+        _skip_payload = false;
+    } else {
+        _skip_payload = bool(std::get<skip_batch>(ret));
+    }
+    _payload_remaining = _batch_size - model::packed_record_batch_header_size;
+    _in_payload = true;
+    if (_payload_remaining == 0) {
+        return consume_batch_end();
+    }
+    return ss::stop_iteration::no;
+}
+
+ss::stop_iteration batch_header_scanner::consume_batch_end() {
+    _in_payload = false;
+    _bytes_consumed += _batch_size;
+    if (_skip_payload) {
+        return ss::stop_iteration::no;
+    }
+    return ss::stop_iteration(bool(_consumer->consume_batch_end()));
+}
+
+ss::stop_iteration batch_header_scanner::scan() {
+    constexpr size_t header_size = model::packed_record_batch_header_size;
+    const char* begin = _buffer.get();
+    const char* const end = begin + _buffer.size();
+    auto stop = ss::stop_iteration::no;
+    while (!stop && begin != end) {
+        const size_t available = end - begin;
+        if (_in_payload) {
+            const auto n = std::min(_payload_remaining, available);
+            if (!_skip_payload) {
+                _consumer->consume_payload(
+                  _buffer.share(begin - _buffer.get(), n));
+            }
+            begin += n;
+            _payload_remaining -= n;
+            if (_payload_remaining == 0) {
+                stop = consume_batch_end();
+            }
+            continue;
+        }
+        const char* packed = begin;
+        if (likely(_partial_header_size == 0 && available >= header_size)) {
+            begin += header_size;
+        } else {
+            const auto n = std::min(
+              header_size - _partial_header_size, available);
+            std::copy_n(
+              begin, n, _partial_header.data() + _partial_header_size);
+            _partial_header_size += n;
+            begin += n;
+            if (_partial_header_size < header_size) {
+                continue;
+            }
+            _partial_header_size = 0;
+            packed = _partial_header.data();
+        }
+        stop = consume_header(packed);
+    }
+    // keep what is left for the next call to consume()
+    _buffer.trim_front(begin - _buffer.get());
+    return stop;
+}
+
+ss::future<result<size_t>> batch_header_scanner::consume() {
+    if (unlikely(_err != parser_errc::none)) {
+        return ss::make_ready_future<result<size_t>>(_err);
+    }
+    return ss::repeat([this] {
+               if (!_buffer.empty()) {
+                   return ss::make_ready_future<ss::stop_iteration>(scan());
+               }
+               return _input.read().then([this](ss::temporary_buffer<char> b) {
+                   if (b.empty()) {
+                       if (_in_payload || _partial_header_size > 0) {
+                           vlog(
+                             stlog.error,
+                             "Cannot continue scanning. stream ended inside "
+                             "a batch. consumer:{}",
+                             *_consumer);
+                           _err = parser_errc::input_stream_not_enough_bytes;
+                       }
+                       return ss::stop_iteration::yes;
+                   }
+                   _buffer = std::move(b);
+                   return scan();
+               });
+           })
+      .then([this] {
+          if (_bytes_consumed) {
+              // support partial reads
+              return result<size_t>(_bytes_consumed);
+          }
+          if (
+            _err == parser_errc::input_stream_not_enough_bytes
+            || _err == parser_errc::header_only_crc_missmatch) {
+              return result<size_t>(_err);
+          }
+          return result<size_t>(_bytes_consumed);
+      });
+}
+
 } // namespace storage
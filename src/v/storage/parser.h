@@ -24,6 +24,7 @@
 #include <seastar/core/future-util.hh>
 #include <seastar/core/iostream.hh>
 
+#include <array>
 #include <variant>
 
 namespace storage {
@@ -110,4 +111,92 @@ private:
     size_t _physical_base_offset{0};
 };
 
+/// \brief consumer of a batch_header_scanner
+class batch_scan_consumer {
+public:
+    using skip_batch = batch_consumer::skip_batch;
+    using stop_parser = batch_consumer::stop_parser;
+    using consume_result = batch_consumer::consume_result;
+
+    batch_scan_consumer() noexcept = default;
+    batch_scan_consumer(const batch_scan_consumer&) = default;
+    batch_scan_consumer& operator=(const batch_scan_consumer&) = default;
+    batch_scan_consumer(batch_scan_consumer&&) noexcept = default;
+    batch_scan_consumer& operator=(batch_scan_consumer&&) noexcept = default;
+    virtual ~batch_scan_consumer() noexcept = default;
+
+    /// header already validated against its header crc
+    virtual consume_result consume_batch_start(
+      const model::record_batch_header&, size_t physical_base_offset)
+      = 0;
+
+    /// a span of the payload of the current batch, sharing the stream
+    /// buffer. called as many times as needed to cover the whole payload,
+    /// never for skipped batches
+    virtual void consume_payload(ss::temporary_buffer<char>) {}
+
+    virtual stop_parser consume_batch_end() = 0;
+
+    virtual void print(std::ostream&) const = 0;
+
+private:
+    friend std::ostream&
+    operator<<(std::ostream& os, const batch_scan_consumer& c) {
+        c.print(os);
+        return os;
+    }
+};
+
+/**
+ * Bulk scan of the packed batches of a stream. Where the parser reads every
+ * header and payload into its own iobuf, the scanner walks each buffer the
+ * stream returns in one synchronous loop, decoding and validating every
+ * header found in it from the raw bytes and handing the payload out as shares
+ * of the same buffer. Only headers straddling two buffers are copied.
+ *
+ * Meant for passes over a segment that only need the headers, or need the
+ * payload bytes but not the records themselves, like recovery replay and raw
+ * fetch reads.
+ */
+class batch_header_scanner {
+public:
+    batch_header_scanner(
+      batch_scan_consumer& consumer, ss::input_stream<char> input) noexcept
+      : _consumer(&consumer)
+      , _input(std::move(input)) {}
+    batch_header_scanner(const batch_header_scanner&) = delete;
+    batch_header_scanner& operator=(const batch_header_scanner&) = delete;
+    batch_header_scanner(batch_header_scanner&&) noexcept = default;
+    batch_header_scanner& operator=(batch_header_scanner&&) noexcept = default;
+    ~batch_header_scanner() noexcept = default;
+
+    /// scans until the consumer stops or the end of the stream. returns the
+    /// bytes of all the batches walked, same as continuous_batch_parser
+    ss::future<result<size_t>> consume();
+
+    ss::future<> close() { return _input.close(); }
+
+private:
+    /// walks the current buffer of the stream
+    ss::stop_iteration scan();
+    /// validates and dispatches one packed header
+    ss::stop_iteration consume_header(const char*);
+    ss::stop_iteration consume_batch_end();
+
+private:
+    batch_scan_consumer* _consumer;
+    ss::input_stream<char> _input;
+    ss::temporary_buffer<char> _buffer;
+    /// header straddling two buffers of the stream
+    std::array<char, model::packed_record_batch_header_size> _partial_header;
+    size_t _partial_header_size{0};
+    size_t _batch_size{0};
+    size_t _payload_remaining{0};
+    bool _in_payload{false};
+    bool _skip_payload{false};
+    parser_errc _err = parser_errc::none;
+    size_t _bytes_consumed{0};
+    size_t _physical_base_offset{0};
+};
+
 } // namespace storage
@@ -10,6 +10,7 @@
 #include "storage/parser_utils.h"
 
 #include "compression/compression.h"
+#include "hashing/crc32c.h"
 #include "model/compression.h"
 #include "model/record.h"
 #include "model/record_utils.h"
@@ -18,6 +19,7 @@
 #include "vlog.h"
 
 #include <seastar/core/byteorder.hh>
+#include <seastar/core/smp.hh>
 
 namespace storage::internal {
 
@@ -87,4 +89,58 @@ void reset_size_checksum_metadata(
     hdr.header_crc = model::internal_header_only_crc(hdr);
 }
 
+// offsets of the fields of a packed on-disk header
+namespace packed {
+static constexpr size_t header_crc = 0;
+static constexpr size_t size_bytes = 4;
+static constexpr size_t base_offset = 8;
+static constexpr size_t type = 16;
+static constexpr size_t crc = 17;
+static constexpr size_t attrs = 21;
+static constexpr size_t last_offset_delta = 23;
+static constexpr size_t first_timestamp = 27;
+static constexpr size_t max_timestamp = 35;
+static constexpr size_t producer_id = 43;
+static constexpr size_t producer_epoch = 51;
+static constexpr size_t base_sequence = 53;
+static constexpr size_t record_count = 57;
+static_assert(
+  record_count + sizeof(int32_t) == model::packed_record_batch_header_size);
+} // namespace packed
+
+model::record_batch_header header_from_bytes(const char* p) {
+    // fixed offset unaligned loads; no bounds checks nor per field dispatch
+    using attr_t = model::record_batch_attributes::type;
+    using tmstmp_t = model::timestamp::type;
+    auto hdr = model::record_batch_header{
+      .header_crc = ss::read_le<uint32_t>(p + packed::header_crc),
+      .size_bytes = ss::read_le<int32_t>(p + packed::size_bytes),
+      .base_offset = model::offset(
+        ss::read_le<model::offset::type>(p + packed::base_offset)),
+      .type = model::record_batch_type(
+        ss::read_le<model::record_batch_type::type>(p + packed::type)),
+      .crc = ss::read_le<int32_t>(p + packed::crc),
+      .attrs = model::record_batch_attributes(
+        ss::read_le<attr_t>(p + packed::attrs)),
+      .last_offset_delta = ss::read_le<int32_t>(p + packed::last_offset_delta),
+      .first_timestamp = model::timestamp(
+        ss::read_le<tmstmp_t>(p + packed::first_timestamp)),
+      .max_timestamp = model::timestamp(
+        ss::read_le<tmstmp_t>(p + packed::max_timestamp)),
+      .producer_id = ss::read_le<int64_t>(p + packed::producer_id),
+      .producer_epoch = ss::read_le<int16_t>(p + packed::producer_epoch),
+      .base_sequence = ss::read_le<int32_t>(p + packed::base_sequence),
+      .record_count = ss::read_le<int32_t>(p + packed::record_count)};
+    hdr.ctx.owner_shard = ss::this_shard_id();
+    return hdr;
+}
+
+uint32_t packed_header_crc(const char* p) {
+    auto c = crc32();
+    c.extend(
+      p + packed::size_bytes,
+      model::packed_record_batch_header_size - packed::size_bytes);
+    return c.value();
+}
+
 } // namespace storage::internal
@@ -31,4 +31,14 @@ compress_batch(model::compression, const model::record_batch&);
 /// \brief resets the size, header crc and payload crc
 void reset_size_checksum_metadata(model::record_batch_header&, const iobuf&);
 
+/// \brief decodes a packed on-disk batch header from contiguous memory
+/// holding at least model::packed_record_batch_header_size bytes
+model::record_batch_header header_from_bytes(const char*);
+
+/// \brief header crc of a packed on-disk batch header. The crc covers every
+/// field after header_crc, which on disk are already laid out little endian
+/// and in crc order, so it is a single pass over the raw bytes. Same value as
+/// model::internal_header_only_crc() of the decoded header
+uint32_t packed_header_crc(const char*);
+
 } // namespace storage::internal
@@ -38,6 +38,22 @@ void probe::setup_metrics(const model::ntp& ntp) {
           [this] { return _bytes_written; },
           sm::description("Total number of bytes written"),
           labels),
+        sm::make_total_bytes(
+          "dma_written_bytes",
+          [this] { return _dma_bytes_written; },
+          sm::description("Total number of bytes submitted to disk, including "
+                          "partial pages written more than once"),
+          labels),
+        sm::make_gauge(
+          "write_amplification",
+          [this] {
+              return _bytes_written == 0
+                       ? 0.0
+                       : static_cast<double>(_dma_bytes_written)
+                           / static_cast<double>(_bytes_written);
+          },
+          sm::description("Ratio of bytes submitted to disk to bytes appended"),
+          labels),
         sm::make_derive(
           "batches_written",
           [this] { return _batches_written; },
@@ -89,14 +105,82 @@ void probe::setup_metrics(const model::ntp& ntp) {
           [this] { return _segment_compacted; },
           sm::description("Number of compacted segments"),
           labels),
+        sm::make_derive(
+          "compaction_batches_not_decompressed",
+          [this] { return _compressed_batches_not_opened; },
+          sm::description("Number of compressed batches compaction kept or "
+                          "removed whole without decompressing them"),
+          labels),
+        sm::make_derive(
+          "recompressed_segment",
+          [this] { return _segment_recompressed; },
+          sm::description("Number of segments rewritten in the codec of "
+                          "their topic"),
+          labels),
+        sm::make_derive(
+          "recompressed_batches",
+          [this] { return _batches_recompressed; },
+          sm::description("Number of batches rewritten in the codec of their "
+                          "topic"),
+          labels),
+        sm::make_total_bytes(
+          "recompression_bytes_in",
+          [this] { return _recompression_bytes_in; },
+          sm::description("Size of batches before they were recompressed"),
+          labels),
+        sm::make_total_bytes(
+          "recompression_bytes_out",
+          [this] { return _recompression_bytes_out; },
+          sm::description("Size of batches after they were recompressed"),
+          labels),
+        sm::make_gauge(
+          "recompression_ratio",
+          [this] {
+              return _recompression_bytes_in
+                       ? static_cast<double>(_recompression_bytes_out)
+                           / _recompression_bytes_in
+                       : 1.0;
+          },
+          sm::description("Size of recompressed batches relative to their "
+                          "size before"),
+          labels),
+        sm::make_derive(
+          "recompression_us",
+          [this] { return _recompression_us; },
+          sm::description("CPU time in microseconds spent recompressing "
+                          "batches"),
+          labels),
         sm::make_gauge(
           "partition_size",
           [this] { return _partition_bytes; },
           sm::description("Current size of partition in bytes"),
           labels),
+        sm::make_gauge(
+          "append_rate",
+          [this] { return _append_rate; },
+          sm::description("Smoothed append rate, in bytes per second, as of "
+                          "the last segment roll"),
+          labels),
       });
 }
 
+double probe::sample_append_rate() {
+    const auto now = ss::lowres_clock::now();
+    const auto elapsed = std::chrono::duration<double>(now - _rate_sampled_at);
+    if (elapsed.count() <= 0) {
+        return _append_rate;
+    }
+    const auto current = static_cast<double>(
+                           _bytes_written - _rate_sampled_bytes)
+                         / elapsed.count();
+    // weigh history and the latest window equally
+    _append_rate = _rate_sampled_bytes == 0 ? current
+                                            : (_append_rate + current) / 2;
+    _rate_sampled_at = now;
+    _rate_sampled_bytes = _bytes_written;
+    return _append_rate;
+}
+
 void probe::add_initial_segment(const segment& s) {
     _partition_bytes += s.reader().file_size();
 }
@@ -14,9 +14,11 @@
 #include "storage/logger.h"
 #include "storage/segment.h"
 
+#include <seastar/core/lowres_clock.hh>
 #include <seastar/core/metrics_registration.hh>
 #include <seastar/core/shared_ptr.hh>
 
+#include <chrono>
 #include <cstdint>
 
 namespace storage {
@@ -27,6 +29,10 @@ public:
         _bytes_written += written;
     }
 
+    void add_dma_bytes_written(uint64_t written) {
+        _dma_bytes_written += written;
+    }
+
     void add_bytes_read(uint64_t read) { _bytes_read += read; }
     void add_cached_bytes_read(uint64_t read) { _cached_bytes_read += read; }
 
@@ -37,6 +43,18 @@ public:
     void segment_created() { ++_log_segments_created; }
 
     void segment_compacted() { ++_segment_compacted; }
+    void compressed_batch_not_decompressed() {
+        ++_compressed_batches_not_opened;
+    }
+
+    void segment_recompressed() { ++_segment_recompressed; }
+    void batch_recompressed(
+      size_t bytes_in, size_t bytes_out, std::chrono::microseconds cpu) {
+        ++_batches_recompressed;
+        _recompression_bytes_in += bytes_in;
+        _recompression_bytes_out += bytes_out;
+        _recompression_us += cpu.count();
+    }
 
     void batch_write_error(const std::exception_ptr& e) {
         stlog.error("Error writing record batch {}", e);
@@ -50,6 +68,10 @@ public:
 
     void batch_parse_error() { ++_batch_parse_errors; }
 
+    /// folds the append rate since the previous sample into the smoothed
+    /// rate, in bytes per second, and returns it
+    double sample_append_rate();
+
     void setup_metrics(const model::ntp&);
 
     void delete_segment(const segment&);
@@ -61,6 +83,7 @@ public:
 private:
     uint64_t _partition_bytes = 0;
     uint64_t _bytes_written = 0;
+    uint64_t _dma_bytes_written = 0;
     uint64_t _bytes_read = 0;
     uint64_t _cached_bytes_read = 0;
 
@@ -69,10 +92,21 @@ private:
     uint64_t _cached_batches_read = 0;
 
     uint32_t _segment_compacted = 0;
+    uint64_t _compressed_batches_not_opened = 0;
+    uint32_t _segment_recompressed = 0;
+    uint64_t _batches_recompressed = 0;
+    uint64_t _recompression_bytes_in = 0;
+    uint64_t _recompression_bytes_out = 0;
+    uint64_t _recompression_us = 0;
     uint32_t _corrupted_compaction_index = 0;
     uint32_t _log_segments_created = 0;
     uint32_t _batch_parse_errors = 0;
     uint32_t _batch_write_errors = 0;
+
+    ss::lowres_clock::time_point _rate_sampled_at = ss::lowres_clock::now();
+    uint64_t _rate_sampled_bytes = 0;
+    double _append_rate = 0;
+
     ss::metrics::metric_groups _metrics;
 };
 } // namespace storage
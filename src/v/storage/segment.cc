@@ -532,60 +532,41 @@ ss::future<ss::lw_shared_ptr<segment>> open_segment(
     // preventing x-file synchronization This is fine, because truncation to
     // sealed segments are supposed to be very rare events. The hotpath of
     // truncating the appender, is optimized.
-    return internal::make_reader_handle(path, sanitize_fileops)
-      .then([](ss::file f) {
-          return f.stat().then([f](struct stat s) {
-              return ss::make_ready_future<std::tuple<uint64_t, ss::file>>(
-                std::make_tuple(s.st_size, f));
-          });
-      })
-      .then([buf_size, path](std::tuple<uint64_t, ss::file> t) {
-          auto& [size, fd] = t;
-          return std::make_unique<segment_reader>(
-            path.string(), std::move(fd), size, buf_size);
+    //
+    // Segments that already exist are opened lazily: only their size is
+    // read here and the data and index files are opened on first use,
+    // subject to the per-shard file handle budget.
+    return ss::file_exists(path.string())
+      .then([path, sanitize_fileops, buf_size](bool exists) {
+          if (exists) {
+              return ss::file_size(path.string())
+                .then([path, sanitize_fileops, buf_size](uint64_t size) {
+                    return segment_reader(
+                      path.string(), size, buf_size, sanitize_fileops);
+                });
+          }
+          return internal::make_reader_handle(path, sanitize_fileops)
+            .then([path, buf_size](ss::file f) {
+                return segment_reader(path.string(), std::move(f), 0, buf_size);
+            });
       })
       .then([batch_cache = std::move(batch_cache), meta, sanitize_fileops](
-              std::unique_ptr<segment_reader> rdr) mutable {
-          auto ptr = rdr.get();
-          auto index_name = std::filesystem::path(ptr->filename().c_str())
+              segment_reader rdr) mutable {
+          auto index_name = std::filesystem::path(rdr.filename().c_str())
                               .replace_extension("base_index")
                               .string();
-          return ss::open_file_dma(
-                   index_name, ss::open_flags::create | ss::open_flags::rw)
-            .then_wrapped([batch_cache = std::move(batch_cache),
-                           ptr,
-                           sanitize_fileops,
-                           rdr = std::move(rdr),
-                           index_name,
-                           meta](ss::future<ss::file> f) mutable {
-                ss::file fd;
-                try {
-                    fd = f.get0();
-                } catch (...) {
-                    return ptr->close().then(
-                      [rdr = std::move(rdr), e = std::current_exception()] {
-                          return ss::make_exception_future<
-                            ss::lw_shared_ptr<segment>>(e);
-                      });
-                }
-                if (sanitize_fileops) {
-                    fd = ss::file(
-                      ss::make_shared(file_io_sanitizer(std::move(fd))));
-                }
-                auto idx = segment_index(
-                  index_name,
-                  fd,
-                  meta->base_offset,
-                  segment_index::default_data_buffer_step);
-                return ss::make_ready_future<ss::lw_shared_ptr<segment>>(
-                  ss::make_lw_shared<segment>(
-                    segment::offset_tracker(meta->term, meta->base_offset),
-                    std::move(*rdr),
-                    std::move(idx),
-                    std::nullopt,
-                    std::nullopt,
-                    std::move(batch_cache)));
-            });
+          auto idx = segment_index(
+            index_name,
+            meta->base_offset,
+            segment_index::default_data_buffer_step,
+            sanitize_fileops);
+          return ss::make_lw_shared<segment>(
+            segment::offset_tracker(meta->term, meta->base_offset),
+            std::move(rdr),
+            std::move(idx),
+            std::nullopt,
+            std::nullopt,
+            std::move(batch_cache));
       });
 }
 
@@ -597,23 +578,24 @@ ss::future<ss::lw_shared_ptr<segment>> make_segment(
   record_version_type version,
   size_t buf_size,
   debug_sanitize_files sanitize_fileops,
-  std::optional<batch_cache_index> batch_cache) {
+  std::optional<batch_cache_index> batch_cache,
+  size_t append_rate) {
     auto path = segment_path::make_segment_path(
       ntpc, base_offset, term, version);
     vlog(stlog.info, "Creating new segment {}", path.string());
     return open_segment(
              path, sanitize_fileops, std::move(batch_cache), buf_size)
-      .then([path, &ntpc, sanitize_fileops, pc](
+      .then([path, &ntpc, sanitize_fileops, pc, append_rate](
               ss::lw_shared_ptr<segment> seg) {
           return with_segment(
             std::move(seg),
-            [path, &ntpc, sanitize_fileops, pc](
+            [path, &ntpc, sanitize_fileops, pc, append_rate](
               const ss::lw_shared_ptr<segment>& seg) {
                 return internal::make_segment_appender(
                          path,
                          sanitize_fileops,
-                         internal::number_of_chunks_from_config(ntpc),
-                         pc)
+                         internal::appender_options_from_config(
+                           ntpc, append_rate, pc))
                   .then([seg](segment_appender_ptr a) {
                       return ss::make_ready_future<ss::lw_shared_ptr<segment>>(
                         ss::make_lw_shared<segment>(
@@ -61,6 +61,7 @@ public:
         finished_self_compaction = 1U << 1U,
         mark_tombstone = 1U << 2U,
         closed = 1U << 3U,
+        finished_recompression = 1U << 4U,
     };
 
 public:
@@ -107,6 +108,8 @@ public:
     bool is_compacted_segment() const;
     void mark_as_finished_self_compaction();
     bool finished_self_compaction() const;
+    void mark_as_finished_recompression();
+    bool finished_recompression() const;
     /// \brief used for compaction, to reset the tracker from index
     void force_set_commit_offset_from_index();
     // low level api's are discouraged and might be deprecated
@@ -214,7 +217,8 @@ ss::future<ss::lw_shared_ptr<segment>> make_segment(
   record_version_type version,
   size_t buf_size,
   debug_sanitize_files sanitize_fileops,
-  std::optional<batch_cache_index> batch_cache);
+  std::optional<batch_cache_index> batch_cache,
+  size_t append_rate = 0);
 
 // bitflags operators
 [[gnu::always_inline]] inline segment::bitflags
@@ -274,6 +278,13 @@ inline bool segment::finished_self_compaction() const {
     return (_flags & bitflags::finished_self_compaction)
            == bitflags::finished_self_compaction;
 }
+inline void segment::mark_as_finished_recompression() {
+    _flags |= bitflags::finished_recompression;
+}
+inline bool segment::finished_recompression() const {
+    return (_flags & bitflags::finished_recompression)
+           == bitflags::finished_recompression;
+}
 inline batch_cache_index& segment::cache() { return *_cache; }
 inline const batch_cache_index& segment::cache() const { return *_cache; }
 inline bool segment::has_cache() const { return _cache != std::nullopt; }
@@ -23,6 +23,8 @@
 
 #include <fmt/format.h>
 
+#include <algorithm>
+
 namespace storage {
 
 [[gnu::cold]] static ss::future<>
@@ -34,6 +36,10 @@ size_missmatch_error(const char* ctx, size_t expected, size_t got) {
 segment_appender::segment_appender(ss::file f, options opts)
   : _out(std::move(f))
   , _opts(opts)
+  , _falloc_step(opts.falloc_step)
+  , _write_behind_bytes(internal::chunks().reserve_write_behind(
+      opts.number_of_chunks * chunk_size))
+  , _write_behind(_write_behind_bytes / chunk_size)
   , _concurrent_flushes(ss::semaphore::max_counter())
   , _inactive_timer([this] { handle_inactive_timer(); }) {
     const auto alignment = _out.disk_write_dma_alignment();
@@ -42,6 +48,10 @@ segment_appender::segment_appender(ss::file f, options opts)
       "unexpected alignment {} % {} != 0",
       internal::chunk_cache::alignment,
       alignment);
+    // the pool may grant less than asked for
+    _opts.number_of_chunks = _write_behind_bytes / chunk_size;
+    _opts.chunks_per_write = std::clamp<size_t>(
+      _opts.chunks_per_write, 1, _opts.number_of_chunks);
 }
 
 segment_appender::~segment_appender() noexcept {
@@ -53,6 +63,12 @@ segment_appender::~segment_appender() noexcept {
     if (_head) {
         internal::chunks().add(std::exchange(_head, nullptr));
     }
+    for (auto& c : _queued) {
+        internal::chunks().add(c);
+    }
+    if (_write_behind_bytes) {
+        internal::chunks().release_write_behind(_write_behind_bytes);
+    }
 }
 
 segment_appender::segment_appender(segment_appender&& o) noexcept
@@ -61,9 +77,16 @@ segment_appender::segment_appender(segment_appender&& o) noexcept
   , _closed(o._closed)
   , _committed_offset(o._committed_offset)
   , _fallocation_offset(o._fallocation_offset)
+  , _falloc_step(o._falloc_step)
+  , _last_fallocation(o._last_fallocation)
   , _bytes_flush_pending(o._bytes_flush_pending)
+  , _write_behind_bytes(std::exchange(o._write_behind_bytes, 0))
+  , _write_behind(std::move(o._write_behind))
   , _concurrent_flushes(std::move(o._concurrent_flushes))
   , _head(std::move(o._head))
+  , _queued(std::move(o._queued))
+  , _queued_bytes(std::exchange(o._queued_bytes, 0))
+  , _dma_bytes_written(std::exchange(o._dma_bytes_written, 0))
   , _inflight(std::move(o._inflight))
   , _callbacks(std::exchange(o._callbacks, nullptr))
   , _inactive_timer([this] { handle_inactive_timer(); })
@@ -89,7 +112,7 @@ ss::future<> segment_appender::append(const char* buf, const size_t n) {
     // currently formulated, is not safe to interlave with append.
     _inactive_timer.cancel();
     return do_append(buf, n).then([this] {
-        if (_head && _head->bytes_pending()) {
+        if (!_queued.empty() || (_head && _head->bytes_pending())) {
             _inactive_timer.arm(
               config::shard_local_cfg().segment_appender_flush_timeout_ms());
         }
@@ -118,9 +141,10 @@ ss::future<> segment_appender::do_append(const char* buf, const size_t n) {
     /*
      * if there is no current active chunk then we need to rehydrate. this can
      * happen because of truncation or because the appender had been idle and
-     * its chunk was reclaimed into the chunk cache.
+     * its chunk was reclaimed into the chunk cache. queued full chunks end on
+     * a chunk boundary, so the next chunk simply follows them.
      */
-    if (unlikely(!_head && _committed_offset > 0)) {
+    if (unlikely(!_head && _queued.empty() && _committed_offset > 0)) {
         return internal::chunks()
           .get()
           .then([this](ss::lw_shared_ptr<chunk> chunk) {
@@ -143,7 +167,7 @@ ss::future<> segment_appender::do_append(const char* buf, const size_t n) {
         written += sz;
         _bytes_flush_pending += sz;
         if (_head->is_full()) {
-            dispatch_background_head_write();
+            queue_full_head();
         }
     }
     if (written == n) {
@@ -153,6 +177,11 @@ ss::future<> segment_appender::do_append(const char* buf, const size_t n) {
     return ss::get_units(_concurrent_flushes, 1)
       .then([this, next_buf = buf + written, next_sz = n - written](
               ss::semaphore_units<>) {
+          // do not sit on queued chunks while waiting for the cache to
+          // hand out a new one, they may be what the cache is waiting on
+          if (!_queued.empty() && !internal::chunks().available()) {
+              dispatch_background_head_write();
+          }
           // do not hold the units!
           return internal::chunks().get().then(
             [this, next_buf, next_sz](ss::lw_shared_ptr<chunk> chunk) {
@@ -166,7 +195,7 @@ ss::future<> segment_appender::do_append(const char* buf, const size_t n) {
 void segment_appender::handle_inactive_timer() {
     _previously_inactive = true;
 
-    if (_head && _head->bytes_pending()) {
+    if (!_queued.empty() || (_head && _head->bytes_pending())) {
         /*
          * this is the why the timer was originally set upon returning from
          * append: data was sitting in the write back buffer. the segment
@@ -296,10 +325,19 @@ ss::future<> segment_appender::do_next_adaptive_fallocation() {
              _concurrent_flushes,
              ss::semaphore::max_counter(),
              [this]() mutable {
+                 // a log that needs more space again within a second of the
+                 // last fallocation is appending faster than the step it was
+                 // sized for; grow the step to fallocate less often
+                 const auto now = ss::lowres_clock::now();
+                 if (now - _last_fallocation < std::chrono::seconds(1)) {
+                     _falloc_step = std::min(
+                       _falloc_step * 2, max_fallocation_step);
+                 }
+                 _last_fallocation = now;
                  // step - compute step rounded to 4096; this is needed because
                  // during a truncation the follow up fallocation might not be
                  // page aligned
-                 auto step = _opts.falloc_step;
+                 auto step = _falloc_step;
                  if (_fallocation_offset % 4096 != 0) {
                      // add left over bytes to a full page
                      step += 4096 - (_fallocation_offset % 4096);
@@ -358,50 +396,102 @@ void segment_appender::maybe_advance_stable_offset(
     }
 }
 
-void segment_appender::dispatch_background_head_write() {
-    vassert(_head, "dispatching write requires active chunk");
+void segment_appender::queue_full_head() {
     auto h = std::exchange(_head, nullptr);
+    _queued_bytes += h->bytes_pending();
+    _queued.push_back(std::move(h));
+    if (_queued.size() >= _opts.chunks_per_write) {
+        _queued_bytes = 0;
+        dispatch_background_write(std::exchange(_queued, {}));
+    }
+}
+
+void segment_appender::dispatch_background_head_write() {
     vassert(
-      h->bytes_pending() > 0,
-      "There must be data to write to disk to advance the offset. {}",
-      *this);
+      !_queued.empty() || _head,
+      "dispatching write requires active or queued chunks");
+    auto chunks = std::exchange(_queued, {});
+    _queued_bytes = 0;
+    if (_head && _head->bytes_pending()) {
+        chunks.push_back(std::exchange(_head, nullptr));
+    }
+    dispatch_background_write(std::move(chunks));
+}
 
+void segment_appender::dispatch_background_write(
+  std::vector<ss::lw_shared_ptr<chunk>> chunks) {
+    vassert(!chunks.empty(), "dispatching write requires chunks. {}", *this);
     const size_t start_offset = ss::align_down<size_t>(
-      _committed_offset, h->alignment());
-    const size_t expected = h->dma_size();
-    const char* src = h->dma_ptr();
-    vassert(
-      expected <= chunk::chunk_size,
-      "Writes can be at most a full segment. Expected {}, attempted write: {}",
-      chunk::chunk_size,
-      expected);
+      _committed_offset, chunks.front()->alignment());
+    std::vector<iovec> iov;
+    iov.reserve(chunks.size());
+    size_t expected = 0;
+    size_t pending = 0;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        auto& h = chunks[i];
+        vassert(
+          h->bytes_pending() > 0,
+          "There must be data to write to disk to advance the offset. {}",
+          *this);
+        vassert(
+          i + 1 == chunks.size() || h->is_full(),
+          "Only the last chunk of a write may be partial. {} - {}",
+          *h,
+          *this);
+        // NOLINTNEXTLINE
+        iov.push_back(iovec{const_cast<char*>(h->dma_ptr()), h->dma_size()});
+        expected += h->dma_size();
+        pending += h->bytes_pending();
+        h->flush();
+    }
     // accounting synchronously
-    _committed_offset += h->bytes_pending();
-    _bytes_flush_pending -= h->bytes_pending();
+    _committed_offset += pending;
+    _bytes_flush_pending -= pending;
+    _dma_bytes_written += expected;
     // background write
-    h->flush();
     _inflight.emplace_back(
       ss::make_lw_shared<inflight_write>(_committed_offset));
     auto w = _inflight.back();
     (void)ss::with_semaphore(
       _concurrent_flushes,
       1,
-      [h, w, this, start_offset, expected, src] {
-          return _out.dma_write(start_offset, src, expected, _opts.priority)
-            .then([this, h, w, expected](size_t got) {
-                if (h->is_full()) {
-                    h->reset();
-                }
-                if (h->is_empty()) {
-                    internal::chunks().add(h);
-                } else {
-                    _head = h;
-                }
-                if (unlikely(expected != got)) {
-                    return size_missmatch_error("chunk::write", expected, got);
-                }
-                maybe_advance_stable_offset(w);
-                return ss::make_ready_future<>();
+      [this,
+       w,
+       start_offset,
+       expected,
+       chunks = std::move(chunks),
+       iov = std::move(iov)]() mutable {
+          // bound the bytes in flight to the write-behind window
+          const size_t units = std::min(iov.size(), _opts.number_of_chunks);
+          return ss::with_semaphore(
+            _write_behind,
+            units,
+            [this,
+             w,
+             start_offset,
+             expected,
+             chunks = std::move(chunks),
+             iov = std::move(iov)]() mutable {
+                return do_dma_write(start_offset, std::move(iov))
+                  .then([this, w, expected, chunks = std::move(chunks)](
+                          size_t got) {
+                      for (auto& h : chunks) {
+                          if (h->is_full()) {
+                              h->reset();
+                          }
+                          if (h->is_empty()) {
+                              internal::chunks().add(h);
+                          } else {
+                              _head = h;
+                          }
+                      }
+                      if (unlikely(expected != got)) {
+                          return size_missmatch_error(
+                            "chunk::write", expected, got);
+                      }
+                      maybe_advance_stable_offset(w);
+                      return ss::make_ready_future<>();
+                  });
             });
       })
       .handle_exception([this](std::exception_ptr e) {
@@ -409,9 +499,21 @@ void segment_appender::dispatch_background_head_write() {
       });
 }
 
+ss::future<size_t>
+segment_appender::do_dma_write(size_t offset, std::vector<iovec> iov) {
+    if (iov.size() == 1) {
+        return _out.dma_write(
+          offset,
+          static_cast<const char*>(iov[0].iov_base),
+          iov[0].iov_len,
+          _opts.priority);
+    }
+    return _out.dma_write(offset, std::move(iov), _opts.priority);
+}
+
 ss::future<> segment_appender::flush() {
     _inactive_timer.cancel();
-    if (_head && _head->bytes_pending()) {
+    if (!_queued.empty() || (_head && _head->bytes_pending())) {
         dispatch_background_head_write();
     }
     return ss::with_semaphore(
@@ -426,8 +528,11 @@ ss::future<> segment_appender::flush() {
 std::ostream& operator<<(std::ostream& o, const segment_appender& a) {
     // NOTE: intrusivelist.size() == O(N) but often N is very small, ~8
     return o << "{no_of_chunks:" << a._opts.number_of_chunks
+             << ", chunks_per_write:" << a._opts.chunks_per_write
+             << ", queued_chunks:" << a._queued.size()
              << ", closed:" << a._closed
              << ", fallocation_offset:" << a._fallocation_offset
+             << ", fallocation_step:" << a._falloc_step
              << ", committed_offset:" << a._committed_offset
              << ", bytes_flush_pending:" << a._bytes_flush_pending << "}";
 }
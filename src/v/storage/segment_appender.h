@@ -21,9 +21,14 @@
 #include <seastar/core/file.hh>
 #include <seastar/core/fstream.hh>
 #include <seastar/core/iostream.hh>
+#include <seastar/core/lowres_clock.hh>
 #include <seastar/core/sstring.hh>
 
+#include <sys/uio.h>
+
 #include <iostream>
+#include <utility>
+#include <vector>
 
 namespace storage {
 
@@ -40,6 +45,10 @@ public:
                                                      / chunk::chunk_size;
     static constexpr const size_t chunk_size = chunk::chunk_size;
     static constexpr const size_t fallocation_step = 32_MiB;
+    // bounds for write-behind and fallocation sized from the append rate
+    static constexpr const size_t min_write_behind_chunks = 4;
+    static constexpr const size_t min_fallocation_step = 4_MiB;
+    static constexpr const size_t max_fallocation_step = 256_MiB;
 
     struct options {
         options(ss::io_priority_class p, size_t chunks_no)
@@ -53,6 +62,8 @@ public:
         ss::io_priority_class priority;
         size_t number_of_chunks{chunks_no_buffer};
         size_t falloc_step{fallocation_step};
+        // contiguous full chunks submitted together as one vectored write
+        size_t chunks_per_write{1};
     };
 
     segment_appender(ss::file f, options opts);
@@ -80,8 +91,20 @@ public:
 
     void set_callbacks(callbacks* callbacks) { _callbacks = callbacks; }
 
+    /// bytes submitted to the device since the last call, including the
+    /// partial pages that are written again on the next write
+    uint64_t take_dma_bytes_written() {
+        return std::exchange(_dma_bytes_written, 0);
+    }
+
 private:
+    /// queues the full head chunk, dispatching the queue as a single write
+    /// once it reaches chunks_per_write
+    void queue_full_head();
+    /// dispatches queued full chunks followed by the head, if any
     void dispatch_background_head_write();
+    void dispatch_background_write(std::vector<ss::lw_shared_ptr<chunk>>);
+    ss::future<size_t> do_dma_write(size_t, std::vector<iovec>);
     ss::future<> do_next_adaptive_fallocation();
     ss::future<> hydrate_last_half_page();
     ss::future<> do_truncation(size_t);
@@ -98,7 +121,8 @@ private:
      * the eventual committed offset taking into account pending bytes.
      */
     size_t next_committed_offset() const {
-        return _committed_offset + (_head ? _head->bytes_pending() : 0);
+        return _committed_offset + _queued_bytes
+               + (_head ? _head->bytes_pending() : 0);
     }
 
     ss::file _out;
@@ -106,9 +130,20 @@ private:
     bool _closed{false};
     size_t _committed_offset{0};
     size_t _fallocation_offset{0};
+    // grows while fallocations are frequent, see do_next_adaptive_fallocation
+    size_t _falloc_step;
+    ss::lowres_clock::time_point _last_fallocation;
     size_t _bytes_flush_pending{0};
+    // write-behind memory reserved from the shard-wide pool
+    size_t _write_behind_bytes{0};
+    ss::semaphore _write_behind;
     ss::semaphore _concurrent_flushes;
     ss::lw_shared_ptr<chunk> _head;
+    // full chunks not yet dispatched. they directly follow each other (and
+    // precede _head) in the file
+    std::vector<ss::lw_shared_ptr<chunk>> _queued;
+    size_t _queued_bytes{0};
+    uint64_t _dma_bytes_written{0};
 
     struct inflight_write {
         bool done;
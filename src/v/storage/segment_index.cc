@@ -11,10 +11,12 @@
 
 #include "model/timestamp.h"
 #include "storage/logger.h"
+#include "utils/file_sanitizer.h"
 #include "vassert.h"
 
 #include <seastar/core/fstream.hh>
 #include <seastar/core/iostream.hh>
+#include <seastar/core/seastar.hh>
 
 #include <bits/stdint-uintn.h>
 #include <boost/container/container_fwd.hpp>
@@ -42,6 +44,35 @@ segment_index::segment_index(
     _state.base_offset = base;
 }
 
+segment_index::segment_index(
+  ss::sstring filename,
+  model::offset base,
+  size_t step,
+  debug_sanitize_files sanitize)
+  : _name(std::move(filename))
+  , _step(step)
+  , _sanitize(sanitize) {
+    _state.base_offset = base;
+}
+
+ss::future<ss::file> segment_index::handle() {
+    if (_out) {
+        return ss::make_ready_future<ss::file>(*_out);
+    }
+    return ss::open_file_dma(_name, ss::open_flags::create | ss::open_flags::rw)
+      .then([this](ss::file f) {
+          if (_sanitize) {
+              f = ss::file(ss::make_shared(file_io_sanitizer(std::move(f))));
+          }
+          // a concurrent caller may have opened the file already
+          if (_out) {
+              return f.close().finally([f] {}).then([this] { return *_out; });
+          }
+          _out = f;
+          return ss::make_ready_future<ss::file>(f);
+      });
+}
+
 void segment_index::reset() {
     auto base = _state.base_offset;
     _state = {};
@@ -73,22 +104,24 @@ void segment_index::maybe_track(
 
 std::optional<segment_index::entry>
 segment_index::find_nearest(model::timestamp t) {
-    if (t < _state.base_timestamp) {
+    if (_state.empty() || t > _state.max_timestamp) {
         return std::nullopt;
     }
-    if (_state.empty()) {
-        return std::nullopt;
+    if (t <= _state.base_timestamp) {
+        return translate_index_entry(_state, _state.get_entry(0));
     }
+    // time entries are a running max, so every batch before the entry
+    // preceding the first one that reaches `t` is older than `t`
     const uint32_t i = t() - _state.base_timestamp();
     auto it = std::lower_bound(
       std::begin(_state.relative_time_index),
       std::end(_state.relative_time_index),
       i,
       std::less<uint32_t>{});
-    if (it == _state.relative_offset_index.end()) {
-        return std::nullopt;
+    auto dist = std::distance(_state.relative_time_index.begin(), it);
+    if (dist > 0) {
+        --dist;
     }
-    auto dist = std::distance(_state.relative_offset_index.begin(), it);
     return translate_index_entry(_state, _state.get_entry(dist));
 }
 
@@ -148,9 +181,11 @@ ss::future<> segment_index::truncate(model::offset o) {
 }
 
 ss::future<bool> segment_index::materialize_index() {
-    return _out.size()
-      .then([this](uint64_t size) mutable {
-          return _out.dma_read_bulk<char>(0, size);
+    return handle()
+      .then([](ss::file f) {
+          return f.size().then([f](uint64_t size) mutable {
+              return f.dma_read_bulk<char>(0, size).finally([f] {});
+          });
       })
       .then([this](ss::temporary_buffer<char> buf) {
           if (buf.empty()) {
@@ -164,12 +199,24 @@ ss::future<bool> segment_index::materialize_index() {
           }
           _state = std::move(hydrated.value());
           return true;
+      })
+      .then([this](bool hydrated) {
+          // the in-memory state is all we need until the next flush
+          return release_handle().then([hydrated] { return hydrated; });
       });
 }
 
+ss::future<> segment_index::release_handle() {
+    if (!_out || _needs_persistence) {
+        return ss::now();
+    }
+    auto f = std::exchange(_out, std::nullopt);
+    return f->close().finally([f] {});
+}
+
 ss::future<> segment_index::drop_all_data() {
     reset();
-    return _out.truncate(0);
+    return handle().then([](ss::file f) { return f.truncate(0); });
 }
 
 ss::future<> segment_index::flush() {
@@ -177,9 +224,11 @@ ss::future<> segment_index::flush() {
         return ss::make_ready_future<>();
     }
     _needs_persistence = false;
-    return _out.truncate(0)
-      .then(
-        [this] { return ss::make_file_output_stream(ss::file(_out.dup())); })
+    return handle()
+      .then([](ss::file f) { return f.truncate(0).then([f] { return f; }); })
+      .then([](ss::file f) {
+          return ss::make_file_output_stream(ss::file(f.dup()));
+      })
       .then([this](ss::output_stream<char> out) {
           auto b = _state.checksum_and_serialize();
           return do_with(
@@ -197,7 +246,13 @@ ss::future<> segment_index::flush() {
       });
 }
 ss::future<> segment_index::close() {
-    return flush().then([this] { return _out.close(); });
+    return flush().then([this] {
+        if (!_out) {
+            return ss::now();
+        }
+        auto f = std::exchange(_out, std::nullopt);
+        return f->close().finally([f] {});
+    });
 }
 std::ostream& operator<<(std::ostream& o, const segment_index& i) {
     return o << "{file:" << i.filename() << ", offsets:" << i.base_offset()
@@ -14,6 +14,7 @@
 #include "model/record.h"
 #include "model/timestamp.h"
 #include "storage/index_state.h"
+#include "storage/types.h"
 
 #include <seastar/core/file.hh>
 #include <seastar/core/unaligned.hh>
@@ -50,6 +51,12 @@ public:
 
     segment_index(
       ss::sstring filename, ss::file, model::offset base, size_t step);
+    /// opens the index file on first use
+    segment_index(
+      ss::sstring filename,
+      model::offset base,
+      size_t step,
+      debug_sanitize_files);
     ~segment_index() noexcept = default;
     segment_index(segment_index&&) noexcept = default;
     segment_index& operator=(segment_index&&) noexcept = default;
@@ -58,6 +65,8 @@ public:
 
     void maybe_track(const model::record_batch_header&, size_t filepos);
     std::optional<entry> find_nearest(model::offset);
+    /// entry to start scanning from for the first batch at or after the
+    /// timestamp, if the segment may hold one
     std::optional<entry> find_nearest(model::timestamp);
 
     model::offset base_offset() const { return _state.base_offset; }
@@ -67,6 +76,8 @@ public:
     const ss::sstring& filename() const { return _name; }
 
     ss::future<bool> materialize_index();
+    /// closes the index file if there is nothing pending to be written
+    ss::future<> release_handle();
     ss::future<> close();
     ss::future<> flush();
     ss::future<> truncate(model::offset);
@@ -83,8 +94,14 @@ public:
     bool needs_persistence() const { return _needs_persistence; }
 
 private:
+    /// opens the index file if it is not open already
+    ss::future<ss::file> handle();
+
     ss::sstring _name;
-    ss::file _out;
+    // the index is only read when the segment is recovered and written on
+    // flush, so it is opened on demand and released after hydration
+    std::optional<ss::file> _out;
+    debug_sanitize_files _sanitize{debug_sanitize_files::no};
     size_t _step;
     size_t _acc{0};
     bool _needs_persistence{false};
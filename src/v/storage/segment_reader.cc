@@ -9,6 +9,7 @@
 
 #include "storage/segment_reader.h"
 
+#include "storage/extent_cache.h"
 #include "vassert.h"
 
 #include <seastar/core/file.hh>
@@ -17,17 +18,216 @@
 #include <seastar/core/reactor.hh>
 #include <seastar/core/sstring.hh>
 
+#include <algorithm>
+
 namespace storage {
 
+/**
+ * Data source that pins the lazy file handle on the first read and releases
+ * it once the stream is closed, so that the handle is never evicted from
+ * underneath an active reader.
+ */
+class lazy_file_data_source final : public ss::data_source_impl {
+public:
+    lazy_file_data_source(
+      ss::lw_shared_ptr<internal::lazy_file_handle> handle,
+      size_t pos,
+      size_t len,
+      ss::file_input_stream_options opts) noexcept
+      : _handle(std::move(handle))
+      , _pos(pos)
+      , _len(len)
+      , _opts(std::move(opts)) {}
+
+    lazy_file_data_source(const lazy_file_data_source&) = delete;
+    lazy_file_data_source& operator=(const lazy_file_data_source&) = delete;
+    lazy_file_data_source(lazy_file_data_source&&) = delete;
+    lazy_file_data_source& operator=(lazy_file_data_source&&) = delete;
+
+    ~lazy_file_data_source() noexcept override { release(); }
+
+    ss::future<ss::temporary_buffer<char>> get() final {
+        if (_stream) {
+            return _stream->read();
+        }
+        return _handle->get().then([this](ss::file f) {
+            _pinned = true;
+            _stream = ss::make_file_input_stream(
+              std::move(f), _pos, _len, std::move(_opts));
+            return _stream->read();
+        });
+    }
+
+    ss::future<> close() final {
+        auto f = _stream ? _stream->close() : ss::now();
+        return f.finally([this] { release(); });
+    }
+
+private:
+    void release() {
+        if (_pinned) {
+            _pinned = false;
+            _handle->put();
+        }
+    }
+
+    ss::lw_shared_ptr<internal::lazy_file_handle> _handle;
+    size_t _pos;
+    size_t _len;
+    ss::file_input_stream_options _opts;
+    std::optional<ss::input_stream<char>> _stream;
+    bool _pinned{false};
+};
+
+/**
+ * Data source that serves reads from the shard-wide extent cache, going to
+ * disk only for the missing extents. A miss reads a whole buffer worth of
+ * extents at once and caches a copy of each full one, so that a cached extent
+ * never keeps the rest of the read alive, and the next buffer is fetched
+ * while the current one is being consumed. Like lazy_file_data_source, the
+ * file handle is pinned from the first disk read until the stream is closed,
+ * which must happen before the stream is destroyed.
+ */
+class extent_data_source final : public ss::data_source_impl {
+    using extent_cache = internal::extent_cache;
+
+public:
+    extent_data_source(
+      ss::lw_shared_ptr<internal::lazy_file_handle> handle,
+      uint64_t file_id,
+      size_t pos,
+      size_t end,
+      size_t buffer_size,
+      const ss::io_priority_class& pc) noexcept
+      : _handle(std::move(handle))
+      , _file_id(file_id)
+      , _pos(pos)
+      , _end(end)
+      , _run_extents(std::max<size_t>(
+          buffer_size / extent_cache::extent_size, 1))
+      , _pc(pc) {}
+
+    extent_data_source(const extent_data_source&) = delete;
+    extent_data_source& operator=(const extent_data_source&) = delete;
+    extent_data_source(extent_data_source&&) = delete;
+    extent_data_source& operator=(extent_data_source&&) = delete;
+
+    ~extent_data_source() noexcept override { release(); }
+
+    ss::future<ss::temporary_buffer<char>> get() final {
+        if (_pos >= _end) {
+            return ss::make_ready_future<ss::temporary_buffer<char>>();
+        }
+        auto f = _prefetch ? take_prefetch() : fetch(_pos);
+        return f.then([this](ss::temporary_buffer<char> buf) {
+            // buffers start at the extent holding the read position
+            const size_t start = _pos - _pos % extent_cache::extent_size;
+            buf.trim_front(std::min(buf.size(), _pos - start));
+            buf.trim(std::min(buf.size(), _end - _pos));
+            _pos += buf.size();
+            if (buf.empty()) {
+                // the file is shorter than expected, stop here
+                _pos = _end;
+            } else if (_pos < _end) {
+                _prefetch = fetch(_pos);
+            }
+            return buf;
+        });
+    }
+
+    ss::future<> close() final {
+        if (!_prefetch) {
+            release();
+            return ss::now();
+        }
+        // an in flight read may still need the file
+        return take_prefetch()
+          .discard_result()
+          .handle_exception([](std::exception_ptr) {})
+          .finally([this] { release(); });
+    }
+
+private:
+    ss::future<ss::temporary_buffer<char>> take_prefetch() {
+        auto f = std::move(*_prefetch);
+        _prefetch.reset();
+        return f;
+    }
+
+    ss::future<ss::temporary_buffer<char>> fetch(size_t pos) {
+        auto& cache = internal::extents();
+        const uint64_t idx = pos / extent_cache::extent_size;
+        if (auto buf = cache.get(_file_id, idx); buf) {
+            return ss::make_ready_future<ss::temporary_buffer<char>>(
+              std::move(*buf));
+        }
+        const size_t start = idx * extent_cache::extent_size;
+        const size_t len = std::min(
+          _run_extents * extent_cache::extent_size, _end - start);
+        return file().then([id = _file_id, pc = _pc, start, len](ss::file f) {
+            return f.dma_read_bulk<char>(start, len, pc)
+              .then([id, start](ss::temporary_buffer<char> buf) {
+                  constexpr auto sz = extent_cache::extent_size;
+                  for (size_t off = 0; off + sz <= buf.size(); off += sz) {
+                      internal::extents().put(
+                        id, (start + off) / sz, buf.get() + off);
+                  }
+                  return buf;
+              });
+        });
+    }
+
+    ss::future<ss::file> file() {
+        if (_file) {
+            return ss::make_ready_future<ss::file>(*_file);
+        }
+        return _handle->get().then([this](ss::file f) {
+            _file = f;
+            return f;
+        });
+    }
+
+    void release() {
+        if (_file) {
+            _file.reset();
+            _handle->put();
+        }
+    }
+
+    ss::lw_shared_ptr<internal::lazy_file_handle> _handle;
+    uint64_t _file_id;
+    size_t _pos;
+    size_t _end;
+    size_t _run_extents;
+    ss::io_priority_class _pc;
+    std::optional<ss::future<ss::temporary_buffer<char>>> _prefetch;
+    // set while the handle is pinned by this stream
+    std::optional<ss::file> _file;
+};
+
 segment_reader::segment_reader(
   ss::sstring filename,
   ss::file data_file,
   size_t file_size,
   size_t buffer_size) noexcept
   : _filename(std::move(filename))
-  , _data_file(std::move(data_file))
+  , _data_file(ss::make_lw_shared<internal::lazy_file_handle>(
+      _filename, std::move(data_file)))
   , _file_size(file_size)
-  , _buffer_size(buffer_size) {}
+  , _buffer_size(buffer_size)
+  , _cache_id(internal::extents().register_file()) {}
+
+segment_reader::segment_reader(
+  ss::sstring filename,
+  size_t file_size,
+  size_t buffer_size,
+  debug_sanitize_files sanitize) noexcept
+  : _filename(std::move(filename))
+  , _data_file(
+      ss::make_lw_shared<internal::lazy_file_handle>(_filename, sanitize))
+  , _file_size(file_size)
+  , _buffer_size(buffer_size)
+  , _cache_id(internal::extents().register_file()) {}
 
 ss::input_stream<char>
 segment_reader::data_stream(size_t pos, const ss::io_priority_class& pc) {
@@ -36,17 +236,48 @@ segment_reader::data_stream(size_t pos, const ss::io_priority_class& pc) {
       "cannot read negative bytes. Asked to read at position: '{}' - {}",
       pos,
       *this);
+    if (internal::extents().enabled()) {
+        return ss::input_stream<char>(
+          ss::data_source(std::make_unique<extent_data_source>(
+            _data_file, _cache_id, pos, _file_size, _buffer_size, pc)));
+    }
     ss::file_input_stream_options options;
     options.buffer_size = _buffer_size;
     options.io_priority_class = pc;
     options.read_ahead = 4; // FIXME: scylla uses 10
     options.dynamic_adjustments = _history;
-    return make_file_input_stream(
-      _data_file, pos, _file_size - pos, std::move(options));
+    return ss::input_stream<char>(
+      ss::data_source(std::make_unique<lazy_file_data_source>(
+        _data_file, pos, _file_size - pos, std::move(options))));
+}
+
+ss::future<struct stat> segment_reader::stat() {
+    return _data_file->get().then([h = _data_file](ss::file f) {
+        return f.stat().finally([h] { h->put(); });
+    });
+}
+
+ss::future<> segment_reader::flush() {
+    if (!_data_file->is_open()) {
+        // nothing was written through this read only handle
+        return ss::now();
+    }
+    return _data_file->get().then([h = _data_file](ss::file f) {
+        return f.flush().finally([h] { h->put(); });
+    });
+}
+
+ss::future<> segment_reader::close() {
+    // a prefetch still in flight must not cache extents of a closed file
+    internal::extents().unregister_file(_cache_id);
+    return _data_file->close();
 }
 
 ss::future<> segment_reader::truncate(size_t n) {
     _file_size = n;
+    // the extent holding the new end is no longer full
+    internal::extents().invalidate(
+      _cache_id, n / internal::extent_cache::extent_size);
     return ss::open_file_dma(_filename, ss::open_flags::rw)
       .then([n](ss::file f) {
           return f.truncate(n)
@@ -13,6 +13,8 @@
 
 #include "model/fundamental.h"
 #include "seastarx.h"
+#include "storage/file_handle_budget.h"
+#include "storage/types.h"
 
 #include <seastar/core/file.hh>
 #include <seastar/core/fstream.hh>
@@ -26,6 +28,11 @@
 
 namespace storage {
 
+/**
+ * Reads a segment data file through a lazily opened handle. The handle is
+ * opened on the first read and may be closed by the per-shard file handle
+ * budget while no stream is reading from it.
+ */
 class segment_reader {
 public:
     segment_reader(
@@ -33,6 +40,12 @@ public:
       ss::file,
       size_t file_size,
       size_t buffer_size) noexcept;
+    /// defers opening the data file until it is first read
+    segment_reader(
+      ss::sstring filename,
+      size_t file_size,
+      size_t buffer_size,
+      debug_sanitize_files) noexcept;
     ~segment_reader() noexcept = default;
     segment_reader(segment_reader&&) noexcept = default;
     segment_reader& operator=(segment_reader&&) noexcept = default;
@@ -48,28 +61,34 @@ public:
 
     bool empty() const { return _file_size == 0; }
 
-    /// close the underlying file handle
-    ss::future<> close() { return _data_file.close(); }
+    /// close the underlying file handle and drop its cached extents
+    ss::future<> close();
 
     /// perform syscall stat
-    ss::future<struct stat> stat() { return _data_file.stat(); }
+    ss::future<struct stat> stat();
 
     /// truncates file starting at this phyiscal offset
     ss::future<> truncate(size_t sz);
 
     /// flushes the file metadata
-    ss::future<> flush() { return _data_file.flush(); }
+    ss::future<> flush();
+
+    /// whether the data file is currently open
+    bool is_open() const { return _data_file->is_open(); }
 
     /// create an input stream _sharing_ the underlying file handle
-    /// starting at position @pos
+    /// starting at position @pos. The handle is pinned open from the first
+    /// read until the stream is closed
     ss::input_stream<char>
     data_stream(size_t pos, const ss::io_priority_class&);
 
 private:
     ss::sstring _filename;
-    ss::file _data_file;
+    ss::lw_shared_ptr<internal::lazy_file_handle> _data_file;
     size_t _file_size{0};
     size_t _buffer_size{0};
+    // identifies the file's extents in the shard-wide extent cache
+    uint64_t _cache_id{0};
     ss::lw_shared_ptr<ss::file_input_stream_history> _history
       = ss::make_lw_shared<ss::file_input_stream_history>();
 
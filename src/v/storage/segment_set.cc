@@ -20,6 +20,9 @@
 #include <seastar/core/loop.hh>
 #include <seastar/core/seastar.hh>
 #include <seastar/core/thread.hh>
+#include <seastar/util/defer.hh>
+
+#include <boost/range/irange.hpp>
 
 #include <fmt/format.h>
 
@@ -34,9 +37,6 @@ struct segment_ordering {
     bool operator()(const type& seg, model::offset value) const {
         return seg->offsets().dirty_offset < value;
     }
-    bool operator()(const type& seg, model::timestamp value) const {
-        return seg->index().max_timestamp() < value;
-    }
 };
 
 segment_set::segment_set(segment_set::underlying_t segs)
@@ -54,12 +54,27 @@ void segment_set::add(ss::lw_shared_ptr<segment> h) {
           _handles.back()->offsets().dirty_offset,
           *h,
           *this);
+        if (_time_summary) {
+            // the current active segment is sealed
+            _time_summary->push_back(_handles.back()->index().max_timestamp());
+        }
     }
     _handles.emplace_back(std::move(h));
 }
 
-void segment_set::pop_back() { _handles.pop_back(); }
-void segment_set::pop_front() { _handles.pop_front(); }
+void segment_set::pop_back() {
+    _handles.pop_back();
+    if (_time_summary && !_time_summary->empty()) {
+        // the new back segment is active again
+        _time_summary->pop_back();
+    }
+}
+void segment_set::pop_front() {
+    _handles.pop_front();
+    if (_time_summary && !_time_summary->empty()) {
+        _time_summary->pop_front();
+    }
+}
 
 template<typename Iterator>
 struct needle_in_range {
@@ -71,16 +86,6 @@ struct needle_in_range {
         // must use max_offset
         return o <= s.offsets().dirty_offset && o >= s.offsets().base_offset;
     }
-
-    bool operator()(Iterator ptr, model::timestamp t) {
-        auto& s = **ptr;
-        if (s.empty()) {
-            return false;
-        }
-        // must use max_offset
-        return t <= s.index().max_timestamp()
-               && t >= s.index().base_timestamp();
-    }
 };
 
 template<typename Iterator, typename Needle>
@@ -127,15 +132,38 @@ segment_set::lower_bound(model::offset offset) const {
 // entry is greater than the target timestamp, the broker will do binary search
 // on that time index to find the closest index entry and scan the log from
 // there. Otherwise it will move on to the next log segment.
+//
+// Segment max timestamps are not monotonic when producers send timestamps out
+// of order, so rather than scanning segments we search their running max
+// through the time summary.
+size_t segment_set::time_lower_bound(model::timestamp needle) const {
+    if (_handles.empty()) {
+        return 0;
+    }
+    if (!_time_summary) {
+        _time_summary.emplace();
+        for (size_t i = 0; i + 1 < _handles.size(); ++i) {
+            _time_summary->push_back(_handles[i]->index().max_timestamp());
+        }
+    }
+    if (auto i = _time_summary->lower_bound(needle);
+        i < _time_summary->size()) {
+        return i;
+    }
+    auto& back = _handles.back();
+    if (!back->empty() && needle <= back->index().max_timestamp()) {
+        return _handles.size() - 1;
+    }
+    return _handles.size();
+}
+
 segment_set::iterator segment_set::lower_bound(model::timestamp needle) {
-    return std::lower_bound(
-      std::begin(_handles), std::end(_handles), needle, segment_ordering{});
+    return std::next(std::begin(_handles), time_lower_bound(needle));
 }
 
 segment_set::const_iterator
 segment_set::lower_bound(model::timestamp needle) const {
-    return segments_lower_bound(
-      std::cbegin(_handles), std::cend(_handles), needle);
+    return std::next(std::cbegin(_handles), time_lower_bound(needle));
 }
 
 std::ostream& operator<<(std::ostream& o, const segment_set& s) {
@@ -146,45 +174,114 @@ std::ostream& operator<<(std::ostream& o, const segment_set& s) {
     return o << "]}";
 }
 
+std::ostream& operator<<(std::ostream& o, const recovery_stats& s) {
+    using std::chrono::duration_cast;
+    using std::chrono::milliseconds;
+    return o << "{segments_opened: " << s.segments_opened
+             << ", segments_replayed: " << s.segments_replayed
+             << ", open_ms: "
+             << duration_cast<milliseconds>(s.open_time).count()
+             << ", hydrate_ms: "
+             << duration_cast<milliseconds>(s.hydrate_time).count()
+             << ", replay_ms: "
+             << duration_cast<milliseconds>(s.replay_time).count() << "}";
+}
+
+// A clean close leaves behind a marker describing the last segment. If the
+// segment on disk still has the same base offset and size, nothing was
+// appended after the close and its index can be trusted.
+static bool
+matches_clean_marker(segment& s, const clean_segment_marker& marker) {
+    if (s.offsets().base_offset != marker.base_offset) {
+        return false;
+    }
+    auto stat = s.reader().stat().get0();
+    return static_cast<uint64_t>(stat.st_size) == marker.size_bytes;
+}
+
 // Recover the last segment. Whenever we close a segment, we will likely
 // open a new one to which we will direct new writes. That new segment
-// might be empty. To optimize log replay, implement #140.
-static ss::future<segment_set>
-unsafe_do_recover(segment_set&& segments, ss::abort_source& as) {
-    return ss::async([segments = std::move(segments), &as]() mutable {
+// might be empty. The last segment is skipped only when the log was closed
+// cleanly, in which case it is treated like any other closed segment.
+static ss::future<segment_set> unsafe_do_recover(
+  segment_set&& segments,
+  ss::abort_source& as,
+  ss::semaphore& io_units,
+  recovery_stats& stats,
+  std::optional<clean_segment_marker> clean_marker) {
+    return ss::async([segments = std::move(segments),
+                      &as,
+                      &io_units,
+                      &stats,
+                      clean_marker]() mutable {
         if (segments.empty() || as.abort_requested()) {
             return std::move(segments);
         }
         segment_set::underlying_t good = std::move(segments).release();
         segment_set::underlying_t to_recover;
-        to_recover.push_back(std::move(good.back()));
-        good.pop_back(); // always recover last segment
-        // keep segments sorted
-        auto good_end = std::stable_partition(
-          good.begin(), good.end(), [](ss::lw_shared_ptr<segment>& ss) {
-              auto& s = *ss;
-              try {
+        const bool trust_last = clean_marker
+                                && matches_clean_marker(
+                                  *good.back(), *clean_marker);
+        if (!trust_last) {
+            to_recover.push_back(std::move(good.back()));
+            good.pop_back();
+        }
+        // hydrate all indices concurrently, bounded by the shard io units
+        const auto hydrate_start = std::chrono::steady_clock::now();
+        std::vector<bool> materialized(good.size(), false);
+        ss::parallel_for_each(
+          boost::irange<size_t>(0, good.size()),
+          [&good, &materialized, &io_units](size_t i) {
+              return ss::with_semaphore(io_units, 1, [&good, &materialized, i] {
+                  auto& s = *good[i];
                   // use the segment materialize instead of going through
                   // the index directly to hydrate the max_offset state
-                  return s.materialize_index().get0();
-              } catch (...) {
-                  vlog(
-                    stlog.info,
-                    "Error materializing index:{}. Recovering parent "
-                    "segment:{}. Details:{}",
-                    s.index().filename(),
-                    s.reader().filename(),
-                    std::current_exception());
-              }
-              return false;
-          });
-        std::move(
-          std::move_iterator(good_end),
-          std::move_iterator(good.end()),
-          std::back_inserter(to_recover));
-        good.erase(
-          good_end,
-          good.end()); // remove all the ones we copied into recover
+                  return s.materialize_index()
+                    .then([&materialized, i](bool yn) { materialized[i] = yn; })
+                    .handle_exception([&s](std::exception_ptr e) {
+                        vlog(
+                          stlog.info,
+                          "Error materializing index:{}. Recovering parent "
+                          "segment:{}. Details:{}",
+                          s.index().filename(),
+                          s.reader().filename(),
+                          e);
+                    });
+              });
+          })
+          .get();
+        stats.hydrate_time += std::chrono::steady_clock::now() - hydrate_start;
+
+        // keep segments sorted
+        segment_set::underlying_t hydrated;
+        for (size_t i = 0; i < good.size(); ++i) {
+            if (materialized[i]) {
+                hydrated.push_back(std::move(good[i]));
+            } else {
+                to_recover.push_back(std::move(good[i]));
+            }
+        }
+        good = std::move(hydrated);
+
+        if (trust_last) {
+            // the index must agree with the offsets recorded at close,
+            // otherwise fall back to replaying the segment
+            if (
+              !good.empty()
+              && good.back()->offsets().base_offset
+                   == clean_marker->base_offset
+              && good.back()->offsets().dirty_offset
+                   != clean_marker->dirty_offset) {
+                to_recover.push_back(std::move(good.back()));
+                good.pop_back();
+            } else if (to_recover.empty()) {
+                vlog(
+                  stlog.debug,
+                  "Skipping recovery of cleanly closed segment: {}",
+                  good.back());
+                return segment_set(std::move(good));
+            }
+        }
 
         // remove empty segments
         auto non_empty_end = std::stable_partition(
@@ -210,11 +307,17 @@ unsafe_do_recover(segment_set&& segments, ss::abort_source& as) {
             good.pop_back();
         }
 
+        const auto replay_start = std::chrono::steady_clock::now();
+        auto account_replay = ss::defer([&stats, replay_start] {
+            stats.replay_time += std::chrono::steady_clock::now()
+                                 - replay_start;
+        });
         for (auto& s : to_recover) {
             // check for abort
             if (unlikely(as.abort_requested())) {
                 return segment_set(std::move(good));
             }
+            ++stats.segments_replayed;
             auto replayer = log_replayer(*s);
             auto recovered = replayer.recover_in_thread(
               ss::default_priority_class());
@@ -240,8 +343,12 @@ unsafe_do_recover(segment_set&& segments, ss::abort_source& as) {
     });
 }
 
-static ss::future<segment_set>
-do_recover(segment_set&& segments, ss::abort_source& as) {
+static ss::future<segment_set> do_recover(
+  segment_set&& segments,
+  ss::abort_source& as,
+  ss::semaphore& io_units,
+  recovery_stats& stats,
+  std::optional<clean_segment_marker> clean_marker) {
     // light-weight copy used for clean-up if recovery fails
     segment_set::underlying_t copy;
     copy.reserve(segments.size());
@@ -253,7 +360,8 @@ do_recover(segment_set&& segments, ss::abort_source& as) {
     // are any pending io operations on a file associated with the segment
     // at the time of destruction seastar will complain about the file handle
     // being destroyed with pending ops.
-    return unsafe_do_recover(std::move(segments), as)
+    return unsafe_do_recover(
+             std::move(segments), as, io_units, stats, clean_marker)
       .handle_exception(
         [copy = std::move(copy)](const std::exception_ptr& ex) mutable {
             return ss::do_with(
@@ -276,6 +384,9 @@ do_recover(segment_set&& segments, ss::abort_source& as) {
 /**
  * \brief Open all segments in a directory.
  *
+ * The directory is listed first and the segments are then opened
+ * concurrently, each open holding one of the shard \p io_units.
+ *
  * Returns an exceptional future if any error occured opening a
  * segment. Otherwise all open segment readers are returned.
  */
@@ -283,16 +394,16 @@ static ss::future<segment_set::underlying_t> open_segments(
   ss::sstring dir,
   debug_sanitize_files sanitize_fileops,
   std::function<std::optional<batch_cache_index>()> cache_factory,
-  ss::abort_source& as) {
+  ss::abort_source& as,
+  ss::semaphore& io_units) {
     using segs_type = segment_set::underlying_t;
     return ss::do_with(
+      std::vector<std::filesystem::path>{},
       segs_type{},
-      [&as, cache_factory, sanitize_fileops, dir = std::move(dir)](
-        segs_type& segs) {
+      [&as, &io_units, cache_factory, sanitize_fileops, dir = std::move(dir)](
+        std::vector<std::filesystem::path>& paths, segs_type& segs) {
           auto f = directory_walker::walk(
-            dir,
-            [&as, cache_factory, dir, sanitize_fileops, &segs](
-              ss::directory_entry seg) {
+            dir, [&as, dir, &paths](ss::directory_entry seg) {
                 // abort if requested
                 if (as.abort_requested()) {
                     return ss::now();
@@ -316,19 +427,42 @@ static ss::future<segment_set::underlying_t> open_segments(
                     // not a reader filename
                     return ss::make_ready_future<>();
                 }
-                return open_segment(path, sanitize_fileops, cache_factory())
-                  .then([&segs](ss::lw_shared_ptr<segment> p) {
-                      segs.push_back(std::move(p));
-                  });
+                paths.push_back(std::move(path));
+                return ss::make_ready_future<>();
             });
           /*
-           * if the directory walker returns an exceptional future then all
-           * the segment readers that were created are cleaned up by
-           * ss::do_with.
+           * if opening any of the segments fails then all the segment
+           * readers that were created are cleaned up by ss::do_with.
            */
-          return f.then([&segs]() mutable {
-              return ss::make_ready_future<segs_type>(std::move(segs));
-          });
+          return f
+            .then([&as,
+                   &io_units,
+                   &paths,
+                   &segs,
+                   cache_factory,
+                   sanitize_fileops] {
+                return ss::parallel_for_each(
+                  paths,
+                  [&as, &io_units, &segs, cache_factory, sanitize_fileops](
+                    const std::filesystem::path& path) {
+                      return ss::with_semaphore(
+                        io_units,
+                        1,
+                        [&as, &segs, &path, cache_factory, sanitize_fileops] {
+                            if (as.abort_requested()) {
+                                return ss::now();
+                            }
+                            return open_segment(
+                                     path, sanitize_fileops, cache_factory())
+                              .then([&segs](ss::lw_shared_ptr<segment> p) {
+                                  segs.push_back(std::move(p));
+                              });
+                        });
+                  });
+            })
+            .then([&segs]() mutable {
+                return ss::make_ready_future<segs_type>(std::move(segs));
+            });
       });
 }
 
@@ -337,13 +471,28 @@ ss::future<segment_set> recover_segments(
   debug_sanitize_files sanitize_fileops,
   bool is_compaction_enabled,
   std::function<std::optional<batch_cache_index>()> cache_factory,
-  ss::abort_source& as) {
+  ss::abort_source& as,
+  ss::semaphore& io_units,
+  recovery_stats& stats,
+  std::optional<clean_segment_marker> clean_marker) {
+    auto open_start = std::chrono::steady_clock::now();
     return ss::recursive_touch_directory(path.string())
-      .then([&as, cache_factory, sanitize_fileops, path = std::move(path)] {
+      .then([&as,
+             &io_units,
+             cache_factory,
+             sanitize_fileops,
+             path = std::move(path)] {
           return open_segments(
-            path.string(), sanitize_fileops, cache_factory, as);
+            path.string(), sanitize_fileops, cache_factory, as, io_units);
       })
-      .then([&as, is_compaction_enabled](segment_set::underlying_t segs) {
+      .then([&as,
+             &io_units,
+             &stats,
+             open_start,
+             is_compaction_enabled,
+             clean_marker](segment_set::underlying_t segs) {
+          stats.segments_opened += segs.size();
+          stats.open_time += std::chrono::steady_clock::now() - open_start;
           auto segments = segment_set(std::move(segs));
           // we have to mark compacted segments before recovery to allow reading
           // gaps introduced by compaction
@@ -352,7 +501,8 @@ ss::future<segment_set> recover_segments(
                   s->mark_as_compacted_segment();
               }
           }
-          return do_recover(std::move(segments), as);
+          return do_recover(
+            std::move(segments), as, io_units, stats, clean_marker);
       });
 }
 
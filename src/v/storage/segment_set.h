@@ -12,10 +12,14 @@
 #pragma once
 
 #include "storage/segment.h"
+#include "storage/time_summary.h"
 
 #include <seastar/core/circular_buffer.hh>
+#include <seastar/core/semaphore.hh>
 
+#include <chrono>
 #include <deque>
+#include <optional>
 
 namespace storage {
 /*
@@ -70,6 +74,8 @@ public:
 
     iterator lower_bound(model::offset o);
     const_iterator lower_bound(model::offset o) const;
+    /// first segment that may contain a batch at or after the timestamp,
+    /// regardless of the order in which producers sent timestamps
     iterator lower_bound(model::timestamp o);
     const_iterator lower_bound(model::timestamp o) const;
 
@@ -81,17 +87,58 @@ public:
     const_iterator end() const { return _handles.end(); }
 
 private:
+    size_t time_lower_bound(model::timestamp) const;
+
     underlying_t _handles;
+    // running max timestamps of every segment but the active (back) one,
+    // whose max timestamp still moves. built on the first timestamp lookup
+    mutable std::optional<time_summary> _time_summary;
 
     friend std::ostream& operator<<(std::ostream&, const segment_set&);
 };
 
+/**
+ * Describes the last segment of a log as it was left by a clean close. When
+ * it still matches the segment found on disk, recovery trusts the persisted
+ * index instead of replaying the segment.
+ */
+struct clean_segment_marker {
+    model::offset base_offset;
+    model::offset dirty_offset;
+    uint64_t size_bytes{0};
+};
+
+/// number of concurrent segment open/hydration operations issued per shard
+/// while recovering logs, unless configured otherwise
+static constexpr size_t default_recovery_concurrency = 16;
+
+/// time spent bringing segments back during recovery, accumulated per shard
+struct recovery_stats {
+    using duration = std::chrono::steady_clock::duration;
+
+    size_t segments_opened{0};
+    size_t segments_replayed{0};
+    duration open_time{0};
+    duration hydrate_time{0};
+    duration replay_time{0};
+
+    friend std::ostream& operator<<(std::ostream&, const recovery_stats&);
+};
+
+/**
+ * Opens and recovers every segment under \p path. Segment opens and index
+ * hydration are issued concurrently, each holding one unit of \p io_units
+ * so that the parallelism is bounded for all the logs recovered on a shard.
+ */
 ss::future<segment_set> recover_segments(
   std::filesystem::path path,
   debug_sanitize_files sanitize_fileops,
   bool is_compaction_enabled,
   std::function<std::optional<batch_cache_index>()> batch_cache_factory,
-  ss::abort_source& as);
+  ss::abort_source& as,
+  ss::semaphore& io_units,
+  recovery_stats& stats,
+  std::optional<clean_segment_marker> clean_marker = std::nullopt);
 
 std::ostream& operator<<(std::ostream&, const segment_set&);
 
@@ -10,6 +10,7 @@
 #include "storage/segment_utils.h"
 
 #include "bytes/iobuf_parser.h"
+#include "config/configuration.h"
 #include "likely.h"
 #include "model/timeout_clock.h"
 #include "random/generators.h"
@@ -20,6 +21,7 @@
 #include "storage/lock_manager.h"
 #include "storage/log_reader.h"
 #include "storage/logger.h"
+#include "storage/parser.h"
 #include "storage/parser_utils.h"
 #include "storage/segment.h"
 #include "units.h"
@@ -27,6 +29,7 @@
 #include "vassert.h"
 #include "vlog.h"
 
+#include <seastar/core/align.hh>
 #include <seastar/core/file-types.hh>
 #include <seastar/core/future.hh>
 #include <seastar/core/reactor.hh>
@@ -38,6 +41,8 @@
 #include <fmt/core.h>
 #include <roaring/roaring.hh>
 
+#include <algorithm>
+
 namespace storage::internal {
 using namespace storage; // NOLINT
 
@@ -118,17 +123,15 @@ ss::future<compacted_index_writer> make_compacted_index_writer(
 ss::future<segment_appender_ptr> make_segment_appender(
   const std::filesystem::path& path,
   debug_sanitize_files debug,
-  size_t number_of_chunks,
-  ss::io_priority_class iopc) {
+  segment_appender::options opts) {
     return internal::make_writer_handle(path, debug)
-      .then([number_of_chunks, iopc, path](ss::file writer) {
+      .then([opts, path](ss::file writer) {
           try {
               // NOTE: This try-catch is needed to not uncover the real
               // exception during an OOM condition, since the appender allocates
               // 1MB of memory aligned buffers
               return ss::make_ready_future<segment_appender_ptr>(
-                std::make_unique<segment_appender>(
-                  writer, segment_appender::options(iopc, number_of_chunks)));
+                std::make_unique<segment_appender>(writer, opts));
           } catch (...) {
               auto e = std::current_exception();
               vlog(stlog.error, "could not allocate appender: {}", e);
@@ -150,6 +153,47 @@ size_t number_of_chunks_from_config(const ntp_config& ntpc) {
     return segment_appender::chunks_no_buffer;
 }
 
+static size_t chunks_per_write(size_t write_size, size_t max_chunks) {
+    return std::clamp<size_t>(
+      write_size / segment_appender::chunk_size, 1, max_chunks);
+}
+
+size_t chunks_per_write_from_config(size_t max_chunks) {
+    return chunks_per_write(
+      config::shard_local_cfg().segment_appender_max_write_size(), max_chunks);
+}
+
+size_t
+chunks_per_write_from_config(const ntp_config& ntpc, size_t max_chunks) {
+    if (ntpc.has_overrides() && ntpc.get_overrides().max_write_size) {
+        return chunks_per_write(
+          *ntpc.get_overrides().max_write_size, max_chunks);
+    }
+    return chunks_per_write_from_config(max_chunks);
+}
+
+segment_appender::options appender_options_from_config(
+  const ntp_config& ntpc, size_t append_rate, ss::io_priority_class iopc) {
+    size_t chunks = number_of_chunks_from_config(ntpc);
+    size_t step = segment_appender::fallocation_step;
+    // nothing is known of a new or restarted log until its first roll
+    // samples the rate, it starts from the fixed defaults
+    if (append_rate > 0) {
+        // write-behind absorbs ~100ms of appends, fallocation covers ~1s
+        chunks = std::clamp<size_t>(
+          append_rate / 10 / segment_appender::chunk_size,
+          segment_appender::min_write_behind_chunks,
+          chunks);
+        step = std::clamp<size_t>(
+          ss::align_up<size_t>(append_rate, 1_MiB),
+          segment_appender::min_fallocation_step,
+          segment_appender::max_fallocation_step);
+    }
+    auto opts = segment_appender::options(iopc, chunks, step);
+    opts.chunks_per_write = chunks_per_write_from_config(ntpc, chunks);
+    return opts;
+}
+
 ss::future<Roaring>
 natural_index_of_entries_to_keep(compacted_index_reader reader) {
     reader.reset();
@@ -297,15 +341,15 @@ ss::future<storage::index_state> do_copy_segment_data(
       .then(
         [cfg, s, &pb, h = std::move(h)](compacted_offset_list list) mutable {
             const auto tmpname = data_segment_staging_name(s);
-            return make_segment_appender(
-                     tmpname,
-                     cfg.sanitize,
-                     segment_appender::chunks_no_buffer,
-                     cfg.iopc)
+            auto opts = segment_appender::options(
+              cfg.iopc, segment_appender::chunks_no_buffer);
+            opts.chunks_per_write = chunks_per_write_from_config(
+              segment_appender::chunks_no_buffer);
+            return make_segment_appender(tmpname, cfg.sanitize, opts)
               .then([l = std::move(list), &pb, h = std::move(h), cfg, s](
                       segment_appender_ptr w) mutable {
                   auto raw = w.get();
-                  auto red = copy_data_segment_reducer(std::move(l), raw);
+                  auto red = copy_data_segment_reducer(std::move(l), raw, pb);
                   auto r = create_segment_full_reader(s, cfg, pb, std::move(h));
                   return std::move(r)
                     .consume(std::move(red), model::no_timeout)
@@ -394,17 +438,25 @@ ss::future<> do_self_compact_segment(
                 return do_copy_segment_data(s, cfg, pb, std::move(h));
             });
       })
-      .then([s](storage::index_state idx) {
-          return s->write_lock().then(
-            [s, idx = std::move(idx)](ss::rwlock::holder h) mutable {
-                using type = std::tuple<index_state, ss::rwlock::holder>;
-                if (s->is_closed()) {
-                    return ss::make_exception_future<type>(
-                      segment_closed_exception());
-                }
-                return ss::make_ready_future<type>(
-                  std::make_tuple(std::move(idx), std::move(h)));
-            });
+      .then([cfg, s, &pb](storage::index_state idx) {
+          return do_swap_staged_segment_data(s, cfg, pb, std::move(idx));
+      });
+}
+
+ss::future<> do_swap_staged_segment_data(
+  ss::lw_shared_ptr<segment> s,
+  compaction_config cfg,
+  storage::probe& pb,
+  storage::index_state idx) {
+    return s->write_lock()
+      .then([s, idx = std::move(idx)](ss::rwlock::holder h) mutable {
+          using type = std::tuple<index_state, ss::rwlock::holder>;
+          if (s->is_closed()) {
+              return ss::make_exception_future<type>(
+                segment_closed_exception());
+          }
+          return ss::make_ready_future<type>(
+            std::make_tuple(std::move(idx), std::move(h)));
       })
       .then([cfg, s, &pb](std::tuple<index_state, ss::rwlock::holder> h) {
           return s->index()
@@ -424,6 +476,140 @@ ss::future<> do_self_compact_segment(
       });
 }
 
+/// scans the batch headers of a segment and stops at the first data batch
+/// that is not in the target codec. payloads are skipped, not read
+class recompress_check_consumer final : public batch_consumer {
+public:
+    explicit recompress_check_consumer(
+      model::compression c, bool& needed) noexcept
+      : _codec(c)
+      , _needed(&needed) {}
+
+    consume_result consume_batch_start(
+      model::record_batch_header h, size_t, size_t) override {
+        if (
+          h.type == model::data_record_batch_type
+          && h.attrs.compression() != _codec) {
+            *_needed = true;
+            return stop_parser::yes;
+        }
+        return skip_batch::yes;
+    }
+    void consume_records(iobuf&&) override {}
+    stop_parser consume_batch_end() override { return stop_parser::no; }
+    void print(std::ostream& os) const override {
+        os << "storage::recompress_check_consumer";
+    }
+
+private:
+    model::compression _codec;
+    bool* _needed;
+};
+
+static ss::future<bool> segment_needs_recompression(
+  ss::lw_shared_ptr<segment> s,
+  model::compression codec,
+  compaction_config cfg) {
+    return ss::do_with(false, [s, codec, cfg](bool& needed) {
+        auto parser = std::make_unique<continuous_batch_parser>(
+          std::make_unique<recompress_check_consumer>(codec, needed),
+          s->reader().data_stream(0, cfg.iopc));
+        auto p = parser.get();
+        return p->consume()
+          .discard_result()
+          .finally([p, parser = std::move(parser)]() mutable {
+              return p->close().finally([parser = std::move(parser)] {});
+          })
+          .then([&needed] { return needed; });
+    });
+}
+
+static ss::future<recompress_segment_reducer::result>
+do_recompress_segment_data(
+  ss::lw_shared_ptr<segment> s,
+  model::compression codec,
+  compaction_config cfg,
+  storage::probe& pb,
+  ss::rwlock::holder h) {
+    const auto tmpname = data_segment_staging_name(s);
+    auto opts = segment_appender::options(
+      cfg.iopc, segment_appender::chunks_no_buffer);
+    opts.chunks_per_write = chunks_per_write_from_config(
+      segment_appender::chunks_no_buffer);
+    return make_segment_appender(tmpname, cfg.sanitize, opts)
+      .then([s, codec, cfg, &pb, h = std::move(h)](
+              segment_appender_ptr w) mutable {
+          auto raw = w.get();
+          auto r = create_segment_full_reader(s, cfg, pb, std::move(h));
+          return std::move(r)
+            .consume(
+              recompress_segment_reducer(codec, raw, pb), model::no_timeout)
+            .finally([raw, w = std::move(w)]() mutable {
+                return raw->close()
+                  .handle_exception([](std::exception_ptr e) {
+                      vlog(
+                        stlog.error,
+                        "Error closing recompressed segment:{}",
+                        e);
+                  })
+                  .finally([w = std::move(w)] {});
+            });
+      });
+}
+
+ss::future<> recompress_segment(
+  ss::lw_shared_ptr<segment> s,
+  model::compression codec,
+  compaction_config cfg,
+  storage::probe& pb) {
+    if (s->has_appender()) {
+        return ss::make_exception_future<>(std::runtime_error(fmt::format(
+          "Cannot recompress an active segment. cfg:{} - segment:{}",
+          cfg,
+          s)));
+    }
+    return s->read_lock()
+      .then([s, codec, cfg, &pb](ss::rwlock::holder h) {
+          if (s->is_closed()) {
+              return ss::make_exception_future<
+                std::optional<recompress_segment_reducer::result>>(
+                segment_closed_exception());
+          }
+          // check the headers first so that segments already in the codec,
+          // e.g. all of them after a restart, are not copied to staging
+          return segment_needs_recompression(s, codec, cfg)
+            .then([s, codec, cfg, &pb, h = std::move(h)](bool needed) mutable {
+                if (!needed) {
+                    return ss::make_ready_future<
+                      std::optional<recompress_segment_reducer::result>>(
+                      std::nullopt);
+                }
+                return do_recompress_segment_data(
+                         s, codec, cfg, pb, std::move(h))
+                  .then([](recompress_segment_reducer::result r) {
+                      return std::make_optional(std::move(r));
+                  });
+            });
+      })
+      .then([s, cfg, &pb](
+              std::optional<recompress_segment_reducer::result> r) {
+          if (!r) {
+              return ss::now();
+          }
+          if (r->recompressed == 0) {
+              // every batch was in the codec already, the copy is not needed
+              return ss::remove_file(data_segment_staging_name(s).string());
+          }
+          vlog(
+            stlog.debug,
+            "recompressed {} batches of {}",
+            r->recompressed,
+            s->reader().filename());
+          pb.segment_recompressed();
+          return do_swap_staged_segment_data(s, cfg, pb, std::move(r->idx));
+      });
+}
+
 ss::future<> rebuild_compaction_index(
   model::record_batch_reader rdr,
   std::filesystem::path p,
@@ -10,6 +10,7 @@
  */
 
 #pragma once
+#include "model/compression.h"
 #include "model/record_batch_reader.h"
 #include "storage/compacted_index.h"
 #include "storage/compacted_index_reader.h"
@@ -35,6 +36,14 @@ ss::future<> self_compact_segment(
   storage::compaction_config,
   storage::probe&);
 
+/// \brief rewrites the data batches of a closed segment in the given codec,
+/// this method will acquire it's own locks on the segment
+ss::future<> recompress_segment(
+  ss::lw_shared_ptr<storage::segment>,
+  model::compression,
+  storage::compaction_config,
+  storage::probe&);
+
 /// make file handle with default opts
 ss::future<ss::file>
 make_writer_handle(const std::filesystem::path&, storage::debug_sanitize_files);
@@ -50,10 +59,19 @@ ss::future<compacted_index_writer> make_compacted_index_writer(
 ss::future<segment_appender_ptr> make_segment_appender(
   const std::filesystem::path& path,
   storage::debug_sanitize_files debug,
-  size_t number_of_chunks,
-  ss::io_priority_class iopc);
+  segment_appender::options opts);
 
 size_t number_of_chunks_from_config(const storage::ntp_config&);
+/// chunks per vectored write, bounded by the appender's write-behind chunks
+size_t chunks_per_write_from_config(size_t number_of_chunks);
+/// same as above, honoring the log's max_write_size override
+size_t chunks_per_write_from_config(
+  const storage::ntp_config&, size_t number_of_chunks);
+/// sizes the write-behind window and fallocation step of a new appender from
+/// the log's observed append rate, in bytes per second. 0 when it is not
+/// known yet
+segment_appender::options appender_options_from_config(
+  const storage::ntp_config&, size_t append_rate, ss::io_priority_class);
 
 /*
 1. if footer.flags == truncate write new .compacted_index file
@@ -97,6 +115,14 @@ ss::future<storage::index_state> do_copy_segment_data(
   storage::probe&,
   ss::rwlock::holder);
 
+/// \brief replaces the data of a segment with its staging copy, written by
+/// self compaction or recompression. acquires the segment write lock
+ss::future<> do_swap_staged_segment_data(
+  ss::lw_shared_ptr<storage::segment>,
+  storage::compaction_config,
+  storage::probe&,
+  storage::index_state);
+
 ss::future<> do_swap_data_file_handles(
   std::filesystem::path compacted,
   ss::lw_shared_ptr<storage::segment>,
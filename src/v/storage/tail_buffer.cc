@@ -0,0 +1,137 @@
+// Copyright 2020 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "storage/tail_buffer.h"
+
+#include <algorithm>
+
+namespace storage {
+
+void tail_buffer::set_enabled(bool enabled) {
+    if (_enabled == enabled) {
+        return;
+    }
+    _enabled = enabled && _max_bytes > 0;
+    _followed = false;
+    if (_enabled) {
+        internal::tail_buffers()._buffers.push_back(*this);
+    } else {
+        clear();
+        _hook.unlink();
+    }
+}
+
+void tail_buffer::push(const model::record_batch& batch) {
+    if (!_followed) {
+        return;
+    }
+    // the buffer only serves contiguous ranges, so a gap (e.g. ghost
+    // batches, which never make it to disk) starts it over
+    if (
+      !_batches.empty()
+      && _batches.back().last_offset() + model::offset(1)
+           != batch.base_offset()) {
+        clear();
+    }
+    if (batch.memory_usage() > _max_bytes) {
+        clear();
+        return;
+    }
+    auto copy = batch.copy();
+    const size_t size = copy.memory_usage();
+    while (!_batches.empty() && _size_bytes + size > _max_bytes) {
+        pop_front();
+    }
+    _batches.push_back(std::move(copy));
+    _size_bytes += size;
+    internal::tail_buffers()._size_bytes += size;
+}
+
+void tail_buffer::pop_front() {
+    const size_t size = _batches.front().memory_usage();
+    _batches.pop_front();
+    _size_bytes -= size;
+    internal::tail_buffers()._size_bytes -= size;
+}
+
+void tail_buffer::truncate(model::offset o) {
+    while (!_batches.empty() && _batches.back().last_offset() >= o) {
+        const size_t size = _batches.back().memory_usage();
+        _batches.pop_back();
+        _size_bytes -= size;
+        internal::tail_buffers()._size_bytes -= size;
+    }
+}
+
+void tail_buffer::prefix_truncate(model::offset o) {
+    while (!_batches.empty() && _batches.front().base_offset() < o) {
+        pop_front();
+    }
+}
+
+void tail_buffer::clear() {
+    internal::tail_buffers()._size_bytes -= _size_bytes;
+    _size_bytes = 0;
+    _batches.clear();
+}
+
+std::optional<raw_read_result>
+tail_buffer::read(const log_reader_config& cfg) {
+    auto& registry = internal::tail_buffers();
+    _followed = _enabled;
+    if (
+      _batches.empty() || cfg.start_offset < _batches.front().base_offset()
+      || cfg.start_offset > _batches.back().last_offset()) {
+        ++registry._misses;
+        return std::nullopt;
+    }
+    ++registry._hits;
+    auto it = std::partition_point(
+      _batches.begin(), _batches.end(), [&cfg](const model::record_batch& b) {
+          return b.last_offset() < cfg.start_offset;
+      });
+    raw_read_result ret;
+    size_t bytes_consumed = cfg.bytes_consumed;
+    for (; it != _batches.end() && it->base_offset() <= cfg.max_offset;
+         ++it) {
+        const auto& h = it->header();
+        if (cfg.type_filter && cfg.type_filter != h.type) {
+            continue;
+        }
+        if (cfg.first_timestamp > h.first_timestamp) {
+            continue;
+        }
+        if (
+          (cfg.strict_max_bytes || bytes_consumed)
+          && bytes_consumed + h.size_bytes > cfg.max_bytes) {
+            break;
+        }
+        bytes_consumed += h.size_bytes;
+        ret.batches.push_back(raw_read_result::batch{
+          .header = h,
+          .payload = it->data().share(0, it->data().size_bytes())});
+    }
+    return ret;
+}
+
+tail_buffer_registry::reclaim_result
+tail_buffer_registry::reclaim(reclaimer::request r) {
+    size_t reclaimed = 0;
+    for (auto& b : _buffers) {
+        if (reclaimed >= r.bytes_to_reclaim) {
+            break;
+        }
+        reclaimed += b.size_bytes();
+        b.clear();
+    }
+    return reclaimed ? reclaim_result::reclaimed_something
+                     : reclaim_result::reclaimed_nothing;
+}
+
+} // namespace storage
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2020 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+#include "model/record.h"
+#include "seastarx.h"
+#include "storage/types.h"
+#include "units.h"
+#include "utils/intrusive_list_helpers.h"
+
+#include <seastar/core/circular_buffer.hh>
+#include <seastar/core/memory.hh>
+
+#include <optional>
+
+namespace storage {
+
+/**
+ * The most recently appended batches of a log, bounded in bytes. Consumers
+ * following the tail of a partition fetch offsets appended moments ago; the
+ * tail buffer serves those reads straight from memory, without locking
+ * segment ranges or going through the log reader and the batch cache.
+ *
+ * Only enabled while the log's raft group is the leader, and only buffers
+ * appends once a consumer has read the tail, so that partitions nobody
+ * follows don't pay for it. Batches are copied in so that they don't pin the
+ * buffers of the request that produced them.
+ */
+class tail_buffer {
+public:
+    static constexpr size_t default_max_bytes = 128_KiB;
+
+    explicit tail_buffer(size_t max_bytes = default_max_bytes) noexcept
+      : _max_bytes(max_bytes) {}
+    tail_buffer(tail_buffer&&) = delete;
+    tail_buffer& operator=(tail_buffer&&) = delete;
+    tail_buffer(const tail_buffer&) = delete;
+    tail_buffer& operator=(const tail_buffer&) = delete;
+    ~tail_buffer() noexcept { clear(); }
+
+    /// a disabled tail buffer is empty and ignores appends. an enabled one
+    /// starts buffering appends after its first read
+    void set_enabled(bool);
+    bool enabled() const { return _enabled; }
+
+    /// a batch just appended to the log
+    void push(const model::record_batch&);
+    /// drops the batches at or above \p o
+    void truncate(model::offset o);
+    /// drops the batches below \p o
+    void prefix_truncate(model::offset o);
+    void clear();
+
+    /// the batches of the read when the buffer holds its start offset,
+    /// filtered and bounded like a log reader would
+    std::optional<raw_read_result> read(const log_reader_config&);
+
+    size_t size_bytes() const { return _size_bytes; }
+
+private:
+    friend class tail_buffer_registry;
+
+    void pop_front();
+
+    ss::circular_buffer<model::record_batch> _batches;
+    size_t _size_bytes{0};
+    size_t _max_bytes;
+    bool _enabled{false};
+    // set by the first read while enabled
+    bool _followed{false};
+    intrusive_list_hook _hook;
+};
+
+/**
+ * Shard-wide accounting of the enabled tail buffers. Their memory is given
+ * back to seastar through a reclaimer, oldest batches first.
+ */
+class tail_buffer_registry {
+    using reclaimer = ss::memory::reclaimer;
+    using reclaim_result = ss::memory::reclaiming_result;
+
+public:
+    tail_buffer_registry() noexcept
+      : _reclaimer(
+        [this](reclaimer::request r) { return reclaim(r); },
+        ss::memory::reclaimer_scope::async) {}
+    tail_buffer_registry(tail_buffer_registry&&) = delete;
+    tail_buffer_registry& operator=(tail_buffer_registry&&) = delete;
+    tail_buffer_registry(const tail_buffer_registry&) = delete;
+    tail_buffer_registry& operator=(const tail_buffer_registry&) = delete;
+    ~tail_buffer_registry() noexcept = default;
+
+    size_t size_bytes() const { return _size_bytes; }
+    uint64_t hits() const { return _hits; }
+    uint64_t misses() const { return _misses; }
+
+private:
+    friend class tail_buffer;
+
+    reclaim_result reclaim(reclaimer::request);
+
+    intrusive_list<tail_buffer, &tail_buffer::_hook> _buffers;
+    size_t _size_bytes{0};
+    uint64_t _hits{0};
+    uint64_t _misses{0};
+    reclaimer _reclaimer;
+};
+
+namespace internal {
+inline tail_buffer_registry& tail_buffers() {
+    static thread_local tail_buffer_registry registry;
+    return registry;
+}
+} // namespace internal
+
+} // namespace storage
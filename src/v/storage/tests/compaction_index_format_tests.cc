@@ -344,3 +344,15 @@ FIXTURE_TEST(index_filtered_copy_tests, compacted_topic_fixture) {
         }
     }
 }
+
+FIXTURE_TEST(offset_list_range_count, compacted_topic_fixture) {
+    storage::internal::compacted_offset_list list(model::offset(100), {});
+    for (auto o : {100, 101, 105, 110, 111, 112}) {
+        list.add(model::offset(o));
+    }
+    BOOST_REQUIRE_EQUAL(list.count(model::offset(100), model::offset(100)), 1);
+    BOOST_REQUIRE_EQUAL(list.count(model::offset(100), model::offset(112)), 6);
+    BOOST_REQUIRE_EQUAL(list.count(model::offset(102), model::offset(104)), 0);
+    BOOST_REQUIRE_EQUAL(list.count(model::offset(105), model::offset(111)), 3);
+    BOOST_REQUIRE_EQUAL(list.count(model::offset(113), model::offset(200)), 0);
+}
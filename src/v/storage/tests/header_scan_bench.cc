@@ -0,0 +1,146 @@
+// Copyright 2020 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "bytes/bytes.h"
+#include "bytes/iobuf.h"
+#include "model/record.h"
+#include "model/record_utils.h"
+#include "random/generators.h"
+#include "reflection/adl.h"
+#include "storage/parser.h"
+#include "storage/parser_utils.h"
+
+#include <seastar/testing/perf_tests.hh>
+
+static constexpr size_t batches = 10'000;
+static constexpr size_t payload_size = 128;
+
+struct counting_consumer final : public storage::batch_consumer {
+    consume_result consume_batch_start(
+      model::record_batch_header, size_t, size_t) override {
+        ++headers;
+        return skip_batch::no;
+    }
+    void consume_records(iobuf&&) override {}
+    stop_parser consume_batch_end() override { return stop_parser::no; }
+    void print(std::ostream& os) const override { os << "counting_consumer"; }
+
+    size_t headers{0};
+};
+
+struct counting_scan_consumer final : public storage::batch_scan_consumer {
+    consume_result consume_batch_start(
+      const model::record_batch_header&, size_t) override {
+        ++headers;
+        return skip_batch::no;
+    }
+    stop_parser consume_batch_end() override { return stop_parser::no; }
+    void print(std::ostream& os) const override {
+        os << "counting_scan_consumer";
+    }
+
+    size_t headers{0};
+};
+
+struct header_scan_bench {
+    // a segment worth of small batches laid out as on disk
+    header_scan_bench() {
+        auto payload = random_generators::gen_alphanum_string(payload_size);
+        for (size_t i = 0; i < batches; ++i) {
+            iobuf records;
+            records.append(payload.data(), payload.size());
+            model::record_batch_header h{
+              .size_bytes = static_cast<int32_t>(
+                model::packed_record_batch_header_size + payload_size),
+              .base_offset = model::offset(i * 10),
+              .type = model::record_batch_type(1),
+              .last_offset_delta = 9,
+              .first_timestamp = model::timestamp(i),
+              .max_timestamp = model::timestamp(i + 10),
+              .producer_id = -1,
+              .producer_epoch = -1,
+              .base_sequence = -1,
+              .record_count = 10};
+            h.crc = model::crc_record_batch(h, records);
+            h.header_crc = model::internal_header_only_crc(h);
+            reflection::serialize(
+              segment,
+              h.header_crc,
+              h.size_bytes,
+              h.base_offset(),
+              h.type(),
+              h.crc,
+              h.attrs.value(),
+              h.last_offset_delta,
+              h.first_timestamp.value(),
+              h.max_timestamp.value(),
+              h.producer_id,
+              h.producer_epoch,
+              h.base_sequence,
+              h.record_count);
+            segment.append(std::move(records));
+        }
+        packed = iobuf_to_bytes(
+          segment.share(0, model::packed_record_batch_header_size));
+    }
+
+    iobuf segment;
+    bytes packed;
+};
+
+PERF_TEST_F(header_scan_bench, header_crc_by_field) {
+    auto h = storage::internal::header_from_bytes(
+      reinterpret_cast<const char*>(packed.data()));
+    perf_tests::start_measuring_time();
+    auto crc = model::internal_header_only_crc(h);
+    perf_tests::do_not_optimize(crc);
+    perf_tests::stop_measuring_time();
+}
+
+PERF_TEST_F(header_scan_bench, header_crc_packed) {
+    const auto* p = reinterpret_cast<const char*>(packed.data());
+    perf_tests::start_measuring_time();
+    auto crc = storage::internal::packed_header_crc(p);
+    perf_tests::do_not_optimize(crc);
+    perf_tests::stop_measuring_time();
+}
+
+PERF_TEST_F(header_scan_bench, decode_packed_header) {
+    const auto* p = reinterpret_cast<const char*>(packed.data());
+    perf_tests::start_measuring_time();
+    auto h = storage::internal::header_from_bytes(p);
+    perf_tests::do_not_optimize(h);
+    perf_tests::stop_measuring_time();
+}
+
+PERF_TEST_F(header_scan_bench, continuous_batch_parser) {
+    auto consumer = std::make_unique<counting_consumer>();
+    auto parser = ss::make_lw_shared<storage::continuous_batch_parser>(
+      std::move(consumer),
+      make_iobuf_input_stream(segment.share(0, segment.size_bytes())));
+    perf_tests::start_measuring_time();
+    return parser->consume().then([parser](result<size_t> r) {
+        perf_tests::stop_measuring_time();
+        perf_tests::do_not_optimize(r);
+        return parser->close().finally([parser] {});
+    });
+}
+
+PERF_TEST_F(header_scan_bench, batch_header_scanner) {
+    auto consumer = ss::make_lw_shared<counting_scan_consumer>();
+    auto scanner = ss::make_lw_shared<storage::batch_header_scanner>(
+      *consumer,
+      make_iobuf_input_stream(segment.share(0, segment.size_bytes())));
+    perf_tests::start_measuring_time();
+    return scanner->consume().then([scanner, consumer](result<size_t> r) {
+        perf_tests::stop_measuring_time();
+        perf_tests::do_not_optimize(r);
+        return scanner->close().finally([scanner, consumer] {});
+    });
+}
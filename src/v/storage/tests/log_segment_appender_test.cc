@@ -10,7 +10,10 @@
 #include "bytes/iobuf.h"
 #include "random/generators.h"
 #include "seastarx.h"
+#include "storage/ntp_config.h"
 #include "storage/segment_appender.h"
+#include "storage/segment_utils.h"
+#include "units.h"
 
 #include <seastar/core/reactor.hh>
 #include <seastar/core/thread.hh>
@@ -217,3 +220,90 @@ SEASTAR_THREAD_TEST_CASE(test_can_append_little_data) {
     BOOST_REQUIRE_EQUAL(appender.file_byte_offset(), data.size());
     appender.close().get();
 }
+
+SEASTAR_THREAD_TEST_CASE(test_can_append_vectored_writes) {
+    auto f = ss::open_file_dma(
+               "test_segment_appender_vectored.log",
+               ss::open_flags::create | ss::open_flags::rw
+                 | ss::open_flags::truncate)
+               .get0();
+    auto opts = segment_appender::options(ss::default_priority_class(), 8);
+    opts.chunks_per_write = 4;
+    auto appender = segment_appender(f, opts);
+    iobuf expected;
+    for (size_t i = 0; i < 50; ++i) {
+        // a mix of small appends and appends spanning several chunks
+        const size_t step = random_generators::get_int<size_t>(
+          1, segment_appender::chunk_size * 5);
+        const auto data = random_generators::gen_alphanum_string(step);
+        expected.append(data.data(), data.size());
+        appender.append(data.data(), data.size()).get();
+        if (i % 10 == 0) {
+            appender.flush().get();
+        }
+    }
+    appender.flush().get();
+    BOOST_REQUIRE_EQUAL(appender.file_byte_offset(), expected.size_bytes());
+    BOOST_REQUIRE_GE(appender.take_dma_bytes_written(), expected.size_bytes());
+    BOOST_REQUIRE_EQUAL(appender.take_dma_bytes_written(), 0);
+    auto in = make_file_input_stream(f, 0);
+    iobuf result = read_iobuf_exactly(in, expected.size_bytes()).get0();
+    BOOST_REQUIRE_EQUAL(result, expected);
+    in.close().get();
+    appender.close().get();
+}
+
+SEASTAR_THREAD_TEST_CASE(test_appender_options_from_append_rate) {
+    const storage::ntp_config ntpc(
+      model::ntp(
+        model::ns("test"), model::topic("appender"), model::partition_id(0)),
+      "test.dir");
+    auto options = [&ntpc](size_t rate) {
+        return internal::appender_options_from_config(
+          ntpc, rate, ss::default_priority_class());
+    };
+
+    // a new or restarted log starts from the fixed defaults
+    auto o = options(0);
+    BOOST_REQUIRE_EQUAL(o.number_of_chunks, segment_appender::chunks_no_buffer);
+    BOOST_REQUIRE_EQUAL(o.falloc_step, segment_appender::fallocation_step);
+    BOOST_REQUIRE_EQUAL(
+      o.chunks_per_write,
+      internal::chunks_per_write_from_config(
+        segment_appender::chunks_no_buffer));
+
+    // a slow log gets the smallest window and step
+    o = options(1_KiB);
+    BOOST_REQUIRE_EQUAL(
+      o.number_of_chunks, segment_appender::min_write_behind_chunks);
+    BOOST_REQUIRE_EQUAL(o.falloc_step, segment_appender::min_fallocation_step);
+    BOOST_REQUIRE_LE(o.chunks_per_write, o.number_of_chunks);
+
+    // ~100ms of appends in write-behind, ~1s of appends per fallocation
+    o = options(5_MiB);
+    BOOST_REQUIRE_EQUAL(
+      o.number_of_chunks, 512_KiB / segment_appender::chunk_size);
+    BOOST_REQUIRE_EQUAL(o.falloc_step, 5_MiB);
+
+    // a hot log is capped on both
+    o = options(1_GiB);
+    BOOST_REQUIRE_EQUAL(o.number_of_chunks, segment_appender::chunks_no_buffer);
+    BOOST_REQUIRE_EQUAL(o.falloc_step, segment_appender::max_fallocation_step);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_appender_write_size_override) {
+    using overrides_t = storage::ntp_config::default_overrides;
+    auto ov = std::make_unique<overrides_t>();
+    ov->max_write_size = 2 * segment_appender::chunk_size;
+    const storage::ntp_config ntpc(
+      model::ntp(
+        model::ns("test"), model::topic("appender"), model::partition_id(0)),
+      "test.dir",
+      std::move(ov));
+
+    auto o = internal::appender_options_from_config(
+      ntpc, 0, ss::default_priority_class());
+    BOOST_REQUIRE_EQUAL(o.chunks_per_write, 2);
+    // still bounded by the write-behind chunks
+    BOOST_REQUIRE_EQUAL(internal::chunks_per_write_from_config(ntpc, 1), 1);
+}
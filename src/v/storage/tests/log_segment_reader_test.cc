@@ -13,6 +13,8 @@
 #include "model/timeout_clock.h"
 #include "random/generators.h"
 #include "storage/disk_log_appender.h"
+#include "storage/extent_cache.h"
+#include "storage/file_handle_budget.h"
 #include "storage/log_reader.h"
 #include "storage/segment_appender.h"
 #include "storage/segment_appender_utils.h"
@@ -288,3 +290,89 @@ SEASTAR_THREAD_TEST_CASE(test_does_not_read_past_max_offset) {
     b | stop();
     check_batches(res, batches);
 }
+
+SEASTAR_THREAD_TEST_CASE(test_lazy_reader_respects_file_handle_budget) {
+    disk_log_builder b;
+    b | start() | add_segment(1);
+    auto batches = test::make_random_batches(model::offset(1), 1);
+    write(copy(batches), b);
+    auto seg = b.get_log_segments().front();
+
+    auto& budget = internal::file_handles();
+    budget.set_limit(0);
+    auto lazy = segment_reader(
+      seg->reader().filename(),
+      seg->reader().file_size(),
+      128,
+      debug_sanitize_files::no);
+    BOOST_REQUIRE(!lazy.is_open());
+
+    auto in = lazy.data_stream(0, ss::default_priority_class());
+    auto buf = in.read().get0();
+    BOOST_REQUIRE(!buf.empty());
+    // pinned while the stream is reading
+    BOOST_REQUIRE(lazy.is_open());
+    in.close().get();
+    // idle handles are closed once the shard is over budget
+    BOOST_REQUIRE(!lazy.is_open());
+
+    budget.set_limit(internal::file_handle_budget::default_max_open_files);
+    lazy.close().get();
+    b | stop();
+}
+
+SEASTAR_THREAD_TEST_CASE(test_extent_cache_serves_repeated_reads) {
+    const ss::sstring name = "test_extent_cache.log";
+    auto f = ss::open_file_dma(
+               name,
+               ss::open_flags::create | ss::open_flags::rw
+                 | ss::open_flags::truncate)
+               .get0();
+    auto appender = segment_appender(
+      f, segment_appender::options(ss::default_priority_class(), 1));
+    constexpr size_t extent = internal::extent_cache::extent_size;
+    const auto data = random_generators::gen_alphanum_string(extent * 3 + 100);
+    appender.append(data.data(), data.size()).get();
+    appender.close().get();
+
+    auto& cache = internal::extents();
+    auto reader = segment_reader(
+      name, data.size(), 128_KiB, debug_sanitize_files::no);
+    auto read_from = [&reader, &data](size_t pos) {
+        auto in = reader.data_stream(pos, ss::default_priority_class());
+        auto buf = in.read_exactly(data.size() - pos).get0();
+        in.close().get();
+        return ss::sstring(buf.get(), buf.size());
+    };
+
+    BOOST_REQUIRE_EQUAL(read_from(0), data);
+    // the full extents are now cached, only the tail goes to disk
+    const auto hits = cache.hits();
+    BOOST_REQUIRE_EQUAL(read_from(100), data.substr(100));
+    BOOST_REQUIRE_EQUAL(cache.hits(), hits + 3);
+
+    // truncation drops the extents that are no longer full
+    const auto cached = cache.size_bytes();
+    reader.truncate(extent + 10).get();
+    BOOST_REQUIRE_EQUAL(cache.size_bytes(), cached - 2 * extent);
+    reader.close().get();
+    BOOST_REQUIRE_EQUAL(cache.size_bytes(), cached - 3 * extent);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_extent_cache_ignores_closed_files) {
+    auto& cache = internal::extents();
+    const std::vector<char> data(internal::extent_cache::extent_size, 'x');
+    const auto open = cache.register_file();
+    const auto closed = cache.register_file();
+    cache.unregister_file(closed);
+
+    const auto cached = cache.size_bytes();
+    // a read that completes after its reader was closed caches nothing
+    cache.put(closed, 0, data.data());
+    BOOST_REQUIRE_EQUAL(cache.size_bytes(), cached);
+    cache.put(open, 0, data.data());
+    BOOST_REQUIRE_EQUAL(
+      cache.size_bytes(), cached + internal::extent_cache::extent_size);
+    cache.unregister_file(open);
+    BOOST_REQUIRE_EQUAL(cache.size_bytes(), cached);
+}
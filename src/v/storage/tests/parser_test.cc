@@ -7,12 +7,16 @@
 // the Business Source License, use of this software will be governed
 // by the Apache License, Version 2.0
 
+#include "bytes/bytes.h"
 #include "bytes/iobuf.h"
 #include "model/compression.h"
 #include "model/fundamental.h"
 #include "model/record.h"
+#include "model/record_utils.h"
+#include "reflection/adl.h"
 #include "storage/disk_log_appender.h"
 #include "storage/parser.h"
+#include "storage/parser_utils.h"
 #include "storage/segment_appender_utils.h"
 #include "storage/segment_reader.h"
 #include "storage/tests/utils/random_batch.h"
@@ -30,6 +34,34 @@ struct test_consumer_reporter {
 };
 
 SEASTAR_THREAD_TEST_CASE(dummy) { BOOST_REQUIRE(true); }
+
+SEASTAR_THREAD_TEST_CASE(test_packed_header_decode) {
+    auto batches = test::make_random_batches(model::offset(10), 10);
+    for (auto& b : batches) {
+        const auto& h = b.header();
+        iobuf packed;
+        reflection::serialize(
+          packed,
+          h.header_crc,
+          h.size_bytes,
+          h.base_offset(),
+          h.type(),
+          h.crc,
+          h.attrs.value(),
+          h.last_offset_delta,
+          h.first_timestamp.value(),
+          h.max_timestamp.value(),
+          h.producer_id,
+          h.producer_epoch,
+          h.base_sequence,
+          h.record_count);
+        auto raw = iobuf_to_bytes(packed);
+        const auto* p = reinterpret_cast<const char*>(raw.data());
+        BOOST_REQUIRE_EQUAL(internal::header_from_bytes(p), h);
+        BOOST_REQUIRE_EQUAL(
+          internal::packed_header_crc(p), model::internal_header_only_crc(h));
+    }
+}
 #if 0
 class test_consumer : public batch_consumer {
 public:
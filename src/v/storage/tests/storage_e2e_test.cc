@@ -15,7 +15,9 @@
 #include "model/timestamp.h"
 #include "random/generators.h"
 #include "storage/batch_cache.h"
+#include "storage/disk_log_impl.h"
 #include "storage/log_manager.h"
+#include "storage/parser_utils.h"
 #include "storage/record_batch_builder.h"
 #include "storage/tests/storage_test_fixture.h"
 #include "storage/tests/utils/disk_log_builder.h"
@@ -1066,3 +1068,164 @@ FIXTURE_TEST(check_segment_size_jitter, storage_test_fixture) {
         [size = sizes[0]](auto other) { return size == other; }),
       false);
 }
+
+FIXTURE_TEST(clean_close_skips_recovery, storage_test_fixture) {
+    auto cfg = default_log_config(test_dir);
+    cfg.stype = storage::log_config::storage_type::disk;
+    auto ntp = model::ntp("default", "test", 0);
+    model::offset dirty_offset;
+    {
+        storage::log_manager mgr = make_log_manager(cfg);
+        auto log = mgr.manage(storage::ntp_config(ntp, mgr.config().base_dir))
+                     .get0();
+        append_random_batches(log, 10);
+        log.flush().get0();
+        dirty_offset = log.offsets().dirty_offset;
+        mgr.stop().get0();
+    }
+    // clean close leaves a marker for the last segment
+    BOOST_REQUIRE(
+      storage::disk_log_impl::read_clean_segment_marker(kvstore, ntp));
+
+    storage::log_manager mgr = make_log_manager(cfg);
+    auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+    auto log
+      = mgr.manage(storage::ntp_config(ntp, mgr.config().base_dir)).get0();
+    // the marker is consumed on open and offsets come from the index
+    BOOST_REQUIRE(
+      !storage::disk_log_impl::read_clean_segment_marker(kvstore, ntp));
+    BOOST_REQUIRE_EQUAL(log.offsets().dirty_offset, dirty_offset);
+    auto batches = read_and_validate_all_batches(log);
+    BOOST_REQUIRE_EQUAL(batches.back().last_offset(), dirty_offset);
+}
+
+FIXTURE_TEST(stale_clean_close_marker_replays, storage_test_fixture) {
+    auto cfg = default_log_config(test_dir);
+    cfg.stype = storage::log_config::storage_type::disk;
+    auto ntp = model::ntp("default", "test", 0);
+    auto run = [this, &cfg, &ntp](auto f) {
+        storage::log_manager mgr = make_log_manager(cfg);
+        auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+        auto log = mgr.manage(storage::ntp_config(ntp, mgr.config().base_dir))
+                     .get0();
+        return f(log);
+    };
+    run([this](storage::log log) {
+        append_random_batches(log, 10);
+        log.flush().get0();
+        return 0;
+    });
+    auto stale = storage::disk_log_impl::read_clean_segment_marker(kvstore, ntp);
+    BOOST_REQUIRE(stale);
+
+    // data appended after the marker was written
+    auto dirty_offset = run([this](storage::log log) {
+        append_random_batches(log, 10);
+        log.flush().get0();
+        return log.offsets().dirty_offset;
+    });
+    BOOST_REQUIRE_GT(dirty_offset, stale->dirty_offset);
+
+    // an unclean stop that left the previous marker behind must not skip the
+    // replay of the data appended since
+    storage::disk_log_impl::write_clean_segment_marker(kvstore, ntp, *stale)
+      .get0();
+    run([this, dirty_offset](storage::log log) {
+        BOOST_REQUIRE_EQUAL(log.offsets().dirty_offset, dirty_offset);
+        auto batches = read_and_validate_all_batches(log);
+        BOOST_REQUIRE_EQUAL(batches.back().last_offset(), dirty_offset);
+        return 0;
+    });
+}
+
+FIXTURE_TEST(test_raw_reads_match_reader, storage_test_fixture) {
+    auto cfg = default_log_config(test_dir);
+    cfg.max_segment_size = 1_KiB;
+    cfg.stype = storage::log_config::storage_type::disk;
+    storage::log_manager mgr = make_log_manager(std::move(cfg));
+    auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+    auto ntp = model::ntp("default", "test", 0);
+    auto log
+      = mgr.manage(storage::ntp_config(ntp, mgr.config().base_dir)).get0();
+    append_random_batches(log, 10);
+    log.flush().get0();
+    auto batches = read_and_validate_all_batches(log);
+
+    for (auto cache : {storage::use_batch_cache::no,
+                       storage::use_batch_cache::yes}) {
+        storage::log_reader_config reader_cfg(
+          model::offset(0),
+          model::model_limits<model::offset>::max(),
+          ss::default_priority_class());
+        auto raw = log.read_raw(reader_cfg, cache).get0();
+        BOOST_REQUIRE_EQUAL(raw.batches.size(), batches.size());
+        for (size_t i = 0; i < batches.size(); ++i) {
+            BOOST_REQUIRE_EQUAL(raw.batches[i].header, batches[i].header());
+            BOOST_REQUIRE_EQUAL(raw.batches[i].payload, batches[i].data());
+        }
+    }
+}
+
+FIXTURE_TEST(recompress_to_topic_codec, storage_test_fixture) {
+    auto cfg = default_log_config(test_dir);
+    cfg.max_segment_size = 10;
+    cfg.stype = storage::log_config::storage_type::disk;
+    // read the rewritten segments, not the batches cached when appending
+    cfg.cache = storage::log_config::with_cache::no;
+    ss::abort_source as;
+    storage::log_manager mgr = make_log_manager(std::move(cfg));
+    auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+    auto ntp = model::ntp("default", "test", 0);
+    using overrides_t = storage::ntp_config::default_overrides;
+    overrides_t ov;
+    ov.compression = model::compression::zstd;
+    auto log = mgr.manage(storage::ntp_config(
+                            ntp,
+                            mgr.config().base_dir,
+                            std::make_unique<overrides_t>(ov)))
+                 .get0();
+
+    // uncompressed batches, one segment per append
+    const int appends = 5;
+    append_random_batches(log, appends, model::term_id(0), []() {
+        ss::circular_buffer<model::record_batch> batches;
+        batches.push_back(
+          storage::test::make_random_batch(model::offset(0), 10, false));
+        return batches;
+    });
+    log.flush().get0();
+    auto before = read_and_validate_all_batches(log);
+
+    // one segment is recompressed per round
+    storage::compaction_config ccfg(
+      model::timestamp::min(), std::nullopt, ss::default_priority_class(), as);
+    for (int i = 0; i < appends; ++i) {
+        log.compact(ccfg).get0();
+    }
+
+    auto after = read_and_validate_all_batches(log);
+    BOOST_REQUIRE_EQUAL(before.size(), after.size());
+    // the active segment is left as is
+    for (size_t i = 0; i < after.size() - 1; ++i) {
+        BOOST_REQUIRE_EQUAL(
+          after[i].header().attrs.compression(), model::compression::zstd);
+        BOOST_REQUIRE_EQUAL(after[i].base_offset(), before[i].base_offset());
+        BOOST_REQUIRE_EQUAL(after[i].record_count(), before[i].record_count());
+        auto decompressed = storage::internal::decompress_batch(
+                              std::move(after[i]))
+                              .get0();
+        BOOST_REQUIRE_EQUAL(decompressed.data(), before[i].data());
+    }
+    BOOST_REQUIRE_EQUAL(log.offsets().dirty_offset, before.back().last_offset());
+
+    // segments already in the codec are skipped without a staging copy
+    auto recompressed = read_and_validate_all_batches(log);
+    for (int i = 0; i < appends; ++i) {
+        log.compact(ccfg).get0();
+    }
+    auto again = read_and_validate_all_batches(log);
+    BOOST_REQUIRE_EQUAL(again.size(), recompressed.size());
+    for (size_t i = 0; i < again.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(again[i].header(), recompressed[i].header());
+    }
+}
@@ -0,0 +1,97 @@
+// Copyright 2020 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "cluster/simple_batch_builder.h"
+#include "model/record.h"
+#include "storage/tail_buffer.h"
+
+#include <seastar/testing/thread_test_case.hh>
+
+static model::record_batch make_batch(model::offset offset) {
+    cluster::simple_batch_builder b(model::record_batch_type(1), offset);
+    for (size_t i = 0; i < 10; i++) {
+        b.add_kv("key", "value");
+    }
+    return std::move(b).build();
+}
+
+static storage::log_reader_config reader_config(model::offset start) {
+    return storage::log_reader_config(
+      start,
+      model::model_limits<model::offset>::max(),
+      ss::default_priority_class());
+}
+
+SEASTAR_THREAD_TEST_CASE(disabled_buffer_ignores_appends) {
+    storage::tail_buffer tail;
+    tail.push(make_batch(model::offset(0)));
+    BOOST_CHECK_EQUAL(tail.size_bytes(), 0);
+    BOOST_CHECK(!tail.read(reader_config(model::offset(0))));
+}
+
+SEASTAR_THREAD_TEST_CASE(buffers_after_the_first_read) {
+    storage::tail_buffer tail;
+    tail.set_enabled(true);
+    tail.push(make_batch(model::offset(0)));
+    BOOST_CHECK_EQUAL(tail.size_bytes(), 0);
+    BOOST_CHECK(!tail.read(reader_config(model::offset(10))));
+    tail.push(make_batch(model::offset(10)));
+    BOOST_CHECK(tail.read(reader_config(model::offset(10))));
+
+    // disabling (e.g. losing leadership) waits for a reader again
+    tail.set_enabled(false);
+    tail.set_enabled(true);
+    tail.push(make_batch(model::offset(20)));
+    BOOST_CHECK_EQUAL(tail.size_bytes(), 0);
+}
+
+SEASTAR_THREAD_TEST_CASE(serves_reads_within_the_tail) {
+    storage::tail_buffer tail;
+    tail.set_enabled(true);
+    BOOST_CHECK(!tail.read(reader_config(model::offset(0))));
+    for (int i = 0; i < 5; ++i) {
+        tail.push(make_batch(model::offset(i * 10)));
+    }
+    auto ret = tail.read(reader_config(model::offset(25)));
+    BOOST_REQUIRE(ret);
+    BOOST_REQUIRE_EQUAL(ret->batches.size(), 3);
+    BOOST_CHECK_EQUAL(
+      ret->batches.front().header.base_offset, model::offset(20));
+
+    // past the end of the tail and before its start go to the log
+    BOOST_CHECK(!tail.read(reader_config(model::offset(50))));
+    tail.prefix_truncate(model::offset(20));
+    BOOST_CHECK(!tail.read(reader_config(model::offset(10))));
+
+    tail.truncate(model::offset(30));
+    ret = tail.read(reader_config(model::offset(20)));
+    BOOST_REQUIRE(ret);
+    BOOST_CHECK_EQUAL(ret->batches.size(), 1);
+}
+
+SEASTAR_THREAD_TEST_CASE(bounded_and_contiguous) {
+    auto batch_size = make_batch(model::offset(0)).copy().memory_usage();
+    storage::tail_buffer tail(batch_size * 2);
+    tail.set_enabled(true);
+    BOOST_CHECK(!tail.read(reader_config(model::offset(0))));
+    for (int i = 0; i < 5; ++i) {
+        tail.push(make_batch(model::offset(i * 10)));
+    }
+    BOOST_CHECK_LE(tail.size_bytes(), batch_size * 2);
+    BOOST_CHECK(!tail.read(reader_config(model::offset(20))));
+    BOOST_CHECK(tail.read(reader_config(model::offset(30))));
+
+    // a gap starts the buffer over
+    tail.push(make_batch(model::offset(100)));
+    BOOST_CHECK(!tail.read(reader_config(model::offset(40))));
+    BOOST_CHECK(tail.read(reader_config(model::offset(100))));
+
+    tail.set_enabled(false);
+    BOOST_CHECK_EQUAL(tail.size_bytes(), 0);
+}
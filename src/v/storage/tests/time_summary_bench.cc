@@ -0,0 +1,105 @@
+// Copyright 2020 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "model/timestamp.h"
+#include "random/generators.h"
+#include "storage/time_summary.h"
+#include "vassert.h"
+
+#include <seastar/testing/perf_tests.hh>
+
+#include <chrono>
+#include <utility>
+
+static constexpr size_t segments = 50'000;
+
+static storage::time_summary make_summary(size_t n) {
+    storage::time_summary summary;
+    for (size_t i = 0; i < n; ++i) {
+        summary.push_back(model::timestamp(i * 1000));
+    }
+    return summary;
+}
+
+/// seconds taken by \p ops segment rolls, retentions and searches on a log
+/// of \p n segments
+static double churn(size_t n, size_t ops) {
+    auto summary = make_summary(n);
+    auto next = model::timestamp(n * 1000);
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ops; ++i) {
+        summary.push_back(next);
+        summary.pop_front();
+        found += summary.lower_bound(model::timestamp(next() - 500'000));
+        next = model::timestamp(next() + 1000);
+    }
+    perf_tests::do_not_optimize(found);
+    return std::chrono::duration<double>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+struct time_summary_bench {
+    // per segment max timestamps of a log with clock skewed producers: mostly
+    // increasing, with one in a hundred segments jumping ahead or behind
+    time_summary_bench() {
+        int64_t ts = 0;
+        for (size_t i = 0; i < segments; ++i) {
+            ts += 1000;
+            auto max = ts;
+            if (random_generators::get_int(0, 99) == 0) {
+                max += random_generators::get_int<int64_t>(-500'000, 500'000);
+            }
+            summary.push_back(model::timestamp(max));
+        }
+        assert_logarithmic();
+    }
+
+    // every operation is O(log n): a log a thousand times longer should take
+    // about twice as long per operation, where a linear pop_front or search
+    // would take a thousand times longer. The bound leaves room for caches.
+    static void assert_logarithmic() {
+        static bool checked = false;
+        if (std::exchange(checked, true)) {
+            return;
+        }
+        static constexpr size_t ops = 100'000;
+        churn(1'000, ops); // warm up
+        auto small = churn(1'000, ops);
+        auto large = churn(1'000'000, ops);
+        vassert(
+          large < small * 20,
+          "time_summary does not scale logarithmically: {} ops took {}s on "
+          "1k segments and {}s on 1M segments",
+          ops,
+          small,
+          large);
+    }
+
+    storage::time_summary summary;
+};
+
+PERF_TEST_F(time_summary_bench, lower_bound) {
+    auto needle = model::timestamp(
+      random_generators::get_int<int64_t>(0, segments * 1000));
+    perf_tests::start_measuring_time();
+    auto i = summary.lower_bound(needle);
+    perf_tests::do_not_optimize(i);
+    perf_tests::stop_measuring_time();
+}
+
+PERF_TEST_F(time_summary_bench, roll_and_retire) {
+    // one segment sealed at the back, the oldest one removed by retention
+    auto max = summary.max();
+    perf_tests::start_measuring_time();
+    summary.push_back(model::timestamp(max() + 1000));
+    summary.pop_front();
+    perf_tests::stop_measuring_time();
+}
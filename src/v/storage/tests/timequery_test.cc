@@ -113,3 +113,51 @@ FIXTURE_TEST(timequery_single_value, log_builder_fixture) {
     BOOST_TEST(res->offset == model::offset(0));
     b | stop();
 }
+
+FIXTURE_TEST(timequery_out_of_order_timestamps, log_builder_fixture) {
+    using namespace storage; // NOLINT
+
+    b | start();
+
+    // per segment max timestamps: 9, 1000, 29, 69
+    auto add = [this](int offset, int ts) {
+        auto batch = test::make_random_batch(model::offset(offset), 1, false);
+        batch.header().first_timestamp = model::timestamp(ts);
+        batch.header().max_timestamp = model::timestamp(ts);
+        b | add_batch(std::move(batch));
+    };
+    b | add_segment(0);
+    for (auto offset = 0; offset < 10; ++offset) {
+        add(offset, offset);
+    }
+    // a producer with a skewed clock
+    b | add_segment(10);
+    for (auto offset = 10; offset < 19; ++offset) {
+        add(offset, offset);
+    }
+    add(19, 1000);
+    b | add_segment(20);
+    for (auto offset = 20; offset < 30; ++offset) {
+        add(offset, offset);
+    }
+    b | add_segment(30);
+    for (auto offset = 30; offset < 40; ++offset) {
+        add(offset, offset + 30);
+    }
+
+    auto log = b.get_log();
+    storage::timequery_config config(
+      model::timestamp(50),
+      log.offsets().dirty_offset,
+      ss::default_priority_class());
+
+    // the first batch at or after 50 is the skewed one
+    auto res = log.timequery(config).get0();
+    BOOST_TEST(res);
+    BOOST_TEST(res->time == model::timestamp(1000));
+    BOOST_TEST(res->offset == model::offset(19));
+
+    config.time = model::timestamp(1001);
+    BOOST_TEST(!log.timequery(config).get0());
+    b | stop();
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2020 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "model/timestamp.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace storage {
+
+/**
+ * Max timestamps of the segments of a log, in segment order.
+ *
+ * Producers are free to send timestamps that go backwards, so the max
+ * timestamps of consecutive segments are not sorted and cannot be binary
+ * searched directly. Their running maximum always is: the first segment whose
+ * running max reaches a timestamp is the first one that can contain a batch
+ * at or after it, just like the entries of kafka's time index.
+ *
+ * Rather than materializing the running max, which retention would have to
+ * rebuild every time it drops the oldest segment, the timestamps live in a
+ * ring of leaves under a max segment tree. Appending, dropping either end and
+ * finding the first segment at or above a timestamp are all O(log n).
+ */
+class time_summary {
+public:
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    void push_back(model::timestamp t) {
+        if (_size == capacity()) {
+            grow();
+        }
+        set(slot(_size), t);
+        ++_size;
+    }
+
+    void pop_back() {
+        --_size;
+        set(slot(_size), lowest);
+    }
+
+    void pop_front() {
+        set(_head, lowest);
+        _head = slot(1);
+        --_size;
+    }
+
+    void clear() {
+        _tree.clear();
+        _head = 0;
+        _size = 0;
+    }
+
+    /// running max of all the segments
+    model::timestamp max() const {
+        return empty() ? model::timestamp::missing() : _tree[1];
+    }
+
+    /// index of the first segment whose running max is at least \p t, or
+    /// size() if there is none
+    size_t lower_bound(model::timestamp t) const {
+        if (empty() || _tree[1] < t) {
+            return _size;
+        }
+        size_t i = first_at_least(1, 0, capacity(), _head, t);
+        if (i == capacity()) {
+            // the ring wraps around: the rest is at the front of the leaves
+            i = capacity() + first_at_least(1, 0, capacity(), 0, t);
+        }
+        return std::min(i - _head, _size);
+    }
+
+private:
+    static constexpr model::timestamp lowest = model::timestamp(
+      std::numeric_limits<model::timestamp::type>::min());
+
+    /// number of leaves, always a power of two
+    size_t capacity() const { return _tree.size() / 2; }
+
+    /// leaf holding the segment \p i positions after the first one
+    size_t slot(size_t i) const { return (_head + i) & (capacity() - 1); }
+
+    void set(size_t leaf, model::timestamp t) {
+        size_t node = capacity() + leaf;
+        _tree[node] = t;
+        for (node /= 2; node > 0; node /= 2) {
+            _tree[node] = std::max(_tree[2 * node], _tree[2 * node + 1]);
+        }
+    }
+
+    /// first leaf at or after \p from under \p node, which covers leaves
+    /// [lo, hi), whose timestamp is at least \p t, or capacity()
+    size_t first_at_least(
+      size_t node,
+      size_t lo,
+      size_t hi,
+      size_t from,
+      model::timestamp t) const {
+        if (hi <= from || _tree[node] < t) {
+            return capacity();
+        }
+        if (hi - lo == 1) {
+            return lo;
+        }
+        const size_t mid = lo + (hi - lo) / 2;
+        if (auto i = first_at_least(2 * node, lo, mid, from, t);
+            i != capacity()) {
+            return i;
+        }
+        return first_at_least(2 * node + 1, mid, hi, from, t);
+    }
+
+    /// doubles the leaves and unwraps the ring; amortized O(1) per push
+    void grow() {
+        std::vector<model::timestamp> tree(
+          std::max<size_t>(32, 4 * capacity()), lowest);
+        const size_t leaves = tree.size() / 2;
+        for (size_t i = 0; i < _size; ++i) {
+            tree[leaves + i] = _tree[capacity() + slot(i)];
+        }
+        for (size_t node = leaves - 1; node > 0; --node) {
+            tree[node] = std::max(tree[2 * node], tree[2 * node + 1]);
+        }
+        _tree = std::move(tree);
+        _head = 0;
+    }
+
+    /// 1-based implicit tree: node n has children 2n and 2n + 1, and the
+    /// leaves are the upper half
+    std::vector<model::timestamp> _tree;
+    size_t _head{0};
+    size_t _size{0};
+};
+
+} // namespace storage
@@ -54,12 +54,15 @@ operator<<(std::ostream& o, const ntp_config::default_overrides& v) {
     fmt::print(
       o,
       "{{compaction_strategy: {}, cleanup_policy_bitflags: {}, segment_size: "
-      "{}, retention_bytes: {}, retention_time_ms: {}}}",
+      "{}, max_write_size: {}, retention_bytes: {}, retention_time_ms: {}, "
+      "compression: {}}}",
       v.compaction_strategy,
       v.cleanup_policy_bitflags,
       v.segment_size,
+      v.max_write_size,
       v.retention_bytes,
-      v.retention_time);
+      v.retention_time,
+      v.compression);
 
     return o;
 }
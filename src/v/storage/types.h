@@ -20,6 +20,7 @@
 #include "tristate.h"
 
 #include <seastar/core/abort_source.hh>
+#include <seastar/core/circular_buffer.hh>
 #include <seastar/core/file.hh> //io_priority
 #include <seastar/core/rwlock.hh>
 #include <seastar/util/bool_class.hh>
@@ -216,6 +217,23 @@ struct log_reader_config {
     friend std::ostream& operator<<(std::ostream& o, const log_reader_config&);
 };
 
+/// \brief whether log::read_raw may serve batches from the batch cache
+using use_batch_cache = ss::bool_class<struct use_batch_cache_tag>;
+
+/**
+ * Batches of a log::read_raw. Headers are validated against their crc but
+ * nothing is parsed into batches: the payloads share the buffers they were
+ * read into, or the buffers of the cached batches they were served from.
+ */
+struct raw_read_result {
+    struct batch {
+        model::record_batch_header header;
+        /// the records as laid out on disk
+        iobuf payload;
+    };
+    ss::circular_buffer<batch> batches;
+};
+
 struct compaction_config {
     explicit compaction_config(
       model::timestamp upper,